@@ -4,12 +4,13 @@
 
 passthru_opts+=\
 	NONET NO_IPV6 NOHW NOMD5 NOPOSTPROCESSING\
-	MOBJCONSISTANCY PACKETDROP ZDEBUG\
+	MOBJCONSISTANCY MOBJCONSISTANCYWALK PACKETDROP ZDEBUG\
 	HAVE_MINIUPNPC\
 
 # build with debugging information
 ifdef DEBUGMODE
 MOBJCONSISTANCY=1
+MOBJCONSISTANCYWALK=1
 PACKETDROP=1
 opts+=-DPARANOIA -DRANGECHECK
 endif
@@ -17,6 +17,10 @@
 #include <unistd.h> //for unlink
 #endif
 
+#ifdef HAVE_ZLIB
+#include "zlib.h" // join savegames
+#endif
+
 #include "i_time.h"
 #include "i_time.h"
 #include "i_net.h"
@@ -31,6 +35,7 @@
 #include "m_menu.h"
 #include "console.h"
 #include "d_netfil.h"
+#include "d_loadtest.h"
 #include "byteptr.h"
 #include "p_saveg.h"
 #include "z_zone.h"
@@ -49,6 +54,7 @@
 #include "md5.h"
 #include "r_fps.h"
 #include "m_perfstats.h"
+#include "i_threads.h"
 
 #ifdef CLIENT_LOADINGSCREEN
 // cl loading screen
@@ -230,6 +236,368 @@ tic_t ExpandTics(INT32 low)
 		return (maketic & ~UINT8_MAX) + 256 + low;
 }
 
+/** Gets the consistancy the server worked out for a tic
+  *
+  * \param tic A tic within the last BACKUPTICS
+  * \return The consistancy clients must send back for it
+  *
+  */
+INT16 SV_GetConsistancy(tic_t tic)
+{
+	return consistancy[tic%BACKUPTICS];
+}
+
+// -----------------------------------------------------------------
+// Delta coded ticcmds
+//
+// Each command is sent as a byte of TD_ flags followed by only the
+// fields that differ from the command it is coded against. The first
+// tic of a packet is coded against a tic the other side has already
+// acknowledged, the rest against the tic before them, so a lost packet
+// never leaves the receiver with a command it can't decode.
+// -----------------------------------------------------------------
+
+#define TD_FWD       0x01
+#define TD_SIDE      0x02
+#define TD_ANGLE     0x04
+#define TD_ANGLEBYTE 0x08 // angleturn is a signed byte difference
+#define TD_AIM       0x10
+#define TD_AIMBYTE   0x20 // aiming is a signed byte difference
+#define TD_BUTTONS   0x40
+#define TD_BUTTONSLO 0x80 // only the low byte of buttons changed
+
+#define MAXDELTATICCMD (1 + sizeof (ticcmd_t)) // every field changed
+
+// Sends that can go by without the client acknowledging
+// a new tic before deltas stop using a base tic at all
+#define DELTAMAXSTALL (TICRATE/4)
+
+static const ticcmd_t emptycmds[MAXPLAYERS];
+
+// What the server sent each node, to code later tics against once acknowledged
+static ticcmd_t deltasent[MAXNETNODES][BACKUPTICS][MAXPLAYERS];
+static tic_t deltasenttic[MAXNETNODES][BACKUPTICS];
+static boolean deltasentvalid[MAXNETNODES][BACKUPTICS]; // false once resent with other cmds
+static boolean nodedeltatics[MAXNETNODES];
+static tic_t deltalastbase[MAXNETNODES];
+static UINT8 deltastall[MAXNETNODES];
+
+static UINT8 deltaticbuf[1 + MAXPLAYERS*MAXDELTATICCMD]; // The base and first tic for one node
+static size_t deltaticsize;
+
+// What the client got from the server, to decode later tics against
+static ticcmd_t cl_deltacmds[BACKUPTICS][MAXPLAYERS];
+static tic_t cl_deltatics[BACKUPTICS];
+static ticcmd_t cl_packetcmds[BACKUPTICS][MAXPLAYERS];
+static boolean cl_deltaserver; // The server sends us delta coded tics
+
+static UINT8 *WriteDeltaTiccmd(UINT8 *p, const ticcmd_t *cmd, const ticcmd_t *base)
+{
+	UINT8 *flags = p++;
+	INT16 delta;
+
+	*flags = 0;
+
+	if (cmd->forwardmove != base->forwardmove)
+	{
+		*flags |= TD_FWD;
+		WRITESINT8(p, cmd->forwardmove);
+	}
+	if (cmd->sidemove != base->sidemove)
+	{
+		*flags |= TD_SIDE;
+		WRITESINT8(p, cmd->sidemove);
+	}
+
+	delta = (INT16)(cmd->angleturn - base->angleturn);
+	if (delta)
+	{
+		*flags |= TD_ANGLE;
+		if (delta >= INT8_MIN && delta <= INT8_MAX)
+		{
+			*flags |= TD_ANGLEBYTE;
+			WRITESINT8(p, (SINT8)delta);
+		}
+		else
+			WRITEINT16(p, cmd->angleturn);
+	}
+
+	delta = (INT16)(cmd->aiming - base->aiming);
+	if (delta)
+	{
+		*flags |= TD_AIM;
+		if (delta >= INT8_MIN && delta <= INT8_MAX)
+		{
+			*flags |= TD_AIMBYTE;
+			WRITESINT8(p, (SINT8)delta);
+		}
+		else
+			WRITEINT16(p, cmd->aiming);
+	}
+
+	if (cmd->buttons != base->buttons)
+	{
+		*flags |= TD_BUTTONS;
+		if ((cmd->buttons ^ base->buttons) & 0xFF00)
+			WRITEUINT16(p, cmd->buttons);
+		else
+		{
+			*flags |= TD_BUTTONSLO;
+			WRITEUINT8(p, (UINT8)cmd->buttons);
+		}
+	}
+
+	return p;
+}
+
+// Returns NULL if the command runs past end
+static UINT8 *ReadDeltaTiccmd(UINT8 *p, const UINT8 *end, ticcmd_t *cmd, const ticcmd_t *base)
+{
+	UINT8 flags;
+	size_t size;
+
+	if (p >= end)
+		return NULL;
+	flags = READUINT8(p);
+
+	size = !!(flags & TD_FWD) + !!(flags & TD_SIDE);
+	if (flags & TD_ANGLE)
+		size += (flags & TD_ANGLEBYTE) ? 1 : 2;
+	if (flags & TD_AIM)
+		size += (flags & TD_AIMBYTE) ? 1 : 2;
+	if (flags & TD_BUTTONS)
+		size += (flags & TD_BUTTONSLO) ? 1 : 2;
+	if (size > (size_t)(end - p))
+		return NULL;
+
+	*cmd = *base;
+
+	if (flags & TD_FWD)
+		cmd->forwardmove = READSINT8(p);
+	if (flags & TD_SIDE)
+		cmd->sidemove = READSINT8(p);
+	if (flags & TD_ANGLE)
+	{
+		if (flags & TD_ANGLEBYTE)
+			cmd->angleturn = (INT16)(base->angleturn + READSINT8(p));
+		else
+			cmd->angleturn = READINT16(p);
+	}
+	if (flags & TD_AIM)
+	{
+		if (flags & TD_AIMBYTE)
+			cmd->aiming = (INT16)(base->aiming + READSINT8(p));
+		else
+			cmd->aiming = READINT16(p);
+	}
+	if (flags & TD_BUTTONS)
+	{
+		if (flags & TD_BUTTONSLO)
+			cmd->buttons = (UINT16)((base->buttons & 0xFF00) | READUINT8(p));
+		else
+			cmd->buttons = READUINT16(p);
+	}
+
+	return p;
+}
+
+// Codes firsttic for node into deltaticbuf, the tics after it
+// are the same for every node, see SV_EncodeSharedTics.
+// Returns the flags to put in servertics_pak.numslots.
+static UINT8 SV_WriteDeltaTics(INT32 node, tic_t firsttic)
+{
+	const tic_t base = nettics[node] - 1; // The client has every tic before nettics
+	const ticcmd_t *prev = emptycmds;
+	UINT8 *p = deltaticbuf;
+	UINT8 flags = SERVERTICS_DELTA;
+	INT32 j;
+
+	// A client that keeps not acknowledging anything might be unable
+	// to decode against its base, so stop relying on it for a while
+	if (base == deltalastbase[node])
+	{
+		if (deltastall[node] < UINT8_MAX)
+			deltastall[node]++;
+	}
+	else
+	{
+		deltalastbase[node] = base;
+		deltastall[node] = 0;
+	}
+
+	if (base < firsttic && maketic - base < BACKUPTICS
+		&& deltasenttic[node][base%BACKUPTICS] == base
+		&& deltasentvalid[node][base%BACKUPTICS]
+		&& deltastall[node] < DELTAMAXSTALL)
+	{
+		flags |= SERVERTICS_BASE;
+		WRITEUINT8(p, (UINT8)base);
+		prev = deltasent[node][base%BACKUPTICS];
+	}
+
+	for (j = 0; j < doomcom->numslots; j++)
+		p = WriteDeltaTiccmd(p, &netcmds[firsttic%BACKUPTICS][j], &prev[j]);
+	deltaticsize = p - deltaticbuf;
+
+	return flags;
+}
+
+// Remembers what was sent to node, so it can be coded against once acknowledged
+static void SV_KeepDeltaTics(INT32 node, tic_t firsttic, tic_t lasttic)
+{
+	ticcmd_t cmds[MAXPLAYERS];
+	tic_t i;
+
+	for (i = firsttic; i < lasttic; i++)
+	{
+		const INT32 k = i%BACKUPTICS;
+
+		memset(cmds, 0, sizeof (cmds));
+		M_Memcpy(cmds, netcmds[k], doomcom->numslots * sizeof (ticcmd_t));
+
+		if (deltasenttic[node][k] != i)
+		{
+			M_Memcpy(deltasent[node][k], cmds, sizeof (cmds));
+			deltasenttic[node][k] = i;
+			deltasentvalid[node][k] = true;
+		}
+		else if (memcmp(deltasent[node][k], cmds, sizeof (cmds)))
+			deltasentvalid[node][k] = false; // We can't know which one the client kept
+	}
+}
+
+static void ResetDeltaTics(INT32 node)
+{
+	nodedeltatics[node] = false;
+	memset(deltasenttic[node], 0xFF, sizeof (deltasenttic[node]));
+	deltalastbase[node] = 0;
+	deltastall[node] = 0;
+}
+
+// Decodes numtics tics of delta coded cmds into cmds, the first against prev.
+// Returns where they end, or NULL if they run past end.
+static UINT8 *ReadDeltaTics(UINT8 *p, const UINT8 *end, const ticcmd_t *prev,
+	ticcmd_t (*cmds)[MAXPLAYERS], INT32 numtics, INT32 numslots)
+{
+	INT32 i, j;
+
+	for (i = 0; i < numtics; i++)
+	{
+		for (j = 0; j < numslots; j++)
+		{
+			p = ReadDeltaTiccmd(p, end, &cmds[i][j], &prev[j]);
+			if (!p)
+				return NULL;
+		}
+		prev = cmds[i];
+	}
+
+	return p;
+}
+
+// Decodes the cmds of a delta coded PT_SERVERTICS packet into cl_packetcmds.
+// flags are the SERVERTICS_ bits the server put in numslots, which the
+// caller has already masked off.
+// Returns where its textcmds start, or NULL if the packet can't be decoded.
+static UINT8 *CL_ReadDeltaTics(UINT8 flags)
+{
+	servertics_pak *pak = &netbuffer->u.serverpak;
+	const UINT8 *end = (UINT8 *)netbuffer + doomcom->datalength;
+	const ticcmd_t *prev = emptycmds;
+	UINT8 *p = (UINT8 *)&pak->cmds;
+
+	if (pak->numslots > MAXPLAYERS || pak->numtics > BACKUPTICS)
+		return NULL;
+
+	if (flags & SERVERTICS_BASE)
+	{
+		tic_t base;
+
+		if (p >= end)
+			return NULL;
+		base = ExpandTics(READUINT8(p));
+		if (cl_deltatics[base%BACKUPTICS] != base)
+			return NULL;
+		prev = cl_deltacmds[base%BACKUPTICS];
+	}
+
+	return ReadDeltaTics(p, end, prev, cl_packetcmds, pak->numtics, pak->numslots);
+}
+
+// Remembers the cmds the server sent for tic, to decode later tics against
+static void CL_KeepDeltaTic(tic_t tic, INT32 numslots)
+{
+	ticcmd_t *cmds = cl_deltacmds[tic%BACKUPTICS];
+
+	M_Memcpy(cmds, netcmds[tic%BACKUPTICS], numslots * sizeof (ticcmd_t));
+	memset(cmds + numslots, 0, (MAXPLAYERS - numslots) * sizeof (ticcmd_t));
+	cl_deltatics[tic%BACKUPTICS] = tic;
+}
+
+static void CL_ResetDeltaTics(void)
+{
+	cl_deltaserver = false;
+	memset(cl_deltatics, 0xFF, sizeof (cl_deltatics));
+}
+
+// Codes the local cmds into a clientdelta_pak.
+// Returns the packet size, or 0 if there is nothing to code them against.
+static size_t CL_WriteDeltaCmds(boolean twocmds)
+{
+	const tic_t base = neededtic - 1;
+	clientdelta_pak *pak = &netbuffer->u.clientdeltapak;
+	UINT8 *p = pak->cmds;
+
+	if (!cl_deltaserver || cl_deltatics[base%BACKUPTICS] != base
+		|| consoleplayer < 0 || consoleplayer >= MAXPLAYERS)
+		return 0;
+
+	pak->basetic = (UINT8)base;
+	pak->baseslot = (UINT8)consoleplayer;
+	p = WriteDeltaTiccmd(p, &localcmds, &cl_deltacmds[base%BACKUPTICS][consoleplayer]);
+	if (twocmds)
+		p = WriteDeltaTiccmd(p, &localcmds2, &localcmds);
+
+	return p - (UINT8 *)pak;
+}
+
+// Turns a delta coded client packet back into the PT_CLIENTCMD it stands for.
+// If it can't be decoded, it still counts as a keepalive.
+static void SV_ReadDeltaCmds(SINT8 node, INT32 netconsole)
+{
+	clientdelta_pak *pak = &netbuffer->u.clientdeltapak;
+	const UINT8 *end = (UINT8 *)netbuffer + doomcom->datalength;
+	const UINT8 type = (UINT8)(PT_CLIENTCMD + (netbuffer->packettype - PT_CLIENTDELTA));
+	const boolean mis = (type == PT_CLIENTMIS || type == PT_CLIENT2MIS);
+	ticcmd_t cmd, cmd2;
+	UINT8 *p;
+	tic_t base;
+
+	if (end < pak->cmds)
+	{
+		netbuffer->packettype = PT_NOTHING;
+		return;
+	}
+
+	base = ExpandTics(pak->basetic);
+	p = pak->cmds;
+
+	if (netconsole < 0 || pak->baseslot != netconsole
+		|| deltasenttic[node][base%BACKUPTICS] != base || !deltasentvalid[node][base%BACKUPTICS]
+		|| !(p = ReadDeltaTiccmd(p, end, &cmd, &deltasent[node][base%BACKUPTICS][netconsole]))
+		|| ((type == PT_CLIENT2CMD || type == PT_CLIENT2MIS) && !ReadDeltaTiccmd(p, end, &cmd2, &cmd)))
+	{
+		netbuffer->packettype = mis ? PT_NODEKEEPALIVEMIS : PT_NODEKEEPALIVE;
+		return;
+	}
+
+	// The leading fields are shared, so only the cmds need to move
+	G_MoveTiccmd(&netbuffer->u.client2pak.cmd, &cmd, 1);
+	if (type == PT_CLIENT2CMD || type == PT_CLIENT2MIS)
+		G_MoveTiccmd(&netbuffer->u.client2pak.cmd2, &cmd2, 1);
+	netbuffer->packettype = type;
+}
+
 // -----------------------------------------------------------------
 // Some extra data function for handle textcmd buffer
 // -----------------------------------------------------------------
@@ -991,6 +1359,9 @@ static void SV_SendResynch(INT32 node)
 		netbuffer->packettype = PT_RESYNCHEND;
 
 		netbuffer->u.resynchend.randomseed = P_GetRandSeed();
+#ifdef MOBJCONSISTANCY
+		netbuffer->u.resynchend.mobjconsistancy = LONG(mobjconsistancy);
+#endif
 		if (gametype == GT_CTF)
 			resynch_write_ctf(&netbuffer->u.resynchend);
 		resynch_write_others(&netbuffer->u.resynchend);
@@ -1069,6 +1440,9 @@ typedef enum
 {
 	CL_SEARCHING,
 	CL_CHECKFILES,
+#ifdef HAVE_CURL
+	CL_DOWNLOADHTTPFILES,
+#endif
 	CL_DOWNLOADFILES,
 	CL_ASKJOIN,
 	CL_WAITJOINRESPONSE,
@@ -1135,7 +1509,11 @@ static inline void CL_DrawConnectionStatus(void)
 	M_DrawTextBox(BASEVIDWIDTH/2-128-8, BASEVIDHEIGHT-24-8, 32, 1);
 	V_DrawCenteredString(BASEVIDWIDTH/2, BASEVIDHEIGHT-24-24, V_YELLOWMAP, "Press ESC to abort");
 
-	if (cl_mode != CL_DOWNLOADFILES && cl_mode != CL_VIEWSERVER)
+	if (cl_mode != CL_DOWNLOADFILES && cl_mode != CL_VIEWSERVER
+#ifdef HAVE_CURL
+		&& cl_mode != CL_DOWNLOADHTTPFILES
+#endif
+		)
 	{
 		INT32 i, animtime = ((ccstime / 4) & 15) + 16;
 		UINT8 palstart = (cl_mode == CL_SEARCHING) ? 128 : 160;
@@ -1283,6 +1661,12 @@ static inline void CL_DrawConnectionStatus(void)
 				va(M_GetText("Downloading \"%s\""), tempname));
 			V_DrawString(BASEVIDWIDTH/2-128, BASEVIDHEIGHT-24, V_20TRANS|V_MONOSPACE,
 				va(" %4uK/%4uK",fileneeded[lastfilenum].currentsize>>10,file->totalsize>>10));
+#ifdef HAVE_CURL
+			if (cl_mode == CL_DOWNLOADHTTPFILES)
+				V_DrawRightAlignedString(BASEVIDWIDTH/2+128, BASEVIDHEIGHT-24, V_20TRANS|V_MONOSPACE,
+					"HTTP ");
+			else
+#endif
 			V_DrawRightAlignedString(BASEVIDWIDTH/2+128, BASEVIDHEIGHT-24, V_20TRANS|V_MONOSPACE,
 				va("%3.1fK/s ", ((double)getbps)/1024));
 		}
@@ -1318,6 +1702,12 @@ static boolean CL_SendJoin(void)
 		netbuffer->u.clientcfg.subversion = SUBVERSION_NETCOMPAT;
 	else
 		netbuffer->u.clientcfg.subversion = SUBVERSION;
+	netbuffer->u.clientcfg.flags = CLIENTCFG_DELTATICS;
+#ifdef HAVE_ZLIB
+	netbuffer->u.clientcfg.flags |= CLIENTCFG_DEFLATESAVE;
+#endif
+
+	CL_ResetDeltaTics();
 
 	return HSendPacket(servernode, true, 0, sizeof (clientconfig_pak));
 }
@@ -1500,53 +1890,121 @@ static boolean SV_SendServerConfig(INT32 node)
 #ifdef JOININGAME
 #define SAVEGAMESIZE (768*1024)
 
-static void SV_SendSaveGame(INT32 node)
+// The first UINT32 of a sent savegame is 0 if it's uncompressed, or its
+// uncompressed length. That's LZF compressed, unless this flag is set,
+// then it's a series of deflated chunks, each starting with its UINT32 size.
+// Only nodes that sent CLIENTCFG_DEFLATESAVE get those.
+#define SAVEGAMEDEFLATED 0x80000000
+#define SAVEGAMECHUNK (64*1024) // uncompressed size of every chunk but the last
+
+#ifdef HAVE_ZLIB
+// Deflates a savegame a chunk at a time, so it can be inflated the same way.
+// Returns 0 if it doesn't fit in destlen, like lzf_compress.
+static size_t DeflateSaveGame(const UINT8 *src, size_t srclen, UINT8 *dest, size_t destlen)
 {
-	size_t length, compressedlen;
-	UINT8 *savebuffer;
-	UINT8 *compressedsave;
-	UINT8 *buffertosend;
+	UINT8 *p = dest;
 
-	// first save it in a malloced buffer
-	savebuffer = (UINT8 *)malloc(SAVEGAMESIZE);
-	if (!savebuffer)
+	while (srclen)
 	{
-		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
-		return;
+		const uLong chunklen = (uLong)min(srclen, SAVEGAMECHUNK);
+		uLongf zlen;
+
+		if ((size_t)(p - dest) + sizeof(UINT32) >= destlen)
+			return 0;
+		zlen = (uLongf)(destlen - (p - dest) - sizeof(UINT32));
+		if (compress2(p + sizeof(UINT32), &zlen, src, chunklen, Z_DEFAULT_COMPRESSION) != Z_OK)
+			return 0;
+
+		WRITEUINT32(p, (UINT32)zlen);
+		p += zlen;
+		src += chunklen;
+		srclen -= chunklen;
 	}
 
-	// Leave room for the uncompressed length.
-	save_p = savebuffer + sizeof(UINT32);
+	return p - dest;
+}
+#endif
 
-	P_SaveNetGame();
+// The savegame sent to joining nodes. Everyone joining on
+// the same tic gets the same one, so it's only made once.
+static struct
+{
+	tic_t tic; // gametic it was saved on
+	UINT8 *savebuffer; // P_SaveNetGame output, handed off to buffertosend once compressed
+	size_t length;
+	UINT8 *buffertosend; // savebuffer or an LZF compressed copy of it
+	size_t sendlength;
+#ifdef HAVE_ZLIB
+	UINT8 *deflated; // NULL if deflating didn't make it smaller
+	size_t deflatedlength;
+#endif
+	int compresstime; // in microseconds
+	boolean made; // Only touched by the main thread
+	boolean ready; // buffertosend is set, don't touch the rest until then
+	boolean reported;
+} joinsave;
+
+static boolean savegamepending[MAXNETNODES]; // Waiting for joinsave to be ready
+#ifdef HAVE_ZLIB
+static boolean nodedeflatesave[MAXNETNODES]; // Sent CLIENTCFG_DEFLATESAVE
+#endif
 
-	length = save_p - savebuffer;
-	if (length > SAVEGAMESIZE)
+#ifdef HAVE_THREADS
+static mutex_t joinsave_mutex;
+static cond_t joinsave_cond;
+#endif
+
+// Compresses joinsave, on its own thread if possible
+static void SV_CompressJoinSave(void *userdata)
+{
+	size_t length = joinsave.length, compressedlen = 0;
+	UINT8 *compressedsave;
+	UINT8 *buffertosend, *p;
+#ifdef HAVE_ZLIB
+	UINT8 *deflatedsave;
+	size_t deflatedlen = 0;
+#endif
+	precise_t starttime = I_GetPreciseTime();
+
+	(void)userdata;
+
+#ifdef HAVE_ZLIB
+	// Nodes that can inflate it get a deflated copy,
+	// it has to be made before savebuffer is freed
+	deflatedsave = malloc(length - 1);
+	if (deflatedsave)
+		deflatedlen = DeflateSaveGame(joinsave.savebuffer + sizeof(UINT32), length - sizeof(UINT32), deflatedsave + sizeof(UINT32), length - sizeof(UINT32) - 1);
+	if (deflatedlen)
 	{
-		free(savebuffer);
-		save_p = NULL;
-		I_Error("Savegame buffer overrun");
+		p = deflatedsave;
+		WRITEUINT32(p, (length - sizeof(UINT32)) | SAVEGAMEDEFLATED);
+		deflatedlen += sizeof(UINT32);
+	}
+	else
+	{
+		free(deflatedsave);
+		deflatedsave = NULL;
 	}
+#endif
 
 	// Allocate space for compressed save: one byte fewer than for the
 	// uncompressed data to ensure that the compression is worthwhile.
 	compressedsave = malloc(length - 1);
-	if (!compressedsave)
-	{
-		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
-		return;
-	}
 
 	// Attempt to compress it.
-	if((compressedlen = lzf_compress(savebuffer + sizeof(UINT32), length - sizeof(UINT32), compressedsave + sizeof(UINT32), length - sizeof(UINT32) - 1)))
+	if (compressedsave)
+		compressedlen = lzf_compress(joinsave.savebuffer + sizeof(UINT32), length - sizeof(UINT32), compressedsave + sizeof(UINT32), length - sizeof(UINT32) - 1);
+
+	if (compressedlen)
 	{
 		// Compressing succeeded; send compressed data
 
-		free(savebuffer);
+		free(joinsave.savebuffer);
 
 		// State that we're compressed.
 		buffertosend = compressedsave;
-		WRITEUINT32(compressedsave, length - sizeof(UINT32));
+		p = buffertosend;
+		WRITEUINT32(p, length - sizeof(UINT32));
 		length = compressedlen + sizeof(UINT32);
 	}
 	else
@@ -1556,16 +2014,175 @@ static void SV_SendSaveGame(INT32 node)
 		free(compressedsave);
 
 		// State that we're not compressed
-		buffertosend = savebuffer;
-		WRITEUINT32(savebuffer, 0);
+		buffertosend = joinsave.savebuffer;
+		p = buffertosend;
+		WRITEUINT32(p, 0);
+	}
+
+#ifdef HAVE_THREADS
+	I_LockMutex(&joinsave_mutex);
+#endif
+	// Either way buffertosend owns the save now
+	joinsave.savebuffer = NULL;
+	joinsave.buffertosend = buffertosend;
+	joinsave.sendlength = length;
+#ifdef HAVE_ZLIB
+	joinsave.deflated = deflatedsave;
+	joinsave.deflatedlength = deflatedlen;
+#endif
+	joinsave.compresstime = I_PreciseToMicros(I_GetPreciseTime() - starttime);
+	joinsave.ready = true;
+#ifdef HAVE_THREADS
+	I_WakeAllCond(&joinsave_cond);
+	I_UnlockMutex(joinsave_mutex);
+#endif
+}
+
+// Waits for joinsave to be compressed, if it's being compressed
+static void SV_WaitJoinSave(void)
+{
+#ifdef HAVE_THREADS
+	if (!joinsave.made)
+		return;
+
+	I_LockMutex(&joinsave_mutex);
+	while (!joinsave.ready)
+		I_HoldCond(&joinsave_cond, joinsave_mutex);
+	I_UnlockMutex(joinsave_mutex);
+#endif
+}
+
+static void SV_ClearJoinSave(void)
+{
+	SV_WaitJoinSave();
+
+	// SV_CompressJoinSave has handed savebuffer off to buffertosend
+	free(joinsave.buffertosend);
+#ifdef HAVE_ZLIB
+	free(joinsave.deflated);
+#endif
+	memset(&joinsave, 0, sizeof (joinsave));
+}
+
+// Sends joinsave to the nodes waiting for it, once it's ready
+static void SV_SendPendingSaveGames(void)
+{
+	boolean ready;
+	UINT8 *buffertosend;
+	const UINT8 *save;
+	size_t sendlength;
+	INT32 node;
+
+#ifdef HAVE_THREADS
+	I_LockMutex(&joinsave_mutex);
+#endif
+	ready = joinsave.ready;
+#ifdef HAVE_THREADS
+	I_UnlockMutex(joinsave_mutex);
+#endif
+	if (!ready)
+		return;
+
+	if (!joinsave.reported)
+	{
+		CONS_Printf(M_GetText("Join savegame is %s bytes, sending %s (%d%%), compressed in %d ms\n"),
+			sizeu1(joinsave.length), sizeu2(joinsave.sendlength),
+			(INT32)(joinsave.sendlength * 100 / joinsave.length), joinsave.compresstime / 1000);
+#ifdef HAVE_ZLIB
+		if (joinsave.deflated)
+			CONS_Printf(M_GetText("Sending %s (%d%%) deflated to nodes that can inflate it\n"),
+				sizeu1(joinsave.deflatedlength), (INT32)(joinsave.deflatedlength * 100 / joinsave.length));
+#endif
+		joinsave.reported = true;
+	}
+
+	for (node = 0; node < MAXNETNODES; node++)
+	{
+		if (!savegamepending[node])
+			continue;
+		savegamepending[node] = false;
+
+		save = joinsave.buffertosend;
+		sendlength = joinsave.sendlength;
+#ifdef HAVE_ZLIB
+		if (nodedeflatesave[node] && joinsave.deflated)
+		{
+			save = joinsave.deflated;
+			sendlength = joinsave.deflatedlength;
+		}
+#endif
+
+		// Every node gets its own copy, since the transfer frees it
+		buffertosend = malloc(sendlength);
+		if (!buffertosend)
+		{
+			CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
+			continue;
+		}
+		M_Memcpy(buffertosend, save, sendlength);
+		SV_SendRam(node, buffertosend, sendlength, SF_RAM, 0);
+
+		freezetimeout[node] = I_GetTime() + jointimeout + sendlength / 1024; // 1 extra tic for each kilobyte
+	}
+}
+
+// Saves the game for nodes joining on this tic
+static boolean SV_MakeJoinSave(void)
+{
+	UINT8 *savebuffer;
+
+	// Nodes that joined on an earlier tic still need the old one
+	SV_WaitJoinSave();
+	SV_SendPendingSaveGames();
+	SV_ClearJoinSave();
+
+	// first save it in a malloced buffer
+	savebuffer = (UINT8 *)malloc(SAVEGAMESIZE);
+	if (!savebuffer)
+	{
+		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for savegame\n"));
+		return false;
 	}
 
-	SV_SendRam(node, buffertosend, length, SF_RAM, 0);
+	// Leave room for the uncompressed length.
+	save_p = savebuffer + sizeof(UINT32);
+
+	P_SaveNetGame();
+
+	joinsave.length = save_p - savebuffer;
 	save_p = NULL;
+	if (joinsave.length > SAVEGAMESIZE)
+	{
+		free(savebuffer);
+		I_Error("Savegame buffer overrun");
+	}
+
+	joinsave.tic = gametic;
+	joinsave.savebuffer = savebuffer;
+	joinsave.made = true;
+
+	// The game can go on while it's compressed, nothing else touches joinsave until it's ready
+#ifdef HAVE_THREADS
+	I_SpawnThread("join-savegame", SV_CompressJoinSave, NULL);
+#else
+	SV_CompressJoinSave(NULL);
+#endif
+	return true;
+}
+
+static void SV_SendSaveGame(INT32 node)
+{
+	// Other nodes joining on this tic already had the game saved for them
+	if (!(joinsave.made && joinsave.tic == gametic) && !SV_MakeJoinSave())
+		return;
+
+	savegamepending[node] = true;
 
 	// Remember when we started sending the savegame so we can handle timeouts
 	sendingsavegame[node] = true;
-	freezetimeout[node] = I_GetTime() + jointimeout + length / 1024; // 1 extra tic for each kilobyte
+	freezetimeout[node] = I_GetTime() + jointimeout + joinsave.length / 1024; // 1 extra tic for each kilobyte
+
+	SV_SendPendingSaveGames();
 }
 
 #ifdef DUMPCONSISTENCY
@@ -1614,36 +2231,123 @@ static void SV_SavedGame(void)
 #define TMPSAVENAME "$$$.sav"
 
 
+// Reads the savegame the server sent into a Z_Malloc'd buffer.
+// Deflated chunks are inflated one at a time straight into it,
+// so the compressed savegame is never all in memory at once.
+// Returns its uncompressed length, or 0 if it can't be read.
+static size_t CL_ReadSaveGame(const char *tmpsave, UINT8 **savebuffer, size_t *sentlength)
+{
+	UINT8 header[sizeof(UINT32)];
+	UINT8 *p = header;
+	size_t decompressedlen;
+	FILE *f = fopen(tmpsave, "rb");
+
+	if (!f)
+		return 0;
+	if (fread(header, 1, sizeof(header), f) != sizeof(header))
+	{
+		fclose(f);
+		return 0;
+	}
+	decompressedlen = READUINT32(p);
+
+	if (!(decompressedlen & SAVEGAMEDEFLATED))
+	{
+		size_t length;
+
+		fclose(f);
+
+		length = *sentlength = FIL_ReadFile(tmpsave, savebuffer);
+		if (length < sizeof(UINT32))
+		{
+			if (length)
+				Z_Free(*savebuffer);
+			return 0;
+		}
+
+		// Decompress saved game if necessary.
+		if (decompressedlen > 0)
+		{
+			UINT8 *decompressedbuffer = Z_Malloc(decompressedlen, PU_STATIC, NULL);
+			lzf_decompress(*savebuffer + sizeof(UINT32), length - sizeof(UINT32), decompressedbuffer, decompressedlen);
+			Z_Free(*savebuffer);
+			*savebuffer = decompressedbuffer;
+			return decompressedlen;
+		}
+
+		// Skip the header
+		memmove(*savebuffer, *savebuffer + sizeof(UINT32), length - sizeof(UINT32));
+		return length - sizeof(UINT32);
+	}
+
+#ifdef HAVE_ZLIB
+	{
+		const uLong chunkbound = compressBound(SAVEGAMECHUNK);
+		UINT8 *chunk = malloc(chunkbound);
+		size_t pos = 0;
+
+		decompressedlen &= ~SAVEGAMEDEFLATED;
+		*savebuffer = Z_Malloc(decompressedlen, PU_STATIC, NULL);
+		*sentlength = sizeof(header);
+
+		while (chunk && pos < decompressedlen)
+		{
+			const uLongf chunklen = (uLongf)min(decompressedlen - pos, SAVEGAMECHUNK);
+			uLongf outlen = chunklen;
+			UINT32 zlen;
+
+			p = header;
+			if (fread(header, 1, sizeof(header), f) != sizeof(header))
+				break;
+			zlen = READUINT32(p);
+			if (zlen > chunkbound || fread(chunk, 1, zlen, f) != zlen
+				|| uncompress(*savebuffer + pos, &outlen, chunk, zlen) != Z_OK || outlen != chunklen)
+				break;
+
+			pos += chunklen;
+			*sentlength += sizeof(header) + zlen;
+		}
+
+		free(chunk);
+		fclose(f);
+
+		if (pos == decompressedlen)
+			return decompressedlen;
+
+		Z_Free(*savebuffer);
+		*savebuffer = NULL;
+		return 0;
+	}
+#else
+	fclose(f);
+	CONS_Alert(CONS_ERROR, M_GetText("The server sent a deflated savegame, but this build can't inflate it\n"));
+	return 0;
+#endif
+}
+
 static void CL_LoadReceivedSavegame(void)
 {
 	UINT8 *savebuffer = NULL;
-	size_t length, decompressedlen;
+	size_t length, sentlength = 0;
+	precise_t starttime = I_GetPreciseTime();
 	XBOXSTATIC char *tmpsave = Z_Malloc(512, PU_STATIC, NULL);
 
 	snprintf(tmpsave, 512, "%s" PATHSEP TMPSAVENAME, srb2home);
 
-	length = FIL_ReadFile(tmpsave, &savebuffer);
+	length = CL_ReadSaveGame(tmpsave, &savebuffer, &sentlength);
 
-	CONS_Printf(M_GetText("Loading savegame length %s\n"), sizeu1(length));
 	if (!length)
 	{
 		I_Error("Can't read savegame sent");
 		Z_Free(tmpsave);
 		return;
 	}
+	CONS_Printf(M_GetText("Loading savegame length %s, sent as %s (%d%%), read in %d ms\n"),
+		sizeu1(length), sizeu2(sentlength), (INT32)(sentlength * 100 / length),
+		I_PreciseToMicros(I_GetPreciseTime() - starttime) / 1000);
 
 	save_p = savebuffer;
 
-	// Decompress saved game if necessary.
-	decompressedlen = READUINT32(save_p);
-	if(decompressedlen > 0)
-	{
-		UINT8 *decompressedbuffer = Z_Malloc(decompressedlen, PU_STATIC, NULL);
-		lzf_decompress(save_p, length - sizeof(UINT32), decompressedbuffer, decompressedlen);
-		Z_Free(savebuffer);
-		save_p = savebuffer = decompressedbuffer;
-	}
-
 	paused = false;
 	demoplayback = false;
 	titledemo = false;
@@ -1825,6 +2529,49 @@ void CL_UpdateServerList(boolean internetsearch, INT32 room)
 
 #endif // ifndef NONET
 
+/** Asks the server for the files that are still missing
+  *
+  * \return False if the connection was aborted
+  * \sa CL_ServerConnectionCheckFiles
+  *
+  */
+static boolean CL_ServerConnectionRequestFiles(void)
+{
+	INT32 i;
+
+	// The HTTP mirror may have had all of them
+	for (i = 0; i < fileneedednum; i++)
+		if (fileneeded[i].status != FS_FOUND && fileneeded[i].status != FS_OPEN)
+			break;
+	if (i == fileneedednum)
+	{
+		cl_mode = CL_ASKJOIN;
+		return true;
+	}
+
+	// must download something
+	// can we, though?
+	if (!CL_CheckDownloadable()) // nope!
+	{
+		D_QuitNetGame();
+		CL_Reset();
+		D_StartTitle();
+		M_StartMessage(M_GetText(
+			"You cannot connect to this server\n"
+			"because you cannot download the files\n"
+			"that you are missing from the server.\n\n"
+			"See the console or log file for\n"
+			"more details.\n\n"
+			"Press ESC\n"
+		), NULL, MM_NOTHING);
+		return false;
+	}
+	// no problem if can't send packet, we will retry later
+	if (CL_SendRequestFile())
+		cl_mode = CL_DOWNLOADFILES;
+	return true;
+}
+
 static boolean CL_ServerConnectionCheckFiles(tic_t *asksent)
 {
 	INT32 i;
@@ -1863,26 +2610,15 @@ static boolean CL_ServerConnectionCheckFiles(tic_t *asksent)
 		cl_mode = CL_ASKJOIN;
 	else
 	{
-		// must download something
-		// can we, though?
-		if (!CL_CheckDownloadable()) // nope!
+#ifdef HAVE_CURL
+		// Try the server's HTTP mirror first, if it has one
+		if (CL_StartHTTPDownloads())
 		{
-			D_QuitNetGame();
-			CL_Reset();
-			D_StartTitle();
-			M_StartMessage(M_GetText(
-				"You cannot connect to this server\n"
-				"because you cannot download the files\n"
-				"that you are missing from the server.\n\n"
-				"See the console or log file for\n"
-				"more details.\n\n"
-				"Press ESC\n"
-			), NULL, MM_NOTHING);
-			return false;
+			cl_mode = CL_DOWNLOADHTTPFILES;
+			return true;
 		}
-		// no problem if can't send packet, we will retry later
-		if (CL_SendRequestFile())
-			cl_mode = CL_DOWNLOADFILES;
+#endif
+		return CL_ServerConnectionRequestFiles();
 	}
 	return true;
 }
@@ -1985,6 +2721,16 @@ static boolean CL_ServerConnectionTicker(const char *tmpsave, tic_t *oldtic, tic
 				return false;
 			break;
 
+#ifdef HAVE_CURL
+		case CL_DOWNLOADHTTPFILES:
+			if (CL_HTTPDownloadTicker())
+				break; // still downloading
+			// ask the server for whatever the mirror didn't have
+			if (!CL_ServerConnectionRequestFiles())
+				return false;
+			break;
+#endif
+
 		case CL_DOWNLOADFILES:
 			waitmore = false;
 			for (i = 0; i < fileneedednum; i++)
@@ -3021,6 +3767,9 @@ consvar_t cv_noticedownload = {"noticedownload", "Off", CV_SAVE, CV_OnOff, NULL,
 static CV_PossibleValue_t downloadspeed_cons_t[] = {{0, "MIN"}, {300, "MAX"}, {0, NULL}};
 consvar_t cv_downloadspeed = {"downloadspeed", "16", CV_SAVE, downloadspeed_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
 
+// HTTP mirror clients can download the server's files from instead
+consvar_t cv_httpsource = {"http_source", "", CV_SAVE, NULL, NULL, 0, NULL, NULL, 0, 0, NULL};
+
 static void Got_AddPlayer(UINT8 **p, INT32 playernum);
 
 // called one time at init
@@ -3039,10 +3788,12 @@ void D_ClientServerInit(void)
 	COM_AddCommand("reloadbans", Command_ReloadBan);
 	COM_AddCommand("connect", Command_connect);
 	COM_AddCommand("nodes", Command_Nodes);
+	COM_AddCommand("packetstats", Command_PacketStats);
 #ifdef PACKETDROP
 	COM_AddCommand("drop", Command_Drop);
 	COM_AddCommand("droprate", Command_Droprate);
 #endif
+	LoadTest_Init();
 #ifdef _DEBUG
 	COM_AddCommand("numnodes", Command_Numnodes);
 #endif
@@ -3082,6 +3833,10 @@ static void ResetNode(INT32 node)
 	nodewaiting[node] = 0;
 	playerpernode[node] = 0;
 	sendingsavegame[node] = false;
+#ifdef JOININGAME
+	savegamepending[node] = false;
+#endif
+	ResetDeltaTics(node);
 }
 
 void SV_ResetServer(void)
@@ -3116,6 +3871,10 @@ void SV_ResetServer(void)
 	mynode = 0;
 	cl_packetmissed = false;
 
+#ifdef JOININGAME
+	SV_ClearJoinSave();
+#endif
+
 	if (dedicated)
 	{
 		nodeingame[0] = true;
@@ -3544,6 +4303,14 @@ static void HandleConnect(SINT8 node)
 #endif
 			SV_AddNode(node);
 
+			// Older clients send a shorter clientconfig_pak
+			nodedeltatics[node] = (doomcom->datalength >= (INT16)(BASEPACKETSIZE + sizeof (clientconfig_pak))
+				&& (netbuffer->u.clientcfg.flags & CLIENTCFG_DELTATICS));
+#if defined (JOININGAME) && defined (HAVE_ZLIB)
+			nodedeflatesave[node] = (doomcom->datalength >= (INT16)(BASEPACKETSIZE + sizeof (clientconfig_pak))
+				&& (netbuffer->u.clientcfg.flags & CLIENTCFG_DEFLATESAVE));
+#endif
+
 			/// \note Wait what???
 			///       What if the gamestate takes more than one second to get downloaded?
 			///       Or if a lagspike happens?
@@ -3630,6 +4397,12 @@ static void HandleServerInfo(SINT8 node)
 	netbuffer->u.serverinfo.time = (tic_t)LONG(ticdiff);
 	netbuffer->u.serverinfo.servername[MAXSERVERNAME-1] = 0;
 
+	// Clear what's past the end of the packet, so nothing
+	// stale is read as trailing info older servers don't send
+	if ((size_t)doomcom->datalength < BASEPACKETSIZE + sizeof (serverinfo_pak))
+		memset((UINT8 *)netbuffer + doomcom->datalength, 0,
+			BASEPACKETSIZE + sizeof (serverinfo_pak) - doomcom->datalength);
+
 	SL_InsertServer(&netbuffer->u.serverinfo, node);
 }
 #endif
@@ -3818,6 +4591,7 @@ static void HandlePacketFromAwayNode(SINT8 node)
 			break;
 
 		case PT_CLIENTCMD:
+		case PT_CLIENTDELTA:
 			break; // This is not an "unknown packet"
 
 		case PT_SERVERTICS:
@@ -3849,6 +4623,8 @@ static void HandlePacketFromPlayer(SINT8 node)
 	XBOXSTATIC tic_t realend, realstart;
 	XBOXSTATIC UINT8 *pak, *txtpak, numtxtpak;
 	XBOXSTATIC UINT8 finalmd5[16];/* Well, it's the cool thing to do? */
+	XBOXSTATIC boolean deltapak;
+	XBOXSTATIC UINT8 ticflags;
 FILESTAMP
 
 	txtpak = NULL;
@@ -3870,6 +4646,16 @@ FILESTAMP
 				break;
 			SV_AcknowledgeResynchAck(netconsole, netbuffer->u.resynchgot);
 			break;
+		case PT_CLIENTDELTA:
+		case PT_CLIENTDELTAMIS:
+		case PT_CLIENT2DELTA:
+		case PT_CLIENT2DELTAMIS:
+			if (client)
+				break;
+			SV_ReadDeltaCmds(node, netconsole);
+			if (netbuffer->packettype == PT_NOTHING)
+				break;
+			/* FALLTHRU */
 		case PT_CLIENTCMD:
 		case PT_CLIENT2CMD:
 		case PT_CLIENTMIS:
@@ -4128,6 +4914,9 @@ FILESTAMP
 			resynch_local_inprogress = false;
 
 			P_SetRandSeed(netbuffer->u.resynchend.randomseed);
+#ifdef MOBJCONSISTANCY
+			mobjconsistancy = (UINT32)LONG(netbuffer->u.resynchend.mobjconsistancy);
+#endif
 
 			if (gametype == GT_CTF)
 				resynch_read_ctf(&netbuffer->u.resynchend);
@@ -4153,8 +4942,22 @@ FILESTAMP
 
 			realstart = ExpandTics(netbuffer->u.serverpak.starttic);
 			realend = realstart + netbuffer->u.serverpak.numtics;
+			ticflags = (UINT8)(netbuffer->u.serverpak.numslots & ~SERVERTICS_SLOTS);
+			deltapak = (ticflags & SERVERTICS_DELTA);
+			netbuffer->u.serverpak.numslots &= SERVERTICS_SLOTS;
 
-			if (!txtpak)
+			if (deltapak)
+			{
+				cl_deltaserver = true;
+				txtpak = CL_ReadDeltaTics(ticflags);
+				if (!txtpak)
+				{
+					// Resent from a base we have once we stop acknowledging
+					DEBFILE(va("undecodable delta tics %u-%u\n", realstart, realend));
+					break;
+				}
+			}
+			else if (!txtpak)
 				txtpak = (UINT8 *)&netbuffer->u.serverpak.cmds[netbuffer->u.serverpak.numslots
 					* netbuffer->u.serverpak.numtics];
 
@@ -4173,8 +4976,13 @@ FILESTAMP
 					D_Clearticcmd(i);
 
 					// copy the tics
-					pak = G_ScpyTiccmd(netcmds[i%BACKUPTICS], pak,
-						netbuffer->u.serverpak.numslots*sizeof (ticcmd_t));
+					if (deltapak)
+						M_Memcpy(netcmds[i%BACKUPTICS], cl_packetcmds[i - realstart],
+							netbuffer->u.serverpak.numslots*sizeof (ticcmd_t));
+					else
+						pak = G_ScpyTiccmd(netcmds[i%BACKUPTICS], pak,
+							netbuffer->u.serverpak.numslots*sizeof (ticcmd_t));
+					CL_KeepDeltaTic(i, netbuffer->u.serverpak.numslots);
 
 					// copy the textcmds
 					numtxtpak = *txtpak++;
@@ -4343,7 +5151,8 @@ static INT16 Consistancy(void)
 {
 	INT32 i;
 	UINT32 ret = 0;
-#ifdef MOBJCONSISTANCY
+#ifdef MOBJCONSISTANCYWALK
+	UINT32 walk = 0;
 	thinker_t *th;
 	mobj_t *mo;
 #endif
@@ -4369,12 +5178,14 @@ static INT16 Consistancy(void)
 		ret += P_GetRandSeed();
 
 #ifdef MOBJCONSISTANCY
-	if (!thinkercap.next)
-	{
-		DEBFILE(va("Consistancy = %u\n", ret));
-		return ret;
-	}
-	for (th = thinkercap.next; th != &thinkercap; th = th->next)
+	// Every change to a gameplay mobj has been hashed in as it happened
+	ret += mobjconsistancy;
+#endif
+
+#ifdef MOBJCONSISTANCYWALK
+	// Hash them all in full too, so a desync shows up in both, or
+	// in the walk only if a change slipped past P_MobjConsistancy
+	for (th = thinkercap.next; thinkercap.next && th != &thinkercap; th = th->next)
 	{
 		if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 			continue;
@@ -4383,63 +5194,66 @@ static INT16 Consistancy(void)
 
 		if (mo->flags & (MF_SPECIAL | MF_SOLID | MF_PUSHABLE | MF_BOSS | MF_MISSILE | MF_SPRING | MF_MONITOR | MF_FIRE | MF_ENEMY | MF_PAIN | MF_STICKY))
 		{
-			ret -= mo->type;
-			ret += mo->x;
-			ret -= mo->y;
-			ret += mo->z;
-			ret -= mo->momx;
-			ret += mo->momy;
-			ret -= mo->momz;
-			ret += mo->angle;
-			ret -= mo->flags;
-			ret += mo->flags2;
-			ret -= mo->eflags;
+			walk -= mo->type;
+			walk += mo->x;
+			walk -= mo->y;
+			walk += mo->z;
+			walk -= mo->momx;
+			walk += mo->momy;
+			walk -= mo->momz;
+			walk += mo->angle;
+			walk -= mo->flags;
+			walk += mo->flags2;
+			walk -= mo->eflags;
 			if (mo->target)
 			{
-				ret += mo->target->type;
-				ret -= mo->target->x;
-				ret += mo->target->y;
-				ret -= mo->target->z;
-				ret += mo->target->momx;
-				ret -= mo->target->momy;
-				ret += mo->target->momz;
-				ret -= mo->target->angle;
-				ret += mo->target->flags;
-				ret -= mo->target->flags2;
-				ret += mo->target->eflags;
-				ret -= mo->target->state - states;
-				ret += mo->target->tics;
-				ret -= mo->target->sprite;
-				ret += mo->target->frame;
+				walk += mo->target->type;
+				walk -= mo->target->x;
+				walk += mo->target->y;
+				walk -= mo->target->z;
+				walk += mo->target->momx;
+				walk -= mo->target->momy;
+				walk += mo->target->momz;
+				walk -= mo->target->angle;
+				walk += mo->target->flags;
+				walk -= mo->target->flags2;
+				walk += mo->target->eflags;
+				walk -= mo->target->state - states;
+				walk += mo->target->tics;
+				walk -= mo->target->sprite;
+				walk += mo->target->frame;
 			}
 			else
-				ret ^= 0x3333;
+				walk ^= 0x3333;
 			if (mo->tracer && mo->tracer->type != MT_OVERLAY)
 			{
-				ret += mo->tracer->type;
-				ret -= mo->tracer->x;
-				ret += mo->tracer->y;
-				ret -= mo->tracer->z;
-				ret += mo->tracer->momx;
-				ret -= mo->tracer->momy;
-				ret += mo->tracer->momz;
-				ret -= mo->tracer->angle;
-				ret += mo->tracer->flags;
-				ret -= mo->tracer->flags2;
-				ret += mo->tracer->eflags;
-				ret -= mo->tracer->state - states;
-				ret += mo->tracer->tics;
-				ret -= mo->tracer->sprite;
-				ret += mo->tracer->frame;
+				walk += mo->tracer->type;
+				walk -= mo->tracer->x;
+				walk += mo->tracer->y;
+				walk -= mo->tracer->z;
+				walk += mo->tracer->momx;
+				walk -= mo->tracer->momy;
+				walk += mo->tracer->momz;
+				walk -= mo->tracer->angle;
+				walk += mo->tracer->flags;
+				walk -= mo->tracer->flags2;
+				walk += mo->tracer->eflags;
+				walk -= mo->tracer->state - states;
+				walk += mo->tracer->tics;
+				walk -= mo->tracer->sprite;
+				walk += mo->tracer->frame;
 			}
 			else
-				ret ^= 0xAAAA;
-			ret -= mo->state - states;
-			ret += mo->tics;
-			ret -= mo->sprite;
-			ret += mo->frame;
+				walk ^= 0xAAAA;
+			walk -= mo->state - states;
+			walk += mo->tics;
+			walk -= mo->sprite;
+			walk += mo->frame;
 		}
 	}
+
+	DEBFILE(va("Mobj consistancy = %u, walked = %u\n", mobjconsistancy, walk));
+	ret += walk;
 #endif
 
 	DEBFILE(va("Consistancy = %u\n", (ret & 0xFFFF)));
@@ -4468,18 +5282,27 @@ static void CL_SendClientCmd(void)
 	}
 	else if (gamestate != GS_NULL)
 	{
-		G_MoveTiccmd(&netbuffer->u.clientpak.cmd, &localcmds, 1);
 		netbuffer->u.clientpak.consistancy = SHORT(consistancy[gametic%BACKUPTICS]);
 
 		// Send a special packet with 2 cmd for splitscreen
 		if (splitscreen || botingame)
-		{
 			netbuffer->packettype += 2;
-			G_MoveTiccmd(&netbuffer->u.client2pak.cmd2, &localcmds2, 1);
-			packetsize = sizeof (client2cmd_pak);
-		}
+
+		// Code the cmds against our own cmd in the last tic we got, if the server can read that
+		packetsize = CL_WriteDeltaCmds(splitscreen || botingame);
+		if (packetsize)
+			netbuffer->packettype += PT_CLIENTDELTA - PT_CLIENTCMD;
 		else
-			packetsize = sizeof (clientcmd_pak);
+		{
+			G_MoveTiccmd(&netbuffer->u.clientpak.cmd, &localcmds, 1);
+			if (splitscreen || botingame)
+			{
+				G_MoveTiccmd(&netbuffer->u.client2pak.cmd2, &localcmds2, 1);
+				packetsize = sizeof (client2cmd_pak);
+			}
+			else
+				packetsize = sizeof (clientcmd_pak);
+		}
 
 		HSendPacket(servernode, false, 0, packetsize);
 	}
@@ -4508,16 +5331,127 @@ static void CL_SendClientCmd(void)
 	}
 }
 
+// Everything in PT_SERVERTICS but the header is the same for every node
+// sent a given tic, so it's encoded once per SV_SendTics in here
+static UINT8 svticcmds[BACKUPTICS*MAXPLAYERS*sizeof (ticcmd_t)];
+static UINT8 svtextcmds[BACKUPTICS*(1 + MAXPLAYERS*(1 + MAXTEXTCMD))];
+static size_t svtextend[BACKUPTICS]; // where each tic's textcmds end in svtextcmds
+static UINT8 svdeltacmds[BACKUPTICS*MAXPLAYERS*MAXDELTATICCMD];
+static size_t svdeltaend[BACKUPTICS]; // where each tic's delta against the tic before ends
+static tic_t svsharedtic; // tic at the start of the buffers
+static boolean svsharedvalid, svdeltavalid;
+
+// Encodes tics firstticstosend to maketic-1 into the shared buffers
+static void SV_EncodeSharedTics(void)
+{
+	UINT8 *cmdpos = svticcmds;
+	UINT8 *textpos = svtextcmds;
+	UINT8 *ntextcmd;
+	tic_t i;
+	INT32 j;
+
+	svsharedtic = firstticstosend;
+
+	for (i = firstticstosend; i < maketic; i++)
+	{
+		cmdpos = G_DcpyTiccmd(cmdpos, netcmds[i%BACKUPTICS], doomcom->numslots * sizeof (ticcmd_t));
+
+		ntextcmd = textpos++;
+		*ntextcmd = 0;
+		for (j = 0; j < MAXPLAYERS; j++)
+		{
+			UINT8 *textcmd = D_GetExistingTextcmd(i, j);
+			INT32 size = textcmd ? textcmd[0] : 0;
+
+			if ((!j || playeringame[j]) && size)
+			{
+				(*ntextcmd)++;
+				WRITEUINT8(textpos, j);
+				M_Memcpy(textpos, textcmd, size + 1);
+				textpos += size + 1;
+			}
+		}
+		svtextend[i - firstticstosend] = textpos - svtextcmds;
+	}
+
+	svsharedvalid = true;
+}
+
+// Delta codes each tic after firstticstosend against the one before it.
+// A node's first tic is coded against its own base in SV_WriteDeltaTics.
+static void SV_EncodeSharedDeltaTics(void)
+{
+	UINT8 *p = svdeltacmds;
+	tic_t i;
+	INT32 j;
+
+	svdeltaend[0] = 0;
+	for (i = firstticstosend + 1; i < maketic; i++)
+	{
+		for (j = 0; j < doomcom->numslots; j++)
+			p = WriteDeltaTiccmd(p, &netcmds[i%BACKUPTICS][j], &netcmds[(i-1)%BACKUPTICS][j]);
+		svdeltaend[i - firstticstosend] = p - svdeltacmds;
+	}
+
+	svdeltavalid = true;
+}
+
+// Size of the shared textcmds of tics firsttic to lasttic-1
+static inline size_t SV_SharedTextSize(tic_t firsttic, tic_t lasttic)
+{
+	const size_t start = (firsttic > svsharedtic) ? svtextend[firsttic - svsharedtic - 1] : 0;
+	return svtextend[lasttic - svsharedtic - 1] - start;
+}
+
+// Size of the delta coded cmds of tics firsttic+1 to lasttic-1
+static inline size_t SV_SharedDeltaSize(tic_t firsttic, tic_t lasttic)
+{
+	return svdeltaend[lasttic - svsharedtic - 1] - svdeltaend[firsttic - svsharedtic];
+}
+
+#ifdef PARANOIA
+// Decodes the delta coded cmds just put in netbuffer for node the way
+// CL_ReadDeltaTics will, and checks they come back out as netcmds
+static void SV_CheckDeltaTics(INT32 node, tic_t firsttic, const UINT8 *end)
+{
+	static ticcmd_t cmds[BACKUPTICS][MAXPLAYERS];
+	servertics_pak *pak = &netbuffer->u.serverpak;
+	const INT32 numslots = pak->numslots & SERVERTICS_SLOTS;
+	const ticcmd_t *prev = emptycmds;
+	UINT8 *p = (UINT8 *)&pak->cmds;
+	INT32 i;
+
+	if (pak->numslots & SERVERTICS_BASE)
+	{
+		const tic_t base = nettics[node] - 1;
+
+		if (READUINT8(p) != (UINT8)base)
+			I_Error("SV_CheckDeltaTics: wrong base for node %d", node);
+		prev = deltasent[node][base%BACKUPTICS];
+	}
+
+	if (ReadDeltaTics(p, end, prev, cmds, pak->numtics, numslots) != end)
+		I_Error("SV_CheckDeltaTics: tics %d-%d for node %d don't decode",
+			firsttic, firsttic + pak->numtics, node);
+
+	for (i = 0; i < pak->numtics; i++)
+		if (memcmp(cmds[i], netcmds[(firsttic + i)%BACKUPTICS], numslots * sizeof (ticcmd_t)))
+			I_Error("SV_CheckDeltaTics: tic %d for node %d decodes wrong", firsttic + i, node);
+}
+#endif
+
 // send the server packet
 // send tic from firstticstosend to maketic-1
 static void SV_SendTics(void)
 {
 	tic_t realfirsttic, lasttictosend, i;
 	UINT32 n;
-	INT32 j;
-	size_t packsize;
+	size_t packsize, cmdsize, textsize;
 	UINT8 *bufpos;
-	UINT8 *ntextcmd;
+	UINT8 deltaflags;
+	precise_t sendtime = I_GetPreciseTime();
+
+	svsharedvalid = svdeltavalid = false;
 
 	// send to all client but not to me
 	// for each node create a packet with x tics and send it
@@ -4546,12 +5480,27 @@ static void SV_SendTics(void)
 			if (realfirsttic < firstticstosend)
 				realfirsttic = firstticstosend;
 
+			if (!svsharedvalid)
+				SV_EncodeSharedTics();
+
+			// only the first tic of delta coded cmds depends on the node
+			deltaflags = 0;
+			if (nodedeltatics[n])
+			{
+				if (!svdeltavalid)
+					SV_EncodeSharedDeltaTics();
+				deltaflags = SV_WriteDeltaTics(n, realfirsttic);
+			}
+
 			// compute the length of the packet and cut it if too large
 			packsize = BASESERVERTICSSIZE;
 			for (i = realfirsttic; i < lasttictosend; i++)
 			{
-				packsize += sizeof (ticcmd_t) * doomcom->numslots;
-				packsize += TotalTextCmdPerTic(i);
+				if (deltaflags)
+					cmdsize = deltaticsize + SV_SharedDeltaSize(realfirsttic, i + 1);
+				else
+					cmdsize = (i + 1 - realfirsttic) * doomcom->numslots * sizeof (ticcmd_t);
+				packsize = BASESERVERTICSSIZE + cmdsize + SV_SharedTextSize(realfirsttic, i + 1);
 
 				if (packsize > software_MAXPACKETLENGTH)
 				{
@@ -4586,30 +5535,30 @@ static void SV_SendTics(void)
 			netbuffer->u.serverpak.numslots = (UINT8)SHORT(doomcom->numslots);
 			bufpos = (UINT8 *)&netbuffer->u.serverpak.cmds;
 
-			for (i = realfirsttic; i < lasttictosend; i++)
+			if (deltaflags)
 			{
-				bufpos = G_DcpyTiccmd(bufpos, netcmds[i%BACKUPTICS], doomcom->numslots * sizeof (ticcmd_t));
+				netbuffer->u.serverpak.numslots |= deltaflags;
+				M_Memcpy(bufpos, deltaticbuf, deltaticsize);
+				bufpos += deltaticsize;
+				cmdsize = SV_SharedDeltaSize(realfirsttic, lasttictosend);
+				M_Memcpy(bufpos, svdeltacmds + svdeltaend[realfirsttic - svsharedtic], cmdsize);
+				bufpos += cmdsize;
+#ifdef PARANOIA
+				SV_CheckDeltaTics(n, realfirsttic, bufpos);
+#endif
+				SV_KeepDeltaTics(n, realfirsttic, lasttictosend);
 			}
-
-			// add textcmds
-			for (i = realfirsttic; i < lasttictosend; i++)
+			else
 			{
-				ntextcmd = bufpos++;
-				*ntextcmd = 0;
-				for (j = 0; j < MAXPLAYERS; j++)
-				{
-					UINT8 *textcmd = D_GetExistingTextcmd(i, j);
-					INT32 size = textcmd ? textcmd[0] : 0;
-
-					if ((!j || playeringame[j]) && size)
-					{
-						(*ntextcmd)++;
-						WRITEUINT8(bufpos, j);
-						M_Memcpy(bufpos, textcmd, size + 1);
-						bufpos += size + 1;
-					}
-				}
+				cmdsize = (lasttictosend - realfirsttic) * doomcom->numslots * sizeof (ticcmd_t);
+				M_Memcpy(bufpos, svticcmds + (realfirsttic - svsharedtic) * doomcom->numslots * sizeof (ticcmd_t), cmdsize);
+				bufpos += cmdsize;
 			}
+
+			// add textcmds
+			textsize = SV_SharedTextSize(realfirsttic, lasttictosend);
+			M_Memcpy(bufpos, svtextcmds + svtextend[lasttictosend - svsharedtic - 1] - textsize, textsize);
+			bufpos += textsize;
 			packsize = bufpos - (UINT8 *)&(netbuffer->u);
 
 			HSendPacket(n, false, 0, packsize);
@@ -4622,6 +5571,8 @@ static void SV_SendTics(void)
 		}
 	// node 0 is me!
 	supposedtics[0] = maketic;
+
+	ps_netsendtime.value.p += I_GetPreciseTime() - sendtime;
 }
 
 //
@@ -4790,7 +5741,11 @@ boolean TryRunTics(tic_t realtics)
 				{
 					PS_STOP_TIMING(ps_tictime);
 					PS_UpdateTickStats();
+#ifndef NONET
+					LoadTest_CountTic(ps_tictime.value.p);
+#endif
 				}
+				ps_netsendtime.value.p = 0; // Counts from one tic to the next
 			}
 	}
 	else
@@ -4869,6 +5824,10 @@ void NetUpdate(void)
 	INT32 i;
 	INT32 realtics;
 
+#ifndef NONET
+	LoadTest_Ticker(); // Before anything else, so the bots keep up with the server
+#endif
+
 	nowtime = I_GetTime();
 	realtics = nowtime - gametime;
 
@@ -4961,6 +5920,10 @@ FILESTAMP
 				hu_resynching = true;
 		}
 	}
+#ifdef JOININGAME
+	if (server)
+		SV_SendPendingSaveGames();
+#endif
 	Net_AckTicker();
 	// Handle timeouts to prevent definitive freezes from happenning
 	if (server)
@@ -4975,6 +5938,9 @@ FILESTAMP
 		CON_Ticker();
 	}
 	SV_FileSendTicker();
+
+	if (I_NetFlush)
+		I_NetFlush();
 }
 
 /** Returns the number of players playing.
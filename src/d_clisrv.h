@@ -76,6 +76,11 @@ typedef enum
 #ifdef NEWPING
 	PT_PING,          // Packet sent to tell clients the other client's latency to server.
 #endif
+
+	PT_CLIENTDELTA,   // PT_CLIENTCMD with delta coded ticcmds, see CL_SendClientCmd.
+	PT_CLIENTDELTAMIS,// Keep these four in the same order as PT_CLIENTCMD and co.
+	PT_CLIENT2DELTA,
+	PT_CLIENT2DELTAMIS,
 	NUMPACKETTYPE
 } packettype_t;
 
@@ -83,6 +88,7 @@ typedef enum
 void Command_Drop(void);
 void Command_Droprate(void);
 #endif
+void Command_PacketStats(void);
 #ifdef _DEBUG
 void Command_Numnodes(void);
 #endif
@@ -110,6 +116,18 @@ typedef struct
 	ticcmd_t cmd, cmd2;
 } ATTRPACK client2cmd_pak;
 
+// Delta coded client packet, for servers that sent us delta coded tics
+// WARNING: must start with the same fields as clientcmd_pak
+typedef struct
+{
+	UINT8 client_tic;
+	UINT8 resendfrom;
+	INT16 consistancy;
+	UINT8 basetic; // Low byte of the tic the first cmd is coded against
+	UINT8 baseslot; // Player slot in that tic, must be our own
+	UINT8 cmds[0];
+} ATTRPACK clientdelta_pak;
+
 #ifdef _MSC_VER
 #pragma warning(disable :  4200)
 #endif
@@ -124,6 +142,12 @@ typedef struct
 	ticcmd_t cmds[45]; // Normally [BACKUPTIC][MAXPLAYERS] but too large
 } ATTRPACK servertics_pak;
 
+// Flags in the top bits of servertics_pak.numslots,
+// only ever sent to clients that asked for CLIENTCFG_DELTATICS
+#define SERVERTICS_DELTA 0x80 // cmds are delta coded, see SV_SendTics
+#define SERVERTICS_BASE  0x40 // cmds start with the low byte of the tic the first deltas are against
+#define SERVERTICS_SLOTS 0x3F
+
 // Sent to client when all consistency data
 // for players has been restored
 typedef struct
@@ -147,6 +171,9 @@ typedef struct
 	INT16 totalring[MAXPLAYERS];
 	tic_t realtime[MAXPLAYERS];
 	UINT8 laps[MAXPLAYERS];
+#ifdef MOBJCONSISTANCY
+	UINT32 mobjconsistancy; // Carry on from the server's mobj hash
+#endif
 } ATTRPACK resynchend_pak;
 
 typedef struct
@@ -309,8 +336,12 @@ typedef struct
 	UINT8 subversion; // Contains build version
 	UINT8 localplayers;
 	UINT8 mode;
+	UINT8 flags; // Older clients don't send this
 } ATTRPACK clientconfig_pak;
 
+#define CLIENTCFG_DELTATICS 0x01 // Can read delta coded PT_SERVERTICS
+#define CLIENTCFG_DEFLATESAVE 0x02 // Can inflate a join savegame sent as deflated chunks
+
 #define MAXSERVERNAME 32
 #define MAXFILENEEDED 915
 // This packet is too large
@@ -393,6 +424,7 @@ typedef struct
 	{
 		clientcmd_pak clientpak;            //         144 bytes
 		client2cmd_pak client2pak;          //         200 bytes
+		clientdelta_pak clientdeltapak;     //
 		servertics_pak serverpak;           //      132495 bytes (more around 360, no?)
 		serverconfig_pak servercfg;         //         773 bytes
 		resynchend_pak resynchend;          //
@@ -479,10 +511,11 @@ extern UINT32 realpingtable[MAXPLAYERS];
 extern UINT32 playerpingtable[MAXPLAYERS];
 #endif
 
-extern consvar_t cv_joinnextround, cv_allownewplayer, cv_maxplayers, cv_resynchattempts, cv_blamecfail, cv_maxsend, cv_noticedownload, cv_downloadspeed;
+extern consvar_t cv_joinnextround, cv_allownewplayer, cv_maxplayers, cv_resynchattempts, cv_blamecfail, cv_maxsend, cv_noticedownload, cv_downloadspeed, cv_httpsource;
 
 // Used in d_net, the only dependence
 tic_t ExpandTics(INT32 low);
+INT16 SV_GetConsistancy(tic_t tic);
 void D_ClientServerInit(void);
 
 // Initialise the other field
@@ -0,0 +1,1018 @@
+// SONIC ROBO BLAST 2
+//-----------------------------------------------------------------------------
+// Copyright (C) 2020-2023 by Sonic Team Junior.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  d_loadtest.c
+/// \brief Simulated clients for load testing a server
+///
+///        The bots sit in place of the network driver, under HSendPacket
+///        and HGetPacket: packets to and from their nodes go through a
+///        queue that delays and drops them, everything else goes to the
+///        real driver. They speak just enough of the protocol to join,
+///        acknowledge reliable packets, answer resynchs and send ticcmds.
+///        Since they run in the server's own process, the consistancy
+///        they send back is read straight from the server.
+
+#include "doomdef.h"
+#include "d_loadtest.h"
+
+#ifndef NONET
+#include "command.h"
+#include "console.h"
+#include "d_clisrv.h"
+#include "d_main.h" // srb2home
+#include "d_net.h"
+#include "d_netfil.h"
+#include "doomstat.h"
+#include "g_game.h"
+#include "i_net.h"
+#include "i_time.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "z_zone.h"
+
+#define LOADTESTQUEUE 2048 // Packets on the fake link at once
+#define LOADTESTPENDING 16 // Reliable packets a bot holds on to when they come out of order
+
+typedef enum
+{
+	LB_NONE,
+	LB_JOINING, // Sent PT_CLIENTJOIN, waiting for PT_SERVERCFG
+	LB_LOADING, // Receiving the join savegame
+	LB_PLAYING,
+	LB_QUITTING, // Out of the game, only acknowledging until the node is freed
+} loadbotstate_t;
+
+static const char *loadbotstatename[] = {"", "joining", "loading", "playing", "quitting"};
+
+typedef struct
+{
+	loadbotstate_t state;
+	INT32 node;
+	boolean ingame; // The server has taken the node in
+
+	// Reliable packets received, the way node_t in d_net.c keeps them
+	UINT8 firstack; // Every ack up to this one was received
+	UINT8 pending[LOADTESTPENDING]; // Received ahead of firstack
+	UINT8 numpending;
+	boolean needack; // Got a reliable packet since last sending anything
+
+	tic_t neededtic; // First tic not received from the server yet
+	boolean packetmissed;
+	boolean resynching;
+	boolean gotfragment; // Part of the savegame came
+	tic_t statetime; // I_GetTime when the state last changed or PT_CLIENTJOIN was sent
+
+	// Scripted input
+	UINT32 seed;
+	tic_t scripttic;
+	UINT16 angle;
+	INT16 turn;
+	SINT8 forward, side;
+	tic_t nextchange;
+	UINT8 jumptics;
+
+	// Since the last report
+	UINT32 sentbytes, gotbytes;
+	UINT32 sentpackets, gotpackets;
+	UINT32 lost, resyncs;
+} loadbot_t;
+
+typedef struct
+{
+	precise_t due;
+	UINT32 order; // Packets due at the same time go in the order they were sent
+	INT32 node;
+	boolean toserver;
+	INT16 length;
+	union {
+		UINT8 raw[MAXPACKETLENGTH];
+		doomdata_t data;
+	} pak;
+} loadpacket_t;
+
+enum
+{
+	LS_IDLE,
+	LS_RUN,
+	LS_WANDER,
+	LS_REPLAY,
+};
+
+static CV_PossibleValue_t loadtestlatency_cons_t[] = {{0, "MIN"}, {2000, "MAX"}, {0, NULL}};
+static CV_PossibleValue_t loadtestjitter_cons_t[] = {{0, "MIN"}, {1000, "MAX"}, {0, NULL}};
+static CV_PossibleValue_t loadtestpercent_cons_t[] = {{0, "MIN"}, {100, "MAX"}, {0, NULL}};
+static CV_PossibleValue_t loadtestscript_cons_t[] = {{LS_IDLE, "Idle"}, {LS_RUN, "Run"}, {LS_WANDER, "Wander"}, {LS_REPLAY, "Replay"}, {0, NULL}};
+static CV_PossibleValue_t loadtestreport_cons_t[] = {{0, "MIN"}, {3600, "MAX"}, {0, NULL}};
+
+static void LoadTest_LoadReplay(void);
+
+static consvar_t cv_loadtest_latency = {"loadtest_latency", "0", 0, loadtestlatency_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
+static consvar_t cv_loadtest_jitter = {"loadtest_jitter", "0", 0, loadtestjitter_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
+static consvar_t cv_loadtest_loss = {"loadtest_loss", "0", 0, loadtestpercent_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
+static consvar_t cv_loadtest_desync = {"loadtest_desync", "0", 0, loadtestpercent_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
+static consvar_t cv_loadtest_script = {"loadtest_script", "Wander", 0, loadtestscript_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
+static consvar_t cv_loadtest_replay = {"loadtest_replay", "", CV_CALL|CV_NOINIT, NULL, LoadTest_LoadReplay, 0, NULL, NULL, 0, 0, NULL};
+static consvar_t cv_loadtest_report = {"loadtest_report", "0", 0, loadtestreport_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL};
+static consvar_t cv_loadtest_seed = {"loadtest_seed", "0", 0, CV_Unsigned, NULL, 0, NULL, NULL, 0, 0, NULL};
+
+static loadbot_t bots[MAXNETNODES]; // By node
+static INT32 numbots = 0, wantedbots = 0;
+
+static loadpacket_t *linkqueue = NULL;
+static INT32 linkqueued = 0;
+static UINT32 linkorder = 0;
+static UINT32 linkseed;
+
+// The driver the bots are slipped in front of
+static boolean installed = false;
+static boolean (*realget)(void);
+static void (*realsend)(void);
+static void (*realfreenode)(INT32 nodenum);
+static void (*realclose)(void);
+
+// Server tics since the last report
+static UINT32 ticcount;
+static precise_t tictotal, ticmax;
+static tic_t reporttime;
+
+static ticcmd_t *replaycmds = NULL;
+static size_t replaycount = 0;
+
+static FILE *recordfile = NULL;
+static tic_t recordtic;
+
+// Xorshift, so runs with the same loadtest_seed do the same things
+static UINT32 LoadTest_Random(UINT32 *seed)
+{
+	UINT32 x = *seed;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return *seed = x;
+}
+
+// Same as cmpack in d_net.c
+static INT32 LoadTest_CmpAck(UINT8 a, UINT8 b)
+{
+	INT32 d = a - b;
+
+	if (d >= 127 || d < -128)
+		return -d;
+	return d;
+}
+
+static UINT8 LoadTest_NextAck(UINT8 ack)
+{
+	ack++;
+	return ack ? ack : 1;
+}
+
+// Like ExpandTics, but from the tic the bot is waiting for
+static tic_t LoadTest_ExpandTic(const loadbot_t *bot, INT32 low)
+{
+	const INT32 delta = low - (bot->neededtic & UINT8_MAX);
+
+	if (delta >= -64 && delta <= 64)
+		return (bot->neededtic & ~UINT8_MAX) + low;
+	else if (delta > 64)
+		return (bot->neededtic & ~UINT8_MAX) - 256 + low;
+	else
+		return (bot->neededtic & ~UINT8_MAX) + 256 + low;
+}
+
+// -----------------------------------------------------------------
+// The fake link
+// -----------------------------------------------------------------
+
+// Puts a packet on the link, unless it gets lost on the way.
+// Direct packets skip the latency and the loss.
+static void LoadTest_Queue(INT32 node, boolean toserver, const void *data, size_t length, boolean direct)
+{
+	loadpacket_t *p;
+	UINT32 delay = 0;
+
+	if (!direct && cv_loadtest_loss.value
+		&& (INT32)(LoadTest_Random(&linkseed) % 100) < cv_loadtest_loss.value)
+	{
+		bots[node].lost++;
+		return;
+	}
+
+	if (linkqueued == LOADTESTQUEUE)
+	{
+		// The link is full, drop it like a router would
+		bots[node].lost++;
+		return;
+	}
+
+	// Half the round trip each way, plus up to the jitter
+	if (!direct)
+	{
+		delay = cv_loadtest_latency.value / 2;
+		if (cv_loadtest_jitter.value)
+			delay += LoadTest_Random(&linkseed) % (cv_loadtest_jitter.value + 1);
+	}
+
+	p = &linkqueue[linkqueued++];
+	p->due = I_GetPreciseTime() + (precise_t)(delay * I_GetPrecisePrecision() / 1000);
+	p->order = linkorder++;
+	p->node = node;
+	p->toserver = toserver;
+	p->length = (INT16)length;
+	M_Memcpy(p->pak.raw, data, length);
+}
+
+// Finds the next packet that has been on the link long enough, -1 if none has
+static INT32 LoadTest_NextDue(boolean toserver)
+{
+	const precise_t now = I_GetPreciseTime();
+	INT32 i, next = -1;
+
+	for (i = 0; i < linkqueued; i++)
+	{
+		const loadpacket_t *p = &linkqueue[i];
+
+		if (p->toserver != toserver || p->due > now)
+			continue;
+		if (next == -1 || p->due < linkqueue[next].due
+			|| (p->due == linkqueue[next].due && p->order < linkqueue[next].order))
+			next = i;
+	}
+
+	return next;
+}
+
+static void LoadTest_Unqueue(INT32 i)
+{
+	if (i != --linkqueued)
+		M_Memcpy(&linkqueue[i], &linkqueue[linkqueued], sizeof (*linkqueue));
+}
+
+// -----------------------------------------------------------------
+// The bots
+// -----------------------------------------------------------------
+
+static void LoadTest_BotSend(loadbot_t *bot, doomdata_t *pak, size_t length, boolean direct)
+{
+	// Bots send nothing reliably, they just send it again
+	pak->ack = 0;
+	pak->ackreturn = bot->firstack;
+	pak->reserved = 0;
+	length += BASEPACKETSIZE;
+
+	bot->needack = false;
+	bot->sentbytes += packetheaderlength + length;
+	bot->sentpackets++;
+	LoadTest_Queue(bot->node, true, pak, length, direct);
+}
+
+static void LoadTest_SendJoin(loadbot_t *bot, boolean direct)
+{
+	doomdata_t pak;
+
+	pak.packettype = PT_CLIENTJOIN;
+	pak.u.clientcfg.version = VERSION;
+	pak.u.clientcfg.subversion = SUBVERSION;
+	pak.u.clientcfg.localplayers = 1;
+	pak.u.clientcfg.mode = 0;
+	// The bots never decode the tics, but the server still has to code them
+	pak.u.clientcfg.flags = CLIENTCFG_DELTATICS;
+
+	LoadTest_BotSend(bot, &pak, sizeof (clientconfig_pak), direct);
+	bot->statetime = I_GetTime();
+}
+
+// Like Net_SendAcks, for the packets that came ahead of the rest
+static void LoadTest_SendAcks(loadbot_t *bot)
+{
+	doomdata_t pak;
+
+	pak.packettype = PT_NOTHING;
+	memset(pak.u.textcmd, 0, MAXACKTOSEND);
+	M_Memcpy(pak.u.textcmd, bot->pending, bot->numpending);
+	LoadTest_BotSend(bot, &pak, MAXACKTOSEND, false);
+}
+
+static void LoadTest_BuildCmd(loadbot_t *bot, ticcmd_t *cmd)
+{
+	memset(cmd, 0, sizeof (*cmd));
+
+	switch (cv_loadtest_script.value)
+	{
+		case LS_RUN: // Wide circles
+			cmd->forwardmove = MAXPLMOVE;
+			bot->angle += 128;
+			break;
+
+		case LS_WANDER:
+			if (bot->scripttic >= bot->nextchange)
+			{
+				bot->forward = (SINT8)(MAXPLMOVE/2 + LoadTest_Random(&bot->seed) % (MAXPLMOVE/2 + 1));
+				bot->side = (SINT8)((INT32)(LoadTest_Random(&bot->seed) % (MAXPLMOVE + 1)) - MAXPLMOVE/2);
+				bot->turn = (INT16)((INT32)(LoadTest_Random(&bot->seed) % 2049) - 1024);
+				bot->nextchange = bot->scripttic + TICRATE + LoadTest_Random(&bot->seed) % (2*TICRATE);
+			}
+			cmd->forwardmove = bot->forward;
+			cmd->sidemove = bot->side;
+			bot->angle += bot->turn;
+
+			if (!bot->jumptics && !(LoadTest_Random(&bot->seed) % TICRATE))
+				bot->jumptics = TICRATE/3;
+			if (bot->jumptics)
+			{
+				bot->jumptics--;
+				cmd->buttons |= BT_JUMP;
+			}
+			if (!(LoadTest_Random(&bot->seed) % (3*TICRATE)))
+				cmd->buttons |= BT_USE;
+			break;
+
+		case LS_REPLAY:
+			if (replaycount)
+			{
+				// Every bot starts somewhere else in the recording
+				G_MoveTiccmd(cmd, &replaycmds[(bot->scripttic + bot->node*TICRATE) % replaycount], 1);
+				cmd->angleturn |= TICCMD_RECEIVED;
+				bot->scripttic++;
+				return;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	cmd->angleturn = (INT16)(bot->angle | TICCMD_RECEIVED);
+	bot->scripttic++;
+}
+
+// Like CL_SendClientCmd
+static void LoadTest_SendCmd(loadbot_t *bot)
+{
+	doomdata_t pak;
+	ticcmd_t cmd;
+	size_t length;
+	const tic_t tic = min(bot->neededtic, gametic); // The last tic the bot could have run
+
+	pak.packettype = PT_CLIENTCMD;
+	if (bot->packetmissed)
+		pak.packettype++;
+	pak.u.clientpak.resendfrom = (UINT8)(bot->neededtic & UINT8_MAX);
+	pak.u.clientpak.client_tic = (UINT8)(tic & UINT8_MAX);
+
+	if (gamestate == GS_WAITINGPLAYERS)
+	{
+		// Send PT_NODEKEEPALIVE packet
+		pak.packettype += 4;
+		length = sizeof (clientcmd_pak) - sizeof (ticcmd_t) - sizeof (INT16);
+	}
+	else
+	{
+		INT16 consistancy = SV_GetConsistancy(tic);
+
+		if (cv_loadtest_desync.value
+			&& (INT32)(LoadTest_Random(&linkseed) % 100) < cv_loadtest_desync.value)
+			consistancy++;
+		pak.u.clientpak.consistancy = SHORT(consistancy);
+
+		LoadTest_BuildCmd(bot, &cmd);
+		G_MoveTiccmd(&pak.u.clientpak.cmd, &cmd, 1);
+		length = sizeof (clientcmd_pak);
+	}
+
+	LoadTest_BotSend(bot, &pak, length, false);
+}
+
+// Works out if a reliable packet is new, the way Processackpak does
+static boolean LoadTest_GotAck(loadbot_t *bot, UINT8 ack)
+{
+	INT32 i;
+
+	bot->needack = true;
+
+	if (LoadTest_CmpAck(ack, bot->firstack) <= 0)
+		return false;
+	for (i = 0; i < bot->numpending; i++)
+		if (bot->pending[i] == ack)
+			return false;
+
+	if (ack != LoadTest_NextAck(bot->firstack))
+	{
+		if (bot->numpending == LOADTESTPENDING)
+			return false; // The server will send it again
+		bot->pending[bot->numpending++] = ack;
+		return true;
+	}
+
+	// Catch up with the ones that came early
+	bot->firstack = ack;
+	for (i = 0; i < bot->numpending;)
+	{
+		if (bot->pending[i] == LoadTest_NextAck(bot->firstack))
+		{
+			bot->firstack = bot->pending[i];
+			bot->pending[i] = bot->pending[--bot->numpending];
+			i = 0;
+		}
+		else
+			i++;
+	}
+
+	return true;
+}
+
+static void LoadTest_BotReceive(loadbot_t *bot, doomdata_t *pak, size_t length)
+{
+	tic_t realstart, realend;
+
+	if (pak->ack && !LoadTest_GotAck(bot, pak->ack))
+		return; // Already had it
+
+	switch (pak->packettype)
+	{
+		case PT_SERVERCFG:
+			if (bot->state != LB_JOINING)
+				break;
+			bot->neededtic = (tic_t)LONG(pak->u.servercfg.gametic);
+			// HandleConnect sends a savegame in these
+			if (gamestate == GS_LEVEL || gamestate == GS_INTERMISSION)
+				bot->state = LB_LOADING;
+			else
+				bot->state = LB_PLAYING;
+			bot->statetime = I_GetTime();
+			break;
+
+		case PT_FILEFRAGMENT:
+			bot->gotfragment = true;
+			// The end of the savegame, CL_PrepareDownloadSaveGame uses file 0 for it
+			if (bot->state == LB_LOADING && !pak->u.filetxpak.fileid
+				&& (LONG(pak->u.filetxpak.position) & 0x80000000))
+			{
+				bot->state = LB_PLAYING;
+				bot->statetime = I_GetTime();
+			}
+			break;
+
+		case PT_SERVERTICS:
+			realstart = LoadTest_ExpandTic(bot, pak->u.serverpak.starttic);
+			realend = realstart + pak->u.serverpak.numtics;
+			bot->packetmissed = realstart > bot->neededtic;
+			if (realstart <= bot->neededtic && realend > bot->neededtic)
+				bot->neededtic = realend;
+			break;
+
+		case PT_RESYNCHING:
+			if (!bot->resynching)
+			{
+				bot->resynching = true;
+				bot->resyncs++;
+			}
+			{
+				doomdata_t reply;
+				reply.packettype = PT_RESYNCHGET;
+				reply.u.resynchgot = pak->u.resynchpak.playernum;
+				LoadTest_BotSend(bot, &reply, sizeof (UINT8), false);
+			}
+			break;
+
+		case PT_RESYNCHEND:
+			bot->resynching = false;
+			break;
+
+		case PT_SERVERREFUSE:
+			if (length < MAXPACKETLENGTH)
+				((UINT8 *)pak)[length] = '\0';
+			CONS_Alert(CONS_WARNING, M_GetText("Load test bot on node %d was refused: %s\n"),
+				bot->node, pak->u.serverrefuse.reason);
+			// Don't keep knocking, the server closes the node once this is acknowledged
+			if (bot->state != LB_QUITTING)
+				wantedbots = min(wantedbots, numbots - 1);
+			bot->state = LB_QUITTING;
+			break;
+
+		default:
+			break;
+	}
+}
+
+static void LoadTest_BotTic(loadbot_t *bot)
+{
+	const tic_t now = I_GetTime();
+
+	if (nodeingame[bot->node])
+		bot->ingame = true;
+	else if (bot->ingame && bot->state != LB_QUITTING)
+		bot->state = LB_QUITTING; // Kicked, or timed out
+
+	switch (bot->state)
+	{
+		case LB_JOINING:
+			if (now - bot->statetime >= TICRATE) // PT_SERVERCFG must have got lost
+				LoadTest_SendJoin(bot, false);
+			break;
+
+		case LB_LOADING:
+			if (!bot->gotfragment && !SV_SendingFile(bot->node) && now - bot->statetime >= 3*TICRATE)
+			{
+				// No savegame came after all, the game must have changed state
+				bot->state = LB_PLAYING;
+				bot->statetime = now;
+			}
+			break;
+
+		case LB_PLAYING:
+			LoadTest_SendCmd(bot);
+			break;
+
+		default:
+			break;
+	}
+
+	if (bot->needack || bot->numpending)
+		LoadTest_SendAcks(bot);
+}
+
+static void LoadTest_RemoveBot(INT32 node)
+{
+	INT32 i;
+
+	for (i = 0; i < linkqueued;)
+	{
+		if (linkqueue[i].node == node)
+			LoadTest_Unqueue(i);
+		else
+			i++;
+	}
+
+	bots[node].state = LB_NONE;
+	numbots--;
+}
+
+static void LoadTest_AddBot(void)
+{
+	static INT32 port = 0;
+	loadbot_t *bot;
+	INT32 node;
+
+	// Privileged ports, so no real client comes from the same address
+	port = port % 1023 + 1;
+	node = I_NetMakeNodewPort("127.0.0.1", va("%d", port));
+	if (node <= 0 || node >= MAXNETNODES)
+	{
+		CONS_Alert(CONS_WARNING, M_GetText("Load test: no free node for another bot\n"));
+		wantedbots = numbots;
+		return;
+	}
+
+	// The socket driver takes back nodes that have left the game even
+	// before they are freed, so this may be one a bot was quitting from
+	bot = &bots[node];
+	if (bot->state != LB_NONE)
+		LoadTest_RemoveBot(node);
+	memset(bot, 0, sizeof (*bot));
+	bot->state = LB_JOINING;
+	bot->node = node;
+	bot->seed = (UINT32)cv_loadtest_seed.value * MAXNETNODES + node + 1;
+	numbots++;
+
+	// Straight to the server: the socket driver takes back
+	// nodes that aren't in the game the next time it needs one
+	LoadTest_SendJoin(bot, true);
+}
+
+static void LoadTest_QuitBot(loadbot_t *bot)
+{
+	doomdata_t pak;
+
+	pak.packettype = PT_CLIENTQUIT;
+	LoadTest_BotSend(bot, &pak, 0, true);
+	bot->state = LB_QUITTING;
+}
+
+// -----------------------------------------------------------------
+// Driver
+// -----------------------------------------------------------------
+
+static boolean LoadTest_Get(void)
+{
+	const INT32 i = LoadTest_NextDue(true);
+
+	if (i == -1)
+	{
+		const boolean ret = realget();
+
+		// Same as in LoadTest_AddBot, a real client may get a node a bot was quitting from
+		if (doomcom->remotenode > 0 && doomcom->remotenode < MAXNETNODES
+			&& bots[doomcom->remotenode].state != LB_NONE)
+			LoadTest_RemoveBot(doomcom->remotenode);
+		return ret;
+	}
+
+	M_Memcpy(&doomcom->data, linkqueue[i].pak.raw, linkqueue[i].length);
+	doomcom->remotenode = (INT16)linkqueue[i].node;
+	doomcom->datalength = linkqueue[i].length;
+	netbuffer->checksum = NetbufferChecksum();
+	LoadTest_Unqueue(i);
+	return false;
+}
+
+static void LoadTest_Send(void)
+{
+	const INT32 node = doomcom->remotenode;
+
+	if (node < 0 || node >= MAXNETNODES || bots[node].state == LB_NONE)
+	{
+		realsend();
+		return;
+	}
+
+	bots[node].gotbytes += packetheaderlength + doomcom->datalength;
+	bots[node].gotpackets++;
+	LoadTest_Queue(node, false, &doomcom->data, doomcom->datalength, false);
+}
+
+static void LoadTest_FreeNodenum(INT32 node)
+{
+	if (node >= 0 && node < MAXNETNODES && bots[node].state != LB_NONE)
+		LoadTest_RemoveBot(node);
+	realfreenode(node);
+}
+
+static void LoadTest_ResetStats(void)
+{
+	INT32 i;
+
+	for (i = 0; i < MAXNETNODES; i++)
+	{
+		bots[i].sentbytes = bots[i].gotbytes = 0;
+		bots[i].sentpackets = bots[i].gotpackets = 0;
+		bots[i].lost = bots[i].resyncs = 0;
+	}
+
+	ticcount = 0;
+	tictotal = ticmax = 0;
+	reporttime = I_GetTime();
+}
+
+static void LoadTest_Uninstall(boolean restore)
+{
+	if (restore)
+	{
+		I_NetGet = realget;
+		I_NetSend = realsend;
+		I_NetFreeNodenum = realfreenode;
+		I_NetCloseSocket = realclose;
+	}
+
+	memset(bots, 0, sizeof (bots));
+	numbots = 0;
+	free(linkqueue);
+	linkqueue = NULL;
+	linkqueued = 0;
+	installed = false;
+}
+
+static void LoadTest_CloseSocket(void)
+{
+	LoadTest_Uninstall(true);
+	wantedbots = 0;
+	if (I_NetCloseSocket)
+		I_NetCloseSocket();
+}
+
+static boolean LoadTest_Install(void)
+{
+	linkqueue = malloc(LOADTESTQUEUE * sizeof (*linkqueue));
+	if (!linkqueue)
+	{
+		CONS_Alert(CONS_ERROR, M_GetText("No more free memory for the load test\n"));
+		return false;
+	}
+	linkqueued = 0;
+
+	realget = I_NetGet;
+	realsend = I_NetSend;
+	realfreenode = I_NetFreeNodenum;
+	realclose = I_NetCloseSocket;
+	I_NetGet = LoadTest_Get;
+	I_NetSend = LoadTest_Send;
+	I_NetFreeNodenum = LoadTest_FreeNodenum;
+	I_NetCloseSocket = LoadTest_CloseSocket;
+
+	linkseed = (UINT32)cv_loadtest_seed.value ^ 0x9E3779B9;
+	if (!linkseed)
+		linkseed = 1;
+	memset(bots, 0, sizeof (bots));
+	numbots = 0;
+	installed = true;
+
+	LoadTest_ResetStats();
+	return true;
+}
+
+// -----------------------------------------------------------------
+// Reports and recordings
+// -----------------------------------------------------------------
+
+// Bytes since the last report as KB/s, in tenths
+static UINT32 LoadTest_Rate(UINT32 bytes, tic_t elapsed)
+{
+	return (UINT32)((UINT64)bytes * TICRATE * 10 / 1024 / elapsed);
+}
+
+static void LoadTest_Report(void)
+{
+	const tic_t elapsed = max(I_GetTime() - reporttime, 1);
+	UINT32 sentbytes = 0, gotbytes = 0, lost = 0, resyncs = 0;
+	UINT32 rate;
+	INT32 i;
+
+	CONS_Printf(M_GetText("Load test: %d bots over %d ms latency, %d ms jitter, %d%% loss, for the last %d.%02d seconds\n"),
+		numbots, cv_loadtest_latency.value, cv_loadtest_jitter.value, cv_loadtest_loss.value,
+		elapsed / TICRATE, elapsed % TICRATE * 100 / TICRATE);
+
+	if (ticcount)
+		CONS_Printf(M_GetText("Server tics: %u run, %d us on average, %d us at worst\n"),
+			ticcount, I_PreciseToMicros(tictotal / ticcount), I_PreciseToMicros(ticmax));
+
+	CONS_Printf("Node  State     Down KB/s  Up KB/s  Lost  Resyncs\n");
+	for (i = 0; i < MAXNETNODES; i++)
+	{
+		const loadbot_t *bot = &bots[i];
+
+		if (bot->state == LB_NONE)
+			continue;
+
+		CONS_Printf("%4d  %-8s  ", i, loadbotstatename[bot->state]);
+		rate = LoadTest_Rate(bot->gotbytes, elapsed);
+		CONS_Printf("%7u.%u  ", rate / 10, rate % 10);
+		rate = LoadTest_Rate(bot->sentbytes, elapsed);
+		CONS_Printf("%5u.%u  %4u  %7u\n", rate / 10, rate % 10, bot->lost, bot->resyncs);
+
+		gotbytes += bot->gotbytes;
+		sentbytes += bot->sentbytes;
+		lost += bot->lost;
+		resyncs += bot->resyncs;
+	}
+
+	rate = LoadTest_Rate(gotbytes, elapsed);
+	CONS_Printf("Total           %7u.%u  ", rate / 10, rate % 10);
+	rate = LoadTest_Rate(sentbytes, elapsed);
+	CONS_Printf("%5u.%u  %4u  %7u\n", rate / 10, rate % 10, lost, resyncs);
+
+	LoadTest_ResetStats();
+}
+
+static void LoadTest_LoadReplay(void)
+{
+	UINT8 *buffer;
+	size_t length;
+
+	if (replaycmds)
+		Z_Free(replaycmds);
+	replaycmds = NULL;
+	replaycount = 0;
+
+	if (!cv_loadtest_replay.string[0])
+		return;
+
+	length = FIL_ReadFile(va("%s" PATHSEP "%s", srb2home, cv_loadtest_replay.string), &buffer);
+	if (length < sizeof (ticcmd_t))
+	{
+		if (length)
+			Z_Free(buffer);
+		CONS_Alert(CONS_WARNING, M_GetText("Load test: no ticcmds in %s\n"), cv_loadtest_replay.string);
+		return;
+	}
+
+	replaycmds = (ticcmd_t *)buffer;
+	replaycount = length / sizeof (ticcmd_t);
+}
+
+static void LoadTest_StopRecording(void)
+{
+	fclose(recordfile);
+	recordfile = NULL;
+	CONS_Printf(M_GetText("Stopped recording ticcmds\n"));
+}
+
+// Writes one ticcmd for every tic run, in network byte order
+static void LoadTest_Record(void)
+{
+	ticcmd_t cmd;
+
+	if (gamestate != GS_LEVEL || !playeringame[consoleplayer])
+	{
+		recordtic = gametic;
+		return;
+	}
+
+	// Don't fill a long stall with the same command
+	if (gametic - recordtic > TICRATE)
+		recordtic = gametic - 1;
+
+	for (; recordtic < gametic; recordtic++)
+	{
+		G_MoveTiccmd(&cmd, &players[consoleplayer].cmd, 1);
+		if (fwrite(&cmd, sizeof (cmd), 1, recordfile) != 1)
+		{
+			CONS_Alert(CONS_ERROR, M_GetText("Couldn't write the recorded ticcmds\n"));
+			LoadTest_StopRecording();
+			return;
+		}
+	}
+}
+
+static void Command_LoadTest(void)
+{
+	const char *arg;
+	INT32 count;
+
+	if (COM_Argc() < 2)
+	{
+		CONS_Printf(M_GetText(
+			"loadtest <bots>: have that many simulated clients play on this server\n"
+			"loadtest report: show how the server and the bots have been doing\n"
+			"loadtest record <file>: record your ticcmds for loadtest_script Replay\n"
+			"loadtest record stop: stop recording\n"));
+		if (wantedbots || numbots)
+			CONS_Printf(M_GetText("%d bots, %d wanted\n"), numbots, wantedbots);
+		return;
+	}
+
+	arg = COM_Argv(1);
+
+	if (!stricmp(arg, "report"))
+	{
+		if (installed)
+			LoadTest_Report();
+		else
+			CONS_Printf(M_GetText("No load test is running\n"));
+		return;
+	}
+
+	if (!stricmp(arg, "record"))
+	{
+		if (COM_Argc() < 3)
+			CONS_Printf(M_GetText("loadtest record <file>: record your ticcmds for loadtest_script Replay\n"));
+		else if (!stricmp(COM_Argv(2), "stop"))
+		{
+			if (recordfile)
+				LoadTest_StopRecording();
+		}
+		else
+		{
+			if (recordfile)
+				fclose(recordfile);
+			recordfile = fopen(va("%s" PATHSEP "%s", srb2home, COM_Argv(2)), "wb");
+			if (!recordfile)
+				CONS_Alert(CONS_ERROR, M_GetText("Couldn't open %s for writing\n"), COM_Argv(2));
+			else
+			{
+				recordtic = gametic;
+				CONS_Printf(M_GetText("Recording ticcmds to %s\n"), COM_Argv(2));
+			}
+		}
+		return;
+	}
+
+	if (netgame && !server)
+	{
+		CONS_Printf(M_GetText("Only the server can run a load test\n"));
+		return;
+	}
+
+	if (!stricmp(arg, "stop"))
+		count = 0;
+	else
+	{
+		count = atoi(arg);
+		if ((count <= 0 && arg[0] != '0') || count >= MAXNETNODES)
+		{
+			CONS_Printf(M_GetText("The number of bots must be between 0 and %d\n"), MAXNETNODES-1);
+			return;
+		}
+	}
+
+	wantedbots = count;
+}
+
+// -----------------------------------------------------------------
+// Public
+// -----------------------------------------------------------------
+
+void LoadTest_Init(void)
+{
+	COM_AddCommand("loadtest", Command_LoadTest);
+	CV_RegisterVar(&cv_loadtest_latency);
+	CV_RegisterVar(&cv_loadtest_jitter);
+	CV_RegisterVar(&cv_loadtest_loss);
+	CV_RegisterVar(&cv_loadtest_desync);
+	CV_RegisterVar(&cv_loadtest_script);
+	CV_RegisterVar(&cv_loadtest_replay);
+	CV_RegisterVar(&cv_loadtest_report);
+	CV_RegisterVar(&cv_loadtest_seed);
+
+	// Bots join as soon as the server is up
+	if (M_CheckParm("-loadtest") && M_IsNextParm())
+		wantedbots = min(max(atoi(M_GetNextParm()), 0), MAXNETNODES-1);
+}
+
+/** Runs the bots, once per NetUpdate: delivers what the server sent them,
+  * has them send their ticcmds every tic, and adds or takes them out
+  * until there are as many as asked for.
+  */
+void LoadTest_Ticker(void)
+{
+	static tic_t lasttime = 0;
+	const tic_t now = I_GetTime();
+	INT32 i, active;
+
+	if (recordfile)
+		LoadTest_Record();
+
+	// Something put a new driver in, the old nodes are gone with it
+	if (installed && I_NetGet != LoadTest_Get)
+		LoadTest_Uninstall(false);
+
+	if (!installed)
+	{
+		if (!wantedbots || !server || !netgame || !I_NetMakeNodewPort || !Playing())
+			return;
+		if (!LoadTest_Install())
+		{
+			wantedbots = 0;
+			return;
+		}
+	}
+
+	// Hand the bots what the server sent them, once it's been on the link long enough
+	while ((i = LoadTest_NextDue(false)) != -1)
+	{
+		static loadpacket_t p;
+
+		M_Memcpy(&p, &linkqueue[i], sizeof (p));
+		LoadTest_Unqueue(i);
+		if (bots[p.node].state != LB_NONE)
+			LoadTest_BotReceive(&bots[p.node], &p.pak.data, p.length);
+	}
+
+	if (now != lasttime)
+	{
+		lasttime = now;
+		for (i = 1; i < MAXNETNODES; i++)
+			if (bots[i].state != LB_NONE)
+				LoadTest_BotTic(&bots[i]);
+
+		if (cv_loadtest_report.value && now - reporttime >= (tic_t)cv_loadtest_report.value * TICRATE)
+			LoadTest_Report();
+	}
+
+	for (i = 1, active = 0; i < MAXNETNODES; i++)
+		if (bots[i].state != LB_NONE && bots[i].state != LB_QUITTING)
+			active++;
+
+	if (active < wantedbots)
+	{
+		// One at a time, as a node goes back to the socket driver until it's in the game
+		for (i = 1; i < MAXNETNODES; i++)
+			if (bots[i].state == LB_JOINING && !nodeingame[i])
+				break;
+		if (i == MAXNETNODES)
+			LoadTest_AddBot();
+	}
+	else if (active > wantedbots)
+	{
+		for (i = MAXNETNODES-1; i > 0 && active > wantedbots; i--)
+			if (bots[i].state != LB_NONE && bots[i].state != LB_QUITTING)
+			{
+				LoadTest_QuitBot(&bots[i]);
+				active--;
+			}
+	}
+	else if (!numbots && !wantedbots)
+		LoadTest_Uninstall(true);
+}
+
+/** Adds up the time the server took to run a tic, for the reports
+  *
+  * \param time How long the tic took, as measured for ps_tictime
+  *
+  */
+void LoadTest_CountTic(precise_t time)
+{
+	if (!installed)
+		return;
+
+	ticcount++;
+	tictotal += time;
+	if (time > ticmax)
+		ticmax = time;
+}
+#endif
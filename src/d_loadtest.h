@@ -0,0 +1,27 @@
+// SONIC ROBO BLAST 2
+//-----------------------------------------------------------------------------
+// Copyright (C) 2020-2023 by Sonic Team Junior.
+//
+// This program is free software distributed under the
+// terms of the GNU General Public License, version 2.
+// See the 'LICENSE' file for more details.
+//-----------------------------------------------------------------------------
+/// \file  d_loadtest.h
+/// \brief Simulated clients for load testing a server
+///
+///        Bots join the server as nodes of their own, over a fake link
+///        with configurable latency, jitter and loss, and play scripted
+///        or recorded ticcmds. See the loadtest console command.
+
+#ifndef __D_LOADTEST__
+#define __D_LOADTEST__
+
+#include "i_system.h" // precise_t
+
+#ifndef NONET
+void LoadTest_Init(void);
+void LoadTest_Ticker(void);
+void LoadTest_CountTic(precise_t time);
+#endif
+
+#endif
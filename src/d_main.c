@@ -261,6 +261,8 @@ static boolean D_Display(void)
 	if (rendermode == render_soft && !splitscreen)
 		R_CheckViewMorph();
 
+	R_CheckDynamicResolution();
+
 	// change the view size if needed
 	if (setsizeneeded)
 	{
@@ -395,14 +397,14 @@ static boolean D_Display(void)
 				if (rendermode != render_none)
 				{
 					viewwindowy = vid.height / 2;
-					M_Memcpy(ylookup, ylookup2, viewheight*sizeof (ylookup[0]));
+					M_Memcpy(ylookup, ylookup2, scaledviewheight*sizeof (ylookup[0]));
 
 					topleft = screens[0] + viewwindowy*vid.width + viewwindowx;
 
 					R_RenderPlayerView(&players[secondarydisplayplayer]);
 
 					viewwindowy = 0;
-					M_Memcpy(ylookup, ylookup1, viewheight*sizeof (ylookup[0]));
+					M_Memcpy(ylookup, ylookup1, scaledviewheight*sizeof (ylookup[0]));
 				}
 			}
 
@@ -420,6 +422,7 @@ static boolean D_Display(void)
 			R_RestoreLevelInterpolators();
 
 			PS_STOP_TIMING(ps_rendercalltime);
+			R_UpdateDynamicResolution(ps_rendercalltime.value.p);
 		}
 
 		if (lastdraw)
@@ -689,6 +692,10 @@ void D_SRB2Loop(void)
 			renderisnewtic = false;
 		}
 
+		// With vid_pipeline, the last frame was being converted for
+		// display while the tics above ran. Put it on screen now.
+		I_PresentFrame();
+
 		if (interp)
 		{
 			renderdeltatics = FLOAT_TO_FIXED(deltatics);
@@ -69,6 +69,7 @@ INT16 hardware_MAXPACKETLENGTH;
 boolean (*I_NetGet)(void) = NULL;
 void (*I_NetSend)(void) = NULL;
 boolean (*I_NetCanSend)(void) = NULL;
+void (*I_NetFlush)(void) = NULL;
 boolean (*I_NetCanGet)(void) = NULL;
 void (*I_NetCloseSocket)(void) = NULL;
 void (*I_NetFreeNodenum)(INT32 nodenum) = NULL;
@@ -130,11 +131,166 @@ boolean Net_GetNetStat(void)
 	return 0;
 }
 
+/// \warning Keep this up-to-date if you add/remove/rename packet types
+static const char *packettypename[NUMPACKETTYPE] =
+{
+	"NOTHING",
+	"SERVERCFG",
+	"CLIENTCMD",
+	"CLIENTMIS",
+	"CLIENT2CMD",
+	"CLIENT2MIS",
+	"NODEKEEPALIVE",
+	"NODEKEEPALIVEMIS",
+	"SERVERTICS",
+	"SERVERREFUSE",
+	"SERVERSHUTDOWN",
+	"CLIENTQUIT",
+
+	"ASKINFO",
+	"SERVERINFO",
+	"PLAYERINFO",
+	"REQUESTFILE",
+	"ASKINFOVIAMS",
+
+	"RESYNCHEND",
+	"RESYNCHGET",
+
+	"FILEFRAGMENT",
+	"TEXTCMD",
+	"TEXTCMD2",
+	"CLIENTJOIN",
+	"NODETIMEOUT",
+	"RESYNCHING",
+	"LOGIN",
+#ifdef NEWPING
+	"PING",
+#endif
+
+	"CLIENTDELTA",
+	"CLIENTDELTAMIS",
+	"CLIENT2DELTA",
+	"CLIENT2DELTAMIS",
+};
+
+// Traffic with a node, for the packetstats command
+typedef struct
+{
+	netpacketstat_t types[NUMPACKETTYPE];
+	UINT32 acklatency[NUMACKLATENCIES]; // Acks returned in under 25 << i ms, the last for any slower
+	UINT32 senttextcmds, senttextcmdbytes;
+	UINT32 gottextcmds, gottextcmdbytes;
+	UINT8 maxtextcmd;
+} nodestat_t;
+
+static nodestat_t nodestats[MAXNETNODES];
+static netpacketstat_t totalstats[NUMPACKETTYPE]; // Every node, since startup
+static netpacketstat_t basestats[NUMPACKETTYPE]; // totalstats at the last packetstats reset
+
+// Sampled to a file by packetstats log
+static FILE *packetstatfile = NULL;
+static tic_t packetstatlogtime;
+static netpacketstat_t loggedstats[MAXNETNODES][NUMPACKETTYPE];
+
+/** Gets the traffic with all nodes since startup, for each packet type
+  *
+  * \return NUMPACKETTYPE entries, indexed by packet type
+  *
+  */
+const netpacketstat_t *Net_GetPacketTotals(void)
+{
+	return totalstats;
+}
+
+static void Net_StopPacketLog(void)
+{
+	fclose(packetstatfile);
+	packetstatfile = NULL;
+}
+
+#ifndef NONET
+// Counts the packet in netbuffer, sent to or received from node
+static void Net_CountPacket(INT32 node, boolean sent)
+{
+	const UINT8 type = netbuffer->packettype;
+	const UINT32 bytes = packetheaderlength + doomcom->datalength;
+
+	if (node < 0 || node >= MAXNETNODES || type >= NUMPACKETTYPE)
+		return;
+
+	if (sent)
+	{
+		nodestats[node].types[type].sentpackets++;
+		nodestats[node].types[type].sentbytes += bytes;
+		totalstats[type].sentpackets++;
+		totalstats[type].sentbytes += bytes;
+	}
+	else
+	{
+		nodestats[node].types[type].gotpackets++;
+		nodestats[node].types[type].gotbytes += bytes;
+		totalstats[type].gotpackets++;
+		totalstats[type].gotbytes += bytes;
+	}
+}
+
+// Counts the size of the textcmd in netbuffer, not counting resends
+static void Net_CountTextcmd(INT32 node, boolean sent)
+{
+	nodestat_t *stat;
+
+	if (node < 0 || node >= MAXNETNODES
+		|| (netbuffer->packettype != PT_TEXTCMD && netbuffer->packettype != PT_TEXTCMD2))
+		return;
+
+	stat = &nodestats[node];
+	if (sent)
+	{
+		stat->senttextcmds++;
+		stat->senttextcmdbytes += netbuffer->u.textcmd[0];
+	}
+	else
+	{
+		stat->gottextcmds++;
+		stat->gottextcmdbytes += netbuffer->u.textcmd[0];
+	}
+	if (netbuffer->u.textcmd[0] > stat->maxtextcmd)
+		stat->maxtextcmd = netbuffer->u.textcmd[0];
+}
+
+// Writes what changed in the traffic with a node since the last sample
+static void Net_LogNodeStats(INT32 node, tic_t time)
+{
+	INT32 i;
+
+	for (i = 0; i < NUMPACKETTYPE && packetstatfile; i++)
+	{
+		const netpacketstat_t *stat = &nodestats[node].types[i];
+		netpacketstat_t *logged = &loggedstats[node][i];
+
+		if (stat->sentpackets == logged->sentpackets && stat->gotpackets == logged->gotpackets
+			&& stat->resent == logged->resent)
+			continue;
+
+		if (fprintf(packetstatfile, "%u,%d,%s,%u,%u,%u,%u,%u\n", time, node, packettypename[i],
+			stat->sentpackets - logged->sentpackets, stat->sentbytes - logged->sentbytes,
+			stat->gotpackets - logged->gotpackets, stat->gotbytes - logged->gotbytes,
+			stat->resent - logged->resent) < 0)
+		{
+			CONS_Alert(CONS_ERROR, M_GetText("Couldn't write the packet stats\n"));
+			Net_StopPacketLog();
+			return;
+		}
+
+		M_Memcpy(logged, stat, sizeof (*logged));
+	}
+}
+#endif
+
 // -----------------------------------------------------------------
 // Some structs and functions for acknowledgement of packets
 // -----------------------------------------------------------------
 #define MAXACKPACKETS 96 // Minimum number of nodes (wat)
-#define MAXACKTOSEND 96
 #define URGENTFREESLOTNUM 10
 #define ACKTOSENDTIMEOUT (TICRATE/11)
 
@@ -147,6 +303,7 @@ typedef struct
 	tic_t senttime; // The time when the ack was sent
 	UINT16 length; // The packet size
 	UINT16 resentnum; // The number of times the ack has been resent
+	precise_t firstsent; // For the ack latency stats
 	union {
 		SINT8 raw[MAXPACKETLENGTH];
 		doomdata_t data;
@@ -186,6 +343,9 @@ typedef struct
 	UINT8 nextacknum;
 
 	UINT8 flags;
+
+	// packets resent since Net_GetResentPackets last asked, for flow control
+	UINT16 resent;
 #ifndef NEWPING
 	// jacobson tcp timeout evaluation algorithm (Karn variation)
 	fixed_t ping;
@@ -263,6 +423,7 @@ static boolean GetFreeAcknum(UINT8 *freeack, boolean lowtimer)
 				ackpak[i].senttime = I_GetTime();
 				ackpak[i].resentnum = 0;
 			}
+			ackpak[i].firstsent = I_GetPreciseTime();
 			M_Memcpy(ackpak[i].pak.raw, netbuffer, ackpak[i].length);
 
 			*freeack = ackpak[i].acknum;
@@ -311,6 +472,25 @@ INT32 Net_GetFreeAcks(boolean urgent)
 	return n;
 }
 
+/** Counts the packets that had to be resent to a node,
+  * since the last time this was called for it
+  *
+  * \param node The node
+  * \return The number of resent packets
+  *
+  */
+INT32 Net_GetResentPackets(INT32 node)
+{
+#ifndef NONET
+	INT32 resent = nodes[node].resent;
+	nodes[node].resent = 0;
+	return resent;
+#else
+	(void)node;
+	return 0;
+#endif
+}
+
 // Get a ack to send in the queue of this node
 static UINT8 GetAcktosend(INT32 node)
 {
@@ -321,6 +501,13 @@ static UINT8 GetAcktosend(INT32 node)
 static void RemoveAck(INT32 i)
 {
 	INT32 node = ackpak[i].destinationnode;
+	const UINT32 latency = I_PreciseToMicros(I_GetPreciseTime() - ackpak[i].firstsent) / 1000;
+	INT32 bucket = 0;
+
+	while (bucket < NUMACKLATENCIES-1 && latency >= (25u << bucket))
+		bucket++;
+	nodestats[node].acklatency[bucket]++;
+
 #ifndef NEWPING
 	fixed_t trueping = (I_GetTime() - ackpak[i].senttime)<<FRACBITS;
 	if (ackpak[i].resentnum)
@@ -546,12 +733,28 @@ void Net_AckTicker(void)
 			ackpak[i].senttime = I_GetTime();
 			ackpak[i].resentnum++;
 			ackpak[i].nextacknum = node->nextacknum;
+			if (node->resent < UINT16_MAX)
+				node->resent++;
 			retransmit++; // For stat
+			if (ackpak[i].pak.data.packettype < NUMPACKETTYPE)
+			{
+				nodestats[nodei].types[ackpak[i].pak.data.packettype].resent++;
+				totalstats[ackpak[i].pak.data.packettype].resent++;
+			}
 			HSendPacket((INT32)(node - nodes), false, ackpak[i].acknum,
 				(size_t)(ackpak[i].length - BASEPACKETSIZE));
 		}
 	}
 
+	if (packetstatfile && I_GetTime() - packetstatlogtime >= TICRATE)
+	{
+		packetstatlogtime = I_GetTime();
+		for (i = 0; i < MAXNETNODES; i++)
+			Net_LogNodeStats(i, packetstatlogtime);
+		if (packetstatfile)
+			fflush(packetstatfile); // So it can be read while it's written
+	}
+
 	for (i = 1; i < MAXNETNODES; i++)
 	{
 		// This is something like node open flag
@@ -671,6 +874,7 @@ static void InitNode(node_t *node)
 	node->nextacknum = 1;
 	node->remotefirstack = 0;
 	node->flags = 0;
+	node->resent = 0;
 }
 
 static void InitAck(void)
@@ -758,6 +962,12 @@ void Net_CloseConnection(INT32 node)
 	InitNode(&nodes[node]);
 	SV_AbortSendFiles(node);
 	I_NetFreeNodenum(node);
+
+	// The next one to get this node starts counting from zero
+	if (packetstatfile)
+		Net_LogNodeStats(node, I_GetTime());
+	memset(&nodestats[node], 0, sizeof (nodestats[node]));
+	memset(loggedstats[node], 0, sizeof (loggedstats[node]));
 #endif
 }
 
@@ -765,7 +975,7 @@ void Net_CloseConnection(INT32 node)
 //
 // Checksum
 //
-static UINT32 NetbufferChecksum(void)
+UINT32 NetbufferChecksum(void)
 {
 	UINT32 c = 0x1234567;
 	const INT32 l = doomcom->datalength - 4;
@@ -816,42 +1026,6 @@ static void fprintfstringnewline(char *s, size_t len)
 	fprintf(debugfile, "\n");
 }
 
-/// \warning Keep this up-to-date if you add/remove/rename packet types
-static const char *packettypename[NUMPACKETTYPE] =
-{
-	"NOTHING",
-	"SERVERCFG",
-	"CLIENTCMD",
-	"CLIENTMIS",
-	"CLIENT2CMD",
-	"CLIENT2MIS",
-	"NODEKEEPALIVE",
-	"NODEKEEPALIVEMIS",
-	"SERVERTICS",
-	"SERVERREFUSE",
-	"SERVERSHUTDOWN",
-	"CLIENTQUIT",
-
-	"ASKINFO",
-	"SERVERINFO",
-	"PLAYERINFO",
-	"REQUESTFILE",
-	"ASKINFOVIAMS",
-
-	"RESYNCHEND",
-	"RESYNCHGET",
-
-	"FILEFRAGMENT",
-	"TEXTCMD",
-	"TEXTCMD2",
-	"CLIENTJOIN",
-	"NODETIMEOUT",
-	"RESYNCHING",
-#ifdef NEWPING
-	"PING"
-#endif
-};
-
 static void DebugPrintpacket(const char *header)
 {
 	fprintf(debugfile, "%-12s (node %d,ack %d,ackret %d,size %d) type(%d) : %s\n",
@@ -871,11 +1045,20 @@ static void DebugPrintpacket(const char *header)
 		case PT_SERVERTICS:
 		{
 			servertics_pak *serverpak = &netbuffer->u.serverpak;
-			UINT8 *cmd = (UINT8 *)(&serverpak->cmds[serverpak->numslots * serverpak->numtics]);
+			const INT32 numslots = serverpak->numslots & SERVERTICS_SLOTS;
+			UINT8 *cmd = (UINT8 *)(&serverpak->cmds[numslots * serverpak->numtics]);
 			size_t ntxtcmd = &((UINT8 *)netbuffer)[doomcom->datalength] - cmd;
 
+			if (serverpak->numslots & SERVERTICS_DELTA)
+			{
+				// The textcmds start after cmds of varying size
+				fprintf(debugfile, "    firsttic %u ply %d tics %d delta\n",
+					(UINT32)ExpandTics(serverpak->starttic), numslots, serverpak->numtics);
+				break;
+			}
+
 			fprintf(debugfile, "    firsttic %u ply %d tics %d ntxtcmd %s\n    ",
-				(UINT32)ExpandTics(serverpak->starttic), serverpak->numslots, serverpak->numtics, sizeu1(ntxtcmd));
+				(UINT32)ExpandTics(serverpak->starttic), numslots, serverpak->numtics, sizeu1(ntxtcmd));
 			/// \todo Display more readable information about net commands
 			fprintfstringnewline((char *)cmd, ntxtcmd);
 			/*fprintfstring((char *)cmd, 3);
@@ -893,6 +1076,10 @@ static void DebugPrintpacket(const char *header)
 		case PT_CLIENT2MIS:
 		case PT_NODEKEEPALIVE:
 		case PT_NODEKEEPALIVEMIS:
+		case PT_CLIENTDELTA:
+		case PT_CLIENTDELTAMIS:
+		case PT_CLIENT2DELTA:
+		case PT_CLIENT2DELTAMIS:
 			fprintf(debugfile, "    tic %4u resendfrom %u\n",
 				(UINT32)ExpandTics(netbuffer->u.clientpak.client_tic),
 				(UINT32)ExpandTics (netbuffer->u.clientpak.resendfrom));
@@ -1020,6 +1207,135 @@ static boolean ShouldDropPacket(void)
 #endif
 #endif
 
+// Kilobytes in tenths, for printing
+#define KB10(bytes) ((UINT32)((UINT64)(bytes) * 10 / 1024))
+
+static void Net_PrintPacketStats(const netpacketstat_t *types, const netpacketstat_t *base)
+{
+	INT32 i;
+
+	CONS_Printf("Packet type         Sent  Sent KB      Got   Got KB  Resent\n");
+	for (i = 0; i < NUMPACKETTYPE; i++)
+	{
+		const UINT32 sentpackets = types[i].sentpackets - (base ? base[i].sentpackets : 0);
+		const UINT32 sentbytes = types[i].sentbytes - (base ? base[i].sentbytes : 0);
+		const UINT32 gotpackets = types[i].gotpackets - (base ? base[i].gotpackets : 0);
+		const UINT32 gotbytes = types[i].gotbytes - (base ? base[i].gotbytes : 0);
+		const UINT32 resent = types[i].resent - (base ? base[i].resent : 0);
+
+		if (!sentpackets && !gotpackets)
+			continue;
+
+		CONS_Printf("%-16s %7u %6u.%u %8u %6u.%u %7u\n", packettypename[i],
+			sentpackets, KB10(sentbytes) / 10, KB10(sentbytes) % 10,
+			gotpackets, KB10(gotbytes) / 10, KB10(gotbytes) % 10, resent);
+	}
+}
+
+static void Net_PrintNodeStats(INT32 node)
+{
+	const nodestat_t *stat = &nodestats[node];
+	UINT32 sentbytes = 0, gotbytes = 0, resent = 0;
+	INT32 i;
+
+	for (i = 0; i < NUMPACKETTYPE; i++)
+	{
+		sentbytes += stat->types[i].sentbytes;
+		gotbytes += stat->types[i].gotbytes;
+		resent += stat->types[i].resent;
+	}
+
+	CONS_Printf(M_GetText("Node %d"), node);
+	if (nodetoplayer[node] >= 0)
+		CONS_Printf(" (%s)", player_names[(UINT8)nodetoplayer[node]]);
+	CONS_Printf(M_GetText(": %u.%u KB sent, %u.%u KB received, %u packets resent\n"),
+		KB10(sentbytes) / 10, KB10(sentbytes) % 10, KB10(gotbytes) / 10, KB10(gotbytes) % 10, resent);
+
+	if (stat->senttextcmds || stat->gottextcmds)
+		CONS_Printf(M_GetText("  Textcmds: %u sent, %u received, %u bytes on average, %u at most\n"),
+			stat->senttextcmds, stat->gottextcmds,
+			(stat->senttextcmdbytes + stat->gottextcmdbytes) / (stat->senttextcmds + stat->gottextcmds),
+			stat->maxtextcmd);
+
+	CONS_Printf(M_GetText("  Acks returned in:"));
+	for (i = 0; i < NUMACKLATENCIES-1; i++)
+		CONS_Printf(" <%ums %u,", 25u << i, stat->acklatency[i]);
+	CONS_Printf(M_GetText(" slower %u\n"), stat->acklatency[NUMACKLATENCIES-1]);
+}
+
+/** Shows the traffic for each packet type, and how it went with each node.
+  * Works on a dedicated server too, and can sample it to a file every second.
+  */
+void Command_PacketStats(void)
+{
+	INT32 node, i;
+
+	if (COM_Argc() >= 2 && !stricmp(COM_Argv(1), "reset"))
+	{
+		M_Memcpy(basestats, totalstats, sizeof (basestats));
+		memset(nodestats, 0, sizeof (nodestats));
+		memset(loggedstats, 0, sizeof (loggedstats));
+		return;
+	}
+
+	if (COM_Argc() >= 2 && !stricmp(COM_Argv(1), "log"))
+	{
+		if (COM_Argc() < 3)
+		{
+			CONS_Printf(M_GetText("packetstats log <file>: write the traffic with each node to a file every second\n"));
+			return;
+		}
+
+		if (packetstatfile)
+			Net_StopPacketLog();
+		if (!stricmp(COM_Argv(2), "stop"))
+			return;
+
+		packetstatfile = fopen(va("%s" PATHSEP "%s", srb2home, COM_Argv(2)), "w");
+		if (!packetstatfile)
+		{
+			CONS_Alert(CONS_ERROR, M_GetText("Couldn't open %s for writing\n"), COM_Argv(2));
+			return;
+		}
+
+		// Time is in tics
+		fprintf(packetstatfile, "time,node,type,sentpackets,sentbytes,gotpackets,gotbytes,resent\n");
+		M_Memcpy(loggedstats, nodestats, sizeof (loggedstats));
+		packetstatlogtime = I_GetTime();
+		CONS_Printf(M_GetText("Writing the packet stats to %s\n"), COM_Argv(2));
+		return;
+	}
+
+	if (COM_Argc() >= 2)
+	{
+		node = atoi(COM_Argv(1));
+		if (node < 0 || node >= MAXNETNODES || (!node && COM_Argv(1)[0] != '0'))
+		{
+			CONS_Printf(M_GetText(
+				"packetstats [node]: show the traffic for each packet type, with all nodes or with one\n"
+				"packetstats reset: start counting again\n"
+				"packetstats log <file>: write the traffic with each node to a file every second\n"
+				"packetstats log stop: stop writing it\n"));
+			return;
+		}
+
+		Net_PrintPacketStats(nodestats[node].types, NULL);
+		Net_PrintNodeStats(node);
+		return;
+	}
+
+	Net_PrintPacketStats(totalstats, basestats);
+	for (node = 0; node < MAXNETNODES; node++)
+		for (i = 0; i < NUMPACKETTYPE; i++)
+			if (nodestats[node].types[i].sentpackets || nodestats[node].types[i].gotpackets)
+			{
+				Net_PrintNodeStats(node);
+				break;
+			}
+}
+
+#undef KB10
+
 //
 // HSendPacket
 //
@@ -1093,6 +1409,9 @@ boolean HSendPacket(INT32 node, boolean reliable, UINT8 acknum, size_t packetlen
 
 	netbuffer->checksum = NetbufferChecksum();
 	sendbytes += packetheaderlength + doomcom->datalength; // For stat
+	Net_CountPacket(node, true);
+	if (reliable)
+		Net_CountTextcmd(node, true);
 
 #ifdef PACKETDROP
 	// Simulate internet :)
@@ -1181,6 +1500,8 @@ boolean HGetPacket(void)
 			continue;
 		}
 
+		Net_CountPacket(doomcom->remotenode, false);
+
 #ifdef DEBUGFILE
 		if (debugfile)
 			DebugPrintpacket("GET");
@@ -1205,6 +1526,8 @@ boolean HGetPacket(void)
 		if (!Processackpak())
 			continue; // discarded (duplicated)
 
+		Net_CountTextcmd(doomcom->remotenode, false);
+
 		// A packet with just ackreturn
 		if (netbuffer->packettype == PT_NOTHING)
 		{
@@ -1292,6 +1615,7 @@ boolean D_CheckNetGame(void)
 	I_NetGet = Internal_Get;
 	I_NetSend = Internal_Send;
 	I_NetCanSend = NULL;
+	I_NetFlush = NULL;
 	I_NetCloseSocket = NULL;
 	I_NetFreeNodenum = Internal_FreeNodenum;
 	I_NetMakeNodewPort = NULL;
@@ -1447,6 +1771,7 @@ void D_CloseConnection(void)
 		I_NetGet = Internal_Get;
 		I_NetSend = Internal_Send;
 		I_NetCanSend = NULL;
+		I_NetFlush = NULL;
 		I_NetCloseSocket = NULL;
 		I_NetFreeNodenum = Internal_FreeNodenum;
 		I_NetMakeNodewPort = NULL;
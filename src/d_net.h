@@ -26,12 +26,26 @@
 
 #define STATLENGTH (TICRATE*2)
 
+#define MAXACKTOSEND 96 // Acks a PT_NOTHING packet can carry
+
 // stat of net
 extern INT32 ticruned, ticmiss;
 extern INT32 getbps, sendbps;
 extern float lostpercent, duppercent, gamelostpercent;
 extern INT32 packetheaderlength;
 boolean Net_GetNetStat(void);
+
+// Traffic for one packet type
+typedef struct
+{
+	UINT32 sentpackets, sentbytes;
+	UINT32 gotpackets, gotbytes;
+	UINT32 resent; // Reliable packets sent again, counted in sentpackets too
+} netpacketstat_t;
+
+#define NUMACKLATENCIES 8 // Buckets in the ack latency histogram of each node
+
+const netpacketstat_t *Net_GetPacketTotals(void);
 extern INT32 getbytes;
 extern INT64 sendbytes; // Realtime updated
 
@@ -41,6 +55,7 @@ extern UINT8 playerpernode[MAXNETNODES]; // Used specially for splitscreen
 extern boolean nodeingame[MAXNETNODES]; // Set false as nodes leave game
 
 INT32 Net_GetFreeAcks(boolean urgent);
+INT32 Net_GetResentPackets(INT32 node);
 void Net_AckTicker(void);
 
 // If reliable return true if packet sent, 0 else
@@ -50,6 +65,7 @@ boolean HGetPacket(void);
 void D_SetDoomcom(void);
 #ifndef NONET
 void D_SaveBan(void);
+UINT32 NetbufferChecksum(void);
 #endif
 boolean D_CheckNetGame(void);
 void D_CloseConnection(void);
@@ -63,8 +63,12 @@
 
 #include <errno.h>
 
+#ifdef HAVE_CURL
+#include <curl/curl.h>
+#endif
+
 // Prototypes
-static boolean SV_SendFile(INT32 node, const char *filename, UINT8 fileid);
+static boolean SV_SendFile(INT32 node, const char *filename, UINT8 fileid, UINT32 position);
 
 // Sender structure
 typedef struct filetx_s
@@ -75,6 +79,8 @@ typedef struct filetx_s
 		char *ram; // Pointer to the data in RAM
 	} id;
 	UINT32 size; // Size of the file
+	UINT32 position; // The current position in the file
+	FILE *currentfile; // The file currently being sent
 	UINT8 fileid;
 	INT32 node; // Destination
 	struct filetx_s *next; // Next file in the list
@@ -84,11 +90,25 @@ typedef struct filetx_s
 typedef struct filetran_s
 {
 	filetx_t *txlist; // Linked list of all files for the node
-	UINT32 position; // The current position in the file
-	FILE *currentfile; // The file currently being sent/received
+	filetx_t *nextfile; // Which of the first FILETXCONCURRENT files in txlist sends next
+	INT32 window; // How many fragments the node gets per tic
 } filetran_t;
 static filetran_t transfer[MAXNETNODES];
 
+#define FILETXCONCURRENT 4 // Files sent to a node at the same time
+#define FILETXWINDOW 4 // Fragments per tic a node starts with
+
+// Receiver side fragments that arrived ahead of the ones before them,
+// held until those come so downloaded files are always written in order
+typedef struct fileheld_s
+{
+	UINT32 position;
+	UINT16 size;
+	UINT8 *data; // Allocated along with it
+	struct fileheld_s *next;
+} fileheld_t;
+static fileheld_t *heldfragments[MAX_WADFILES];
+
 // Read time of file: stat _stmtime
 // Write time of file: utime
 
@@ -96,6 +116,7 @@ static filetran_t transfer[MAXNETNODES];
 INT32 fileneedednum; // Number of files needed to join the server
 fileneeded_t fileneeded[MAX_WADFILES]; // List of needed files
 char downloaddir[512] = "DOWNLOAD";
+char http_source[MAX_MIRROR_LENGTH]; // The server's HTTP mirror, if it has one
 
 #ifdef CLIENT_LOADINGSCREEN
 // for cl loading screen
@@ -141,6 +162,12 @@ UINT8 *PutFileNeeded(void)
 	}
 	netbuffer->u.serverinfo.fileneedednum = (UINT8)count;
 
+	// Then the HTTP mirror the files can be downloaded from, if there's room.
+	// Older clients stop reading at the end of the list and never see it
+	if (cv_httpsource.string[0] && strlen(cv_httpsource.string) < MAX_MIRROR_LENGTH
+		&& p + strlen(cv_httpsource.string) < netbuffer->u.serverinfo.fileneeded + MAXFILENEEDED)
+		WRITESTRINGN(p, cv_httpsource.string, MAX_MIRROR_LENGTH);
+
 	return p;
 }
 
@@ -165,9 +192,17 @@ void D_ParseFileneeded(INT32 fileneedednum_parm, UINT8 *fileneededstr)
 		fileneeded[i].willsend = (UINT8)(filestatus >> 4);
 		fileneeded[i].totalsize = READUINT32(p); // The four next bytes are the file size
 		fileneeded[i].file = NULL; // The file isn't open yet
+		fileneeded[i].partial = false;
 		READSTRINGN(p, fileneeded[i].filename, MAX_WADPATH); // The next bytes are the file name
 		READMEM(p, fileneeded[i].md5sum, 16); // The last 16 bytes are the file checksum
 	}
+
+	// The HTTP mirror follows the list (HandleServerInfo zeroes the
+	// rest of the buffer, so servers without one leave this empty)
+	for (i = 0; i < MAX_MIRROR_LENGTH-1 && p < fileneededstr + MAXFILENEEDED; i++)
+		if ((http_source[i] = READCHAR(p)) == '\0')
+			break;
+	http_source[i] = '\0';
 }
 
 void CL_PrepareDownloadSaveGame(const char *tmpsave)
@@ -176,10 +211,44 @@ void CL_PrepareDownloadSaveGame(const char *tmpsave)
 	fileneeded[0].status = FS_REQUESTED;
 	fileneeded[0].totalsize = UINT32_MAX;
 	fileneeded[0].file = NULL;
+	fileneeded[0].partial = false;
 	memset(fileneeded[0].md5sum, 0, 16);
 	strcpy(fileneeded[0].filename, tmpsave);
 }
 
+#define PARTFILENAMELEN (MAX_WADPATH+5)
+
+// Where a file is downloaded to until it's complete and its MD5 checks out
+static char *PartFileName(const fileneeded_t *file, char *partname)
+{
+	snprintf(partname, PARTFILENAMELEN, "%s.part", file->filename);
+	return partname;
+}
+
+// How much of a file an earlier, interrupted download got
+static UINT32 PartFileSize(const fileneeded_t *file)
+{
+	char partname[PARTFILENAMELEN];
+	FILE *f = fopen(PartFileName(file, partname), "rb");
+	long size;
+
+	if (!f)
+		return 0;
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fclose(f);
+
+	// Somehow bigger than the file is supposed to be? Start over
+	if (size < 0 || (UINT32)size >= file->totalsize)
+	{
+		remove(partname);
+		return 0;
+	}
+
+	return (UINT32)size;
+}
+
 /** Checks the server to see if we CAN download all the files,
   * before starting to create them and requesting.
   *
@@ -257,6 +326,8 @@ boolean CL_SendRequestFile(void)
 {
 	char *p;
 	INT32 i;
+	UINT8 requested[MAX_WADFILES];
+	INT32 numrequested = 0;
 	INT64 totalfreespaceneeded = 0, availablefreespace;
 
 #ifdef PARANOIA
@@ -282,9 +353,17 @@ boolean CL_SendRequestFile(void)
 			WRITESTRINGN(p, fileneeded[i].filename, MAX_WADPATH);
 			// put it in download dir
 			strcatbf(fileneeded[i].filename, downloaddir, "/");
+			// and pick up where the last download of it stopped
+			fileneeded[i].partial = true;
+			fileneeded[i].currentsize = PartFileSize(&fileneeded[i]);
+			totalfreespaceneeded -= fileneeded[i].currentsize;
+			requested[numrequested++] = (UINT8)i;
 			fileneeded[i].status = FS_REQUESTED;
 		}
 	WRITEUINT8(p, 0xFF);
+	// Older servers stop reading at the 0xFF, see Got_RequestFilePak
+	for (i = 0; i < numrequested; i++)
+		WRITEUINT32(p, fileneeded[requested[i]].currentsize);
 	I_GetDiskFreeSpace(&availablefreespace);
 	if (totalfreespaceneeded > availablefreespace)
 		I_Error("To play on this server you must download %s KB,\n"
@@ -296,20 +375,60 @@ boolean CL_SendRequestFile(void)
 	return HSendPacket(servernode, true, 0, p - (char *)netbuffer->u.textcmd);
 }
 
+// Skips a file name written with WRITESTRINGN(p, name, MAX_WADPATH).
+// Returns NULL if it runs past end.
+static UINT8 *SkipFileName(UINT8 *p, const UINT8 *end)
+{
+	size_t i;
+
+	for (i = 0; i < MAX_WADPATH; i++)
+	{
+		if (p >= end)
+			return NULL;
+		if (*p++ == '\0')
+			break;
+	}
+	return p;
+}
+
 // get request filepak and put it on the send queue
+// The 0xFF ending the list of files is followed by where the client's
+// partial download of each one ends, in the same order. Older clients
+// don't send those, so they get their files from the start.
 // returns false if a requested file was not found or cannot be sent
 boolean Got_RequestFilePak(INT32 node)
 {
 	char wad[MAX_WADPATH+1];
 	UINT8 *p = netbuffer->u.textcmd;
+	UINT8 *positions;
 	UINT8 id;
-	while (p < netbuffer->u.textcmd + MAXTEXTCMD-1) // Don't allow hacked client to overflow
+	UINT32 position;
+	size_t numfiles = 0;
+	const UINT8 *end = (UINT8 *)netbuffer + doomcom->datalength;
+
+	// Check the whole list is in the packet first
+	// Don't allow hacked client to overflow
+	for (;;)
 	{
-		id = READUINT8(p);
-		if (id == 0xFF)
+		if (p >= end)
+			return false;
+		if (READUINT8(p) == 0xFF)
 			break;
+		p = SkipFileName(p, end);
+		if (!p)
+			return false;
+		numfiles++;
+	}
+	positions = ((size_t)(end - p) >= numfiles * sizeof (UINT32)) ? p : NULL;
+
+	p = netbuffer->u.textcmd;
+	while ((id = READUINT8(p)) != 0xFF)
+	{
 		READSTRINGN(p, wad, MAX_WADPATH);
-		if (!SV_SendFile(node, wad, id))
+		position = 0;
+		if (positions)
+			position = READUINT32(positions); // Where the client's partial download of it ends
+		if (!SV_SendFile(node, wad, id, position))
 		{
 			SV_AbortSendFiles(node);
 			return false; // don't read the rest of the files
@@ -465,10 +584,11 @@ static INT32 filestosend = 0;
   * \param node The node to send the file to
   * \param filename The file to send
   * \param fileid ???
+  * \param position Where to start sending from, to resume a download
   * \sa SV_SendRam
   *
   */
-static boolean SV_SendFile(INT32 node, const char *filename, UINT8 fileid)
+static boolean SV_SendFile(INT32 node, const char *filename, UINT8 fileid, UINT32 position)
 {
 	filetx_t **q; // A pointer to the "next" field of the last file in the list
 	filetx_t *p; // The new file request
@@ -543,6 +663,7 @@ static boolean SV_SendFile(INT32 node, const char *filename, UINT8 fileid)
 	DEBFILE(va("Sending file %s (id=%d) to %d\n", filename, fileid, node));
 	p->ram = SF_FILE; // It's a file, we need to close it and free its name once we're done sending it
 	p->fileid = fileid;
+	p->position = position;
 	p->next = NULL; // End of list
 	filestosend++;
 	return true;
@@ -591,11 +712,12 @@ void SV_SendRam(INT32 node, void *data, size_t size, freemethod_t freemethod, UI
   * either because the file has been fully sent or because the node was disconnected
   *
   * \param node The destination
+  * \param p The file request
   *
   */
-static void SV_EndFileSend(INT32 node)
+static void SV_EndFileSend(INT32 node, filetx_t *p)
 {
-	filetx_t *p = transfer[node].txlist;
+	filetx_t **q;
 
 	// Free the file request according to the freemethod parameter used with SV_SendFile/Ram
 	switch (p->ram)
@@ -603,8 +725,8 @@ static void SV_EndFileSend(INT32 node)
 		case SF_FILE: // It's a file, close it and free its filename
 			if (cv_noticedownload.value)
 				CONS_Printf("Ending file transfer for node %d\n", node);
-			if (transfer[node].currentfile)
-				fclose(transfer[node].currentfile);
+			if (p->currentfile)
+				fclose(p->currentfile);
 			free(p->id.filename);
 			break;
 		case SF_Z_RAM: // It's a memory block allocated with Z_Alloc or the likes, use Z_Free
@@ -617,39 +739,143 @@ static void SV_EndFileSend(INT32 node)
 	}
 
 	// Remove the file request from the list
-	transfer[node].txlist = p->next;
+	for (q = &transfer[node].txlist; *q != p; q = &(*q)->next)
+		;
+	*q = p->next;
+	if (transfer[node].nextfile == p)
+		transfer[node].nextfile = p->next;
 	free(p);
 
-	// Indicate that the transmission is over
-	transfer[node].currentfile = NULL;
+	if (!transfer[node].txlist)
+		transfer[node].window = 0; // Start over next time
 
 	filestosend--;
 }
 
 #define PACKETPERTIC net_bandwidth/(TICRATE*software_MAXPACKETLENGTH)
 
+/** Picks the file a node gets its next fragment of,
+  * going round the first FILETXCONCURRENT files in its list
+  *
+  * \param node The destination
+  * \return The file request
+  *
+  */
+static filetx_t *SV_NextFileToSend(INT32 node)
+{
+	filetx_t *f;
+	INT32 i = 0;
+
+	// Past the files being sent? Go back to the first
+	for (f = transfer[node].txlist; f && f != transfer[node].nextfile && i < FILETXCONCURRENT - 1; f = f->next)
+		i++;
+	if (!f || f != transfer[node].nextfile)
+		f = transfer[node].txlist;
+
+	transfer[node].nextfile = f->next;
+	return f;
+}
+
+/** Sends the next fragment of a file to a node
+  *
+  * \param node The destination
+  * \param f The file request
+  * \return False if the packet couldn't be sent
+  *
+  */
+static boolean SV_SendFileFragment(INT32 node, filetx_t *f)
+{
+	filetx_pak *p;
+	size_t size;
+	const INT32 ram = f->ram;
+
+	// Open the file if it isn't open yet, or
+	if (!f->currentfile)
+	{
+		if (!ram) // Sending a file
+		{
+			long filesize;
+
+			f->currentfile = fopen(f->id.filename, "rb");
+
+			if (!f->currentfile)
+				I_Error("File %s does not exist",
+					f->id.filename);
+
+			fseek(f->currentfile, 0, SEEK_END);
+			filesize = ftell(f->currentfile);
+
+			// Nobody wants to transfer a file bigger
+			// than 4GB!
+			if (filesize >= LONG_MAX)
+				I_Error("filesize of %s is too large", f->id.filename);
+			if (filesize == -1)
+				I_Error("Error getting filesize of %s", f->id.filename);
+
+			f->size = (UINT32)filesize;
+			if (f->position >= f->size) // Can't resume past the end
+				f->position = 0;
+			fseek(f->currentfile, f->position, SEEK_SET);
+		}
+		else // Sending RAM
+			f->currentfile = (FILE *)1; // Set currentfile to a non-null value to indicate that it is open
+	}
+
+	// Build a packet containing a file fragment
+	p = &netbuffer->u.filetxpak;
+	size = software_MAXPACKETLENGTH - (FILETXHEADER + BASEPACKETSIZE);
+	if (f->size-f->position < size)
+		size = f->size-f->position;
+	if (ram)
+		M_Memcpy(p->data, &f->id.ram[f->position], size);
+	else if (fread(p->data, 1, size, f->currentfile) != size)
+		I_Error("SV_FileSendTicker: can't read %s byte on %s at %d because %s", sizeu1(size), f->id.filename, f->position, M_FileError(f->currentfile));
+	p->position = LONG(f->position);
+	// Put flag so receiver knows the total size
+	if (f->position + size == f->size)
+		p->position |= LONG(0x80000000);
+	p->fileid = f->fileid;
+	p->size = SHORT((UINT16)size);
+
+	// Send the packet
+	if (HSendPacket(node, true, 0, FILETXHEADER + size)) // Reliable SEND
+	{ // Success
+		f->position = (UINT32)(f->position + size);
+		if (f->position == f->size) // Finish?
+			SV_EndFileSend(node, f);
+		return true;
+	}
+	else
+	{ // Not sent for some odd reason, retry at next call
+		if (!ram)
+			fseek(f->currentfile, f->position, SEEK_SET);
+		return false;
+	}
+}
+
 /** Handles file transmission
   *
-  * \todo Use an acknowledging method more adapted to file transmission
-  *       The current download speed suffers from lack of ack packets,
-  *       especially when the one downloading has high latency
+  * Every node gets up to its own window of fragments per tic, spread
+  * over the first FILETXCONCURRENT files it asked for. A window grows
+  * by one each tic the node used all of it, and halves whenever the
+  * node needed packets resent, so slow links don't drown in resends
+  * while fast ones aren't held back by them.
   *
   */
 void SV_FileSendTicker(void)
 {
 	static INT32 currentnode = 0;
-	filetx_pak *p;
-	size_t size;
-	filetx_t *f;
-	INT32 packetsent, ram, i, j;
-	INT32 maxpacketsent;
+	INT32 packetsent, i, j;
+	INT32 maxpacketsent, maxwindow;
+	INT32 nodesent[MAXNETNODES];
+	boolean sent;
 
 	if (!filestosend) // No file to send
 		return;
 
 	if (cv_downloadspeed.value) // New (and experimental) behavior
 	{
-		packetsent = cv_downloadspeed.value;
+		packetsent = maxwindow = cv_downloadspeed.value;
 		// Don't send more packets than we have free acks
 #ifndef NONET
 		maxpacketsent = Net_GetFreeAcks(false) - 5; // Let 5 extra acks just in case
@@ -664,91 +890,125 @@ void SV_FileSendTicker(void)
 		packetsent = PACKETPERTIC;
 		if (!packetsent)
 			packetsent = 1;
+		maxwindow = packetsent;
+	}
+
+	// Shrink the windows of nodes that lost packets
+	for (i = 0; i < MAXNETNODES; i++)
+	{
+		nodesent[i] = 0;
+		if (!transfer[i].txlist)
+			continue;
+		if (!transfer[i].window)
+			transfer[i].window = FILETXWINDOW;
+		else if (Net_GetResentPackets(i))
+			transfer[i].window = max(transfer[i].window / 2, 1);
 	}
 
 	netbuffer->packettype = PT_FILEFRAGMENT;
 
 	// (((sendbytes-nowsentbyte)*TICRATE)/(I_GetTime()-starttime)<(UINT32)net_bandwidth)
-	while (packetsent-- && filestosend != 0)
+	while (packetsent > 0 && filestosend != 0)
 	{
-		for (i = currentnode, j = 0; j < MAXNETNODES;
+		// One fragment to every node with room left in its window, in turn
+		sent = false;
+		for (i = currentnode, j = 0; j < MAXNETNODES && packetsent > 0;
 			i = (i+1) % MAXNETNODES, j++)
 		{
-			if (transfer[i].txlist)
-				goto found;
-		}
-		// no transfer to do
-		I_Error("filestosend=%d but no file to send found\n", filestosend);
-	found:
-		currentnode = (i+1) % MAXNETNODES;
-		f = transfer[i].txlist;
-		ram = f->ram;
-
-		// Open the file if it isn't open yet, or
-		if (!transfer[i].currentfile)
-		{
-			if (!ram) // Sending a file
+			if (!transfer[i].txlist || nodesent[i] >= transfer[i].window)
+				continue;
+
+			if (!SV_SendFileFragment(i, SV_NextFileToSend(i)))
 			{
-				long filesize;
+				// Exit the while (can't send this one so why should i send the next?)
+				packetsent = 0;
+				break;
+			}
 
-				transfer[i].currentfile =
-					fopen(f->id.filename, "rb");
+			nodesent[i]++;
+			packetsent--;
+			sent = true;
+			currentnode = (i+1) % MAXNETNODES;
+		}
 
-				if (!transfer[i].currentfile)
-					I_Error("File %s does not exist",
-						f->id.filename);
+		if (!sent)
+			break; // Every window is full
+	}
 
-				fseek(transfer[i].currentfile, 0, SEEK_END);
-				filesize = ftell(transfer[i].currentfile);
+	// Grow the windows of nodes that used all of theirs
+	for (i = 0; i < MAXNETNODES; i++)
+		if (transfer[i].txlist && nodesent[i] >= transfer[i].window && transfer[i].window < maxwindow)
+			transfer[i].window++;
+}
 
-				// Nobody wants to transfer a file bigger
-				// than 4GB!
-				if (filesize >= LONG_MAX)
-					I_Error("filesize of %s is too large", f->id.filename);
-				if (filesize == -1)
-					I_Error("Error getting filesize of %s", f->id.filename);
+// Writes a fragment where it belongs in the file being downloaded
+static void WriteFileFragment(fileneeded_t *file, UINT32 pos, const UINT8 *data, UINT16 size)
+{
+	fseek(file->file, pos, SEEK_SET);
+	if (fwrite(data, size, 1, file->file) != 1)
+		I_Error("Can't write to %s: %s\n", file->filename, M_FileError(file->file));
+}
 
-				f->size = (UINT32)filesize;
-				fseek(transfer[i].currentfile, 0, SEEK_SET);
-			}
-			else // Sending RAM
-				transfer[i].currentfile = (FILE *)1; // Set currentfile to a non-null value to indicate that it is open
-			transfer[i].position = 0;
-		}
+// Writes out the held fragments that now follow on from what's been written
+static void FlushHeldFragments(INT32 filenum)
+{
+	fileneeded_t *file = &fileneeded[filenum];
+	fileheld_t **prev = &heldfragments[filenum];
+	fileheld_t *held;
 
-		// Build a packet containing a file fragment
-		p = &netbuffer->u.filetxpak;
-		size = software_MAXPACKETLENGTH - (FILETXHEADER + BASEPACKETSIZE);
-		if (f->size-transfer[i].position < size)
-			size = f->size-transfer[i].position;
-		if (ram)
-			M_Memcpy(p->data, &f->id.ram[transfer[i].position], size);
-		else if (fread(p->data, 1, size, transfer[i].currentfile) != size)
-			I_Error("SV_FileSendTicker: can't read %s byte on %s at %d because %s", sizeu1(size), f->id.filename, transfer[i].position, M_FileError(transfer[i].currentfile));
-		p->position = LONG(transfer[i].position);
-		// Put flag so receiver knows the total size
-		if (transfer[i].position + size == f->size)
-			p->position |= LONG(0x80000000);
-		p->fileid = f->fileid;
-		p->size = SHORT((UINT16)size);
-
-		// Send the packet
-		if (HSendPacket(i, true, 0, FILETXHEADER + size)) // Reliable SEND
-		{ // Success
-			transfer[i].position = (UINT32)(transfer[i].position + size);
-			if (transfer[i].position == f->size) // Finish?
-				SV_EndFileSend(i);
-		}
-		else
-		{ // Not sent for some odd reason, retry at next call
-			if (!ram)
-				fseek(transfer[i].currentfile,transfer[i].position, SEEK_SET);
-			// Exit the while (can't send this one so why should i send the next?)
-			break;
+	while ((held = *prev) != NULL)
+	{
+		if (held->position != file->writtensize)
+		{
+			prev = &held->next;
+			continue;
 		}
+
+		WriteFileFragment(file, held->position, held->data, held->size);
+		file->writtensize += held->size;
+		*prev = held->next;
+		free(held->data);
+		free(held);
+
+		// Something held earlier may follow on from this one now
+		prev = &heldfragments[filenum];
 	}
 }
 
+static void FreeHeldFragments(INT32 filenum)
+{
+	while (heldfragments[filenum])
+	{
+		fileheld_t *next = heldfragments[filenum]->next;
+		free(heldfragments[filenum]->data);
+		free(heldfragments[filenum]);
+		heldfragments[filenum] = next;
+	}
+}
+
+// Holds on to a fragment that came before the ones in front of it
+static boolean HoldFileFragment(INT32 filenum, UINT32 pos, const UINT8 *data, UINT16 size)
+{
+	fileheld_t *held;
+
+	for (held = heldfragments[filenum]; held; held = held->next)
+		if (held->position == pos)
+			return false; // Already have this one
+
+	held = malloc(sizeof (*held));
+	if (!held)
+		I_Error("Can't hold on to a fragment of %s", fileneeded[filenum].filename);
+	held->data = malloc(size);
+	if (!held->data)
+		I_Error("Can't hold on to a fragment of %s", fileneeded[filenum].filename);
+	M_Memcpy(held->data, data, size);
+	held->position = pos;
+	held->size = size;
+	held->next = heldfragments[filenum];
+	heldfragments[filenum] = held;
+	return true;
+}
+
 void Got_Filetxpak(void)
 {
 	INT32 filenum = netbuffer->u.filetxpak.fileid;
@@ -780,13 +1040,29 @@ void Got_Filetxpak(void)
 
 	if (file->status == FS_REQUESTED)
 	{
+		char partname[PARTFILENAMELEN];
+		const char *openname = file->partial ? PartFileName(file, partname) : filename;
+
 		if (file->file)
 			I_Error("Got_Filetxpak: already open file\n");
-		file->file = fopen(filename, "wb");
+		// Resuming? Keep what's already there
+		if (file->partial && file->currentsize)
+			file->file = fopen(openname, "r+b");
+		else
+			file->currentsize = 0;
+		if (!file->file)
+		{
+			file->file = fopen(openname, "wb");
+			file->currentsize = 0;
+		}
 		if (!file->file)
-			I_Error("Can't create file %s: %s", filename, strerror(errno));
-		CONS_Printf("\r%s...\n",filename);
-		file->currentsize = 0;
+			I_Error("Can't create file %s: %s", openname, strerror(errno));
+		if (file->currentsize)
+			CONS_Printf("\r%s (resuming from %s)...\n", filename, sizeu1((size_t)file->currentsize));
+		else
+			CONS_Printf("\r%s...\n",filename);
+		file->writtensize = file->currentsize;
+		FreeHeldFragments(filenum);
 		file->status = FS_DOWNLOADING;
 	}
 
@@ -801,20 +1077,54 @@ void Got_Filetxpak(void)
 			pos &= ~0x80000000;
 			file->totalsize = pos + size;
 		}
-		// We can receive packet in the wrong order, anyway all os support gaped file
-		fseek(file->file, pos, SEEK_SET);
-		if (fwrite(netbuffer->u.filetxpak.data,size,1,file->file) != 1)
-			I_Error("Can't write to %s: %s\n",filename, M_FileError(file->file));
-		file->currentsize += size;
+		// Fragments can arrive out of order: write them in order and hold
+		// on to the early ones, so the file never has gaps to resume over
+		if (pos == file->writtensize)
+		{
+			WriteFileFragment(file, pos, netbuffer->u.filetxpak.data, size);
+			file->writtensize += size;
+			file->currentsize += size;
+			FlushHeldFragments(filenum);
+		}
+		else if (pos > file->writtensize)
+		{
+			if (HoldFileFragment(filenum, pos, netbuffer->u.filetxpak.data, size))
+				file->currentsize += size;
+		}
+		// else it's a resent fragment we already have
 
 		// Finished?
 		if (file->currentsize == file->totalsize)
 		{
 			fclose(file->file);
 			file->file = NULL;
+			FreeHeldFragments(filenum);
 			file->status = FS_FOUND;
-			CONS_Printf(M_GetText("Downloading %s...(done)\n"),
-				filename);
+
+			if (file->partial)
+			{
+				char partname[PARTFILENAMELEN];
+
+				PartFileName(file, partname);
+
+				// A resumed file could have been changed on the server in between
+				file->status = checkfilemd5(partname, file->md5sum);
+				if (file->status == FS_FOUND)
+				{
+					remove(filename);
+					if (rename(partname, filename) != 0)
+						I_Error("Can't rename %s to %s: %s", partname, filename, strerror(errno));
+				}
+				else
+				{
+					remove(partname);
+					CONS_Alert(CONS_ERROR, M_GetText("Downloaded %s doesn't match the server's, deleted it\n"), filename);
+				}
+			}
+
+			if (file->status == FS_FOUND)
+				CONS_Printf(M_GetText("Downloading %s...(done)\n"),
+					filename);
 		}
 	}
 	else
@@ -872,9 +1182,342 @@ boolean SV_SendingFile(INT32 node)
 void SV_AbortSendFiles(INT32 node)
 {
 	while (transfer[node].txlist)
-		SV_EndFileSend(node);
+		SV_EndFileSend(node, transfer[node].txlist);
+}
+
+#ifdef HAVE_CURL
+#define HTTPCONNECTIONS 4 // Range requests running at once
+#define HTTPMINRANGE (1<<20) // Files aren't split into ranges smaller than this
+
+// A byte range of a file, fetched by its own request
+typedef struct
+{
+	CURL *handle; // NULL when the slot is free
+	INT32 filenum;
+	UINT32 start; // First byte of the range
+	UINT32 position; // Where the next byte received goes
+	UINT32 end; // One past the last byte of the range
+	boolean checked; // The response is known to be the range
+	FILE *file;
+	char range[24];
+} httprange_t;
+
+static CURLM *httpmulti = NULL;
+static httprange_t httpranges[HTTPCONNECTIONS];
+static INT32 httpfile; // The file the next range is of
+static UINT32 httpposition; // Where in it the next range starts
+static UINT32 httprangesize; // How big its ranges are
+static UINT8 httppending[MAX_WADFILES]; // How many ranges of each file are still going
+static boolean httpfailed[MAX_WADFILES];
+
+static size_t HTTP_WriteRange(char *data, size_t size, size_t count, void *userdata)
+{
+	httprange_t *range = userdata;
+	size_t length = size * count;
+
+	// A mirror that ignores Range answers 200 with the whole file,
+	// which only fits if the range was the whole file anyway
+	if (!range->checked)
+	{
+		long code = 0;
+
+		curl_easy_getinfo(range->handle, CURLINFO_RESPONSE_CODE, &code);
+		if (!(code == 206 || (code == 200 && range->start == 0
+			&& range->end == fileneeded[range->filenum].totalsize)))
+		{
+			DEBFILE(va("HTTP range %s of %s got response %ld\n", range->range,
+				fileneeded[range->filenum].filename, code));
+			return 0;
+		}
+		range->checked = true;
+	}
+
+	// More than was asked for? The mirror must have ignored the range
+	if (length > range->end - range->position)
+		return 0;
+	if (fwrite(data, 1, length, range->file) != length)
+		return 0;
+
+	range->position += (UINT32)length;
+	fileneeded[range->filenum].currentsize += (UINT32)length;
+	return length;
+}
+
+// Checks a file once all of its ranges are in, and falls
+// back to asking the server for it if anything went wrong
+static void HTTP_FinishFile(INT32 filenum)
+{
+	fileneeded_t *file = &fileneeded[filenum];
+	char partname[PARTFILENAMELEN];
+
+	PartFileName(file, partname);
+
+	if (!httpfailed[filenum] && checkfilemd5(partname, file->md5sum) == FS_FOUND)
+	{
+		remove(file->filename);
+		if (rename(partname, file->filename) != 0)
+			I_Error("Can't rename %s to %s: %s", partname, file->filename, strerror(errno));
+		file->status = FS_FOUND;
+		CONS_Printf(M_GetText("Downloading %s...(done)\n"), file->filename);
+		return;
+	}
+
+	// Ranges after a failed one leave holes, so there's nothing to resume from
+	remove(partname);
+	file->currentsize = 0;
+	file->status = FS_NOTFOUND;
+	CONS_Alert(CONS_WARNING, M_GetText("Couldn't download %s from the HTTP mirror, asking the server instead\n"), file->filename);
+}
+
+// Moves on to the next file that needs downloading, if there is one
+static boolean HTTP_NextFile(void)
+{
+	fileneeded_t *file;
+	FILE *f;
+
+	for (httpfile++; httpfile < fileneedednum; httpfile++)
+	{
+		file = &fileneeded[httpfile];
+		if (file->status == FS_NOTFOUND || file->status == FS_MD5SUMBAD)
+			break;
+	}
+	if (httpfile >= fileneedednum)
+		return false;
+
+	// Put it in the download dir, same as CL_SendRequestFile
+	nameonly(file->filename);
+	strcatbf(file->filename, downloaddir, "/");
+	file->partial = true;
+	file->currentsize = PartFileSize(file);
+	file->status = FS_DOWNLOADING;
+	httpfailed[httpfile] = false;
+	httppending[httpfile] = 0;
+	CONS_Printf("\r%s...\n", file->filename);
+#ifdef CLIENT_LOADINGSCREEN
+	lastfilenum = httpfile;
+#endif
+
+	// Pick up where an earlier download of it stopped
+	if (!file->currentsize)
+	{
+		char partname[PARTFILENAMELEN];
+
+		f = fopen(PartFileName(file, partname), "wb");
+		if (!f)
+			I_Error("Can't create file %s: %s", partname, strerror(errno));
+		fclose(f);
+	}
+
+	httpposition = file->currentsize;
+	httprangesize = (file->totalsize - httpposition + HTTPCONNECTIONS - 1) / HTTPCONNECTIONS;
+	if (httprangesize < HTTPMINRANGE)
+		httprangesize = HTTPMINRANGE;
+
+	if (httpposition >= file->totalsize) // Nothing to fetch (empty file)
+		HTTP_FinishFile(httpfile);
+
+	return true;
+}
+
+// Starts fetching the next range into a free slot
+static boolean HTTP_StartRange(httprange_t *range)
+{
+	fileneeded_t *file;
+	char partname[PARTFILENAMELEN];
+	char *name;
+
+	// Done with this file? Skip ahead to one that isn't
+	while (httpfile < fileneedednum
+		&& (httpposition >= fileneeded[httpfile].totalsize || httpfailed[httpfile]))
+		if (!HTTP_NextFile())
+			return false;
+	if (httpfile >= fileneedednum)
+		return false;
+
+	file = &fileneeded[httpfile];
+
+	range->filenum = httpfile;
+	range->start = range->position = httpposition;
+	range->checked = false;
+	range->end = httpposition + min(httprangesize, file->totalsize - httpposition);
+	snprintf(range->range, sizeof range->range, "%u-%u", range->position, range->end - 1);
+	httpposition = range->end;
+
+	range->file = fopen(PartFileName(file, partname), "r+b");
+	if (!range->file)
+		I_Error("Can't open file %s: %s", partname, strerror(errno));
+	fseek(range->file, range->position, SEEK_SET);
+
+	range->handle = curl_easy_init();
+	if (!range->handle)
+		I_Error("HTTP_StartRange: can't create a curl handle");
+
+	name = va("%s", file->filename);
+	nameonly(name);
+	name = curl_easy_escape(range->handle, name, 0);
+	curl_easy_setopt(range->handle, CURLOPT_URL, va("%s%s", http_source, name));
+	curl_free(name);
+
+	curl_easy_setopt(range->handle, CURLOPT_RANGE, range->range);
+	curl_easy_setopt(range->handle, CURLOPT_WRITEFUNCTION, HTTP_WriteRange);
+	curl_easy_setopt(range->handle, CURLOPT_WRITEDATA, range);
+	curl_easy_setopt(range->handle, CURLOPT_FAILONERROR, 1L);
+	curl_easy_setopt(range->handle, CURLOPT_FOLLOWLOCATION, 1L);
+	curl_easy_setopt(range->handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(range->handle, CURLOPT_CONNECTTIMEOUT, 10L);
+	// Give up on a mirror that stalls
+	curl_easy_setopt(range->handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+	curl_easy_setopt(range->handle, CURLOPT_LOW_SPEED_TIME, 30L);
+	curl_easy_setopt(range->handle, CURLOPT_USERAGENT, va("SRB2FusionAdvance/%s", VERSIONSTRING));
+
+	curl_multi_add_handle(httpmulti, range->handle);
+	httppending[httpfile]++;
+	return true;
+}
+
+static void HTTP_EndRange(httprange_t *range, boolean ok)
+{
+	INT32 filenum = range->filenum;
+
+	curl_multi_remove_handle(httpmulti, range->handle);
+	curl_easy_cleanup(range->handle);
+	range->handle = NULL;
+	fclose(range->file);
+	range->file = NULL;
+
+	if (!ok || !range->checked || range->position != range->end)
+		httpfailed[filenum] = true;
+	httppending[filenum]--;
+
+	// Last range of the file?
+	if (!httppending[filenum] && (filenum != httpfile || httpposition >= fileneeded[filenum].totalsize || httpfailed[filenum]))
+	{
+		if (filenum == httpfile)
+			httpposition = fileneeded[filenum].totalsize; // Don't start any more of it
+		HTTP_FinishFile(filenum);
+	}
 }
 
+/** Starts downloading the missing files from the server's HTTP mirror,
+  * as several range requests at once.
+  *
+  * \return False if the server has no mirror, or curl isn't working
+  * \sa CL_HTTPDownloadTicker
+  *
+  */
+boolean CL_StartHTTPDownloads(void)
+{
+	static boolean curlinit = false;
+	size_t len = strlen(http_source);
+	INT32 i;
+
+	if (!len || M_CheckParm("-nohttp"))
+		return false;
+	if (strncmp(http_source, "http://", 7) && strncmp(http_source, "https://", 8))
+		return false;
+
+	if (!curlinit)
+	{
+		if (curl_global_init(CURL_GLOBAL_ALL) != 0)
+			return false;
+		curlinit = true;
+	}
+
+	httpmulti = curl_multi_init();
+	if (!httpmulti)
+		return false;
+
+	if (http_source[len-1] != '/' && len < MAX_MIRROR_LENGTH-1)
+		strcat(http_source, "/");
+
+	CONS_Printf(M_GetText("Downloading files from %s\n"), http_source);
+	I_mkdir(downloaddir, 0755);
+
+	for (i = 0; i < HTTPCONNECTIONS; i++)
+		httpranges[i].handle = NULL;
+	httpfile = -1;
+	httpposition = 0;
+	httprangesize = 0;
+	HTTP_NextFile();
+
+	return CL_HTTPDownloadTicker();
+}
+
+/** Keeps the HTTP downloads going, without blocking
+  *
+  * \return True while there's still something downloading
+  * \sa CL_StartHTTPDownloads
+  *
+  */
+boolean CL_HTTPDownloadTicker(void)
+{
+	CURLMsg *msg;
+	INT32 running, left, i;
+	boolean busy = false;
+
+	if (!httpmulti)
+		return false;
+
+	curl_multi_perform(httpmulti, &running);
+
+	while ((msg = curl_multi_info_read(httpmulti, &left)) != NULL)
+	{
+		if (msg->msg != CURLMSG_DONE)
+			continue;
+		for (i = 0; i < HTTPCONNECTIONS; i++)
+			if (httpranges[i].handle == msg->easy_handle)
+			{
+				if (msg->data.result != CURLE_OK)
+					DEBFILE(va("HTTP range %s of %s failed: %s\n", httpranges[i].range,
+						fileneeded[httpranges[i].filenum].filename, curl_easy_strerror(msg->data.result)));
+				HTTP_EndRange(&httpranges[i], msg->data.result == CURLE_OK);
+				break;
+			}
+	}
+
+	// Keep every connection busy
+	for (i = 0; i < HTTPCONNECTIONS; i++)
+	{
+		if (!httpranges[i].handle && HTTP_StartRange(&httpranges[i]))
+			curl_multi_perform(httpmulti, &running);
+		if (httpranges[i].handle)
+			busy = true;
+	}
+
+	if (!busy)
+	{
+		curl_multi_cleanup(httpmulti);
+		httpmulti = NULL;
+	}
+	return busy;
+}
+
+// Stops the HTTP downloads, throwing away what they got
+static void CL_AbortHTTPDownloads(void)
+{
+	char partname[PARTFILENAMELEN];
+	INT32 i;
+
+	if (!httpmulti)
+		return;
+
+	for (i = 0; i < HTTPCONNECTIONS; i++)
+		if (httpranges[i].handle)
+		{
+			curl_multi_remove_handle(httpmulti, httpranges[i].handle);
+			curl_easy_cleanup(httpranges[i].handle);
+			httpranges[i].handle = NULL;
+			fclose(httpranges[i].file);
+			httpranges[i].file = NULL;
+			httppending[httpranges[i].filenum] = 0;
+			remove(PartFileName(&fileneeded[httpranges[i].filenum], partname));
+		}
+
+	curl_multi_cleanup(httpmulti);
+	httpmulti = NULL;
+}
+#endif
+
 void CloseNetFile(void)
 {
 	INT32 i;
@@ -882,14 +1525,23 @@ void CloseNetFile(void)
 	for (i = 0; i < MAXNETNODES; i++)
 		SV_AbortSendFiles(i);
 
+#ifdef HAVE_CURL
+	CL_AbortHTTPDownloads();
+#endif
+
 	// Receiving a file?
 	for (i = 0; i < MAX_WADFILES; i++)
+	{
 		if (fileneeded[i].status == FS_DOWNLOADING && fileneeded[i].file)
 		{
 			fclose(fileneeded[i].file);
-			// File is not complete delete it
-			remove(fileneeded[i].filename);
+			fileneeded[i].file = NULL;
+			// File is not complete, delete it unless it can be resumed from
+			if (!fileneeded[i].partial)
+				remove(fileneeded[i].filename);
 		}
+		FreeHeldFragments(i);
+	}
 
 	// Remove PT_FILEFRAGMENT from acknowledge list
 	Net_AbortPacketType(PT_FILEFRAGMENT);
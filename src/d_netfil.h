@@ -41,13 +41,18 @@ typedef struct
 	// Used only for download
 	FILE *file;
 	UINT32 currentsize;
+	UINT32 writtensize; // Fragments past this are held until the ones before them come
 	UINT32 totalsize;
+	boolean partial; // Downloaded to a .part file first, kept to resume from
 	filestatus_t status; // The value returned by recsearch
 } fileneeded_t;
 
+#define MAX_MIRROR_LENGTH 256
+
 extern INT32 fileneedednum;
 extern fileneeded_t fileneeded[MAX_WADFILES];
 extern char downloaddir[512];
+extern char http_source[MAX_MIRROR_LENGTH];
 
 #ifdef CLIENT_LOADINGSCREEN
 extern INT32 lastfilenum;
@@ -73,6 +78,11 @@ boolean Got_RequestFilePak(INT32 node);
 void SV_AbortSendFiles(INT32 node);
 void CloseNetFile(void);
 
+#ifdef HAVE_CURL
+boolean CL_StartHTTPDownloads(void);
+boolean CL_HTTPDownloadTicker(void);
+#endif
+
 boolean fileexist(char *filename, time_t ptime);
 
 // Search a file in the wadpath, return FS_FOUND when found
@@ -84,6 +84,13 @@ void I_UpdateNoVsync(void)
 {
 }
 
+//
+// I_PresentFrame
+//
+void I_PresentFrame(void)
+{
+}
+
 //
 // I_ReadScreen
 //
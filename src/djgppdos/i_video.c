@@ -145,6 +145,13 @@ void I_UpdateNoVsync(void)
 	cv_vidwait.value = real_vidwait;
 }
 
+//
+// I_PresentFrame
+//
+void I_PresentFrame(void)
+{
+}
+
 //
 // I_ReadScreen
 //
@@ -496,6 +496,16 @@ extern const char *compdate, *comptime, *comprevision, *compbranch;
 ///	Dumps the contents of a network save game upon consistency failure for debugging.
 //#define DUMPCONSISTENCY
 
+///	Catch mobj desyncs too, by hashing mobj changes into the consistency check as they happen.
+//#define MOBJCONSISTANCY
+
+///	Also hash every mobj in full each tic, to cross-check MOBJCONSISTANCY against.
+///	\note	Walks the whole thinker list every tic, slow on maps with a lot of rings.
+//#define MOBJCONSISTANCYWALK
+#if defined (MOBJCONSISTANCYWALK) && !defined (MOBJCONSISTANCY)
+#define MOBJCONSISTANCY
+#endif
+
 ///	Polyobject fake flat code
 #define POLYOBJECTS_PLANES
 
@@ -109,7 +109,7 @@ extern postimg_t postimgtype2;
 extern INT32 postimgparam2;
 
 extern INT32 viewwindowx, viewwindowy;
-extern INT32 viewwidth, scaledviewwidth;
+extern INT32 viewwidth, scaledviewwidth, scaledviewheight;
 
 extern boolean gamedataloaded;
 
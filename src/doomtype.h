@@ -384,6 +384,17 @@ size_t strlcpy(char *dst, const char *src, size_t siz);
 #define PUREFUNC
 #endif
 
+// Each thread gets its own copy (renderer state used by worker threads)
+#ifndef THREADLOCAL
+#if !defined (HAVE_THREADS)
+#define THREADLOCAL
+#elif defined (_MSC_VER)
+#define THREADLOCAL __declspec(thread)
+#else
+#define THREADLOCAL __thread
+#endif
+#endif
+
 /* Miscellaneous types that don't fit anywhere else (Can this be changed?) */
 
 typedef struct
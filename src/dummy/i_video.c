@@ -51,6 +51,8 @@ void I_FinishUpdate(void){}
 
 void I_UpdateNoVsync(void) {}
 
+void I_PresentFrame(void) {}
+
 void I_WaitVBL(INT32 count)
 {
 	(void)count;
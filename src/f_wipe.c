@@ -33,6 +33,11 @@
 #include "hardware/hw_main.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include "i_threads.h"
+#include "r_main.h" // cv_renderthreads
+#endif
+
 #if NUMSCREENS < 5
 #define NOWIPE // do not enable wipe image post processing for ARM, SH and MIPS CPUs
 #endif
@@ -169,6 +174,83 @@ static fademask_t *F_GetFadeMask(UINT8 masknum, UINT8 scrnnum) {
 	return NULL;
 }
 
+// The wipe goes a row of fade mask cells at a time. Rows don't overlap on
+// screen, so on big screens they go out to the render threads.
+#define WIPETHREADPIXELS (640*400)
+
+typedef struct
+{
+	const fademask_t *fademask;
+	const UINT16 *scrxpos, *scrypos;
+} wipejob_t;
+
+static void F_DoWipeRow(int masky, void *userdata)
+{
+	const wipejob_t *job = userdata;
+	const fademask_t *fademask = job->fademask;
+
+	// first pixel for each screen
+	UINT8       *w_base = wipe_scr;
+	const UINT8 *s_base = wipe_scr_start;
+	const UINT8 *e_base = wipe_scr_end;
+
+	// mask data for this row
+	const UINT8 *mask = fademask->mask + masky*fademask->width;
+	UINT8       *transtbl;
+
+	// rectangle draw hints
+	UINT32 draw_linestart, draw_rowstart;
+	UINT32 draw_lineend,   draw_rowend;
+	UINT32 draw_linestogo;
+	UINT32 relativepos;
+	UINT16 maskx;
+
+	draw_linestart = job->scrypos[masky];
+	draw_lineend   = job->scrypos[masky + 1];
+
+	for (maskx = 0; maskx < fademask->width; maskx++, mask++)
+	{
+		draw_rowstart = job->scrxpos[maskx];
+		draw_rowend   = job->scrxpos[maskx + 1];
+
+		relativepos = (draw_linestart * vid.width) + draw_rowstart;
+		draw_linestogo = draw_lineend - draw_linestart;
+
+		if (*mask == 0)
+		{
+			// shortcut - memcpy source to work
+			while (draw_linestogo--)
+			{
+				M_Memcpy(w_base+relativepos, s_base+relativepos, draw_rowend-draw_rowstart);
+				relativepos += vid.width;
+			}
+		}
+		else if (*mask == 10)
+		{
+			// shortcut - memcpy target to work
+			while (draw_linestogo--)
+			{
+				M_Memcpy(w_base+relativepos, e_base+relativepos, draw_rowend-draw_rowstart);
+				relativepos += vid.width;
+			}
+		}
+		else
+		{
+			// pointer to transtable that this mask would use
+			transtbl = transtables + ((9 - *mask)<<FF_TRANSSHIFT);
+
+			// DRAWING LOOP
+			while (draw_linestogo--)
+			{
+				V_TransRow(w_base+relativepos, e_base+relativepos, s_base+relativepos,
+					transtbl, NULL, draw_rowend-draw_rowstart);
+				relativepos += vid.width;
+			}
+			// END DRAWING LOOP
+		}
+	}
+}
+
 /**	Wipe ticker
   *
   * \param	fademask	pixels to change
@@ -192,25 +274,7 @@ static void F_DoWipe(fademask_t *fademask)
 	// In addition, we precalculate all the X and Y positions that we need to draw
 	// from and to, so it uses a little extra memory, but again, helps it run faster.
 	{
-		// wipe screen, start, end
-		UINT8       *w = wipe_scr;
-		const UINT8 *s = wipe_scr_start;
-		const UINT8 *e = wipe_scr_end;
-
-		// first pixel for each screen
-		UINT8       *w_base = w;
-		const UINT8 *s_base = s;
-		const UINT8 *e_base = e;
-
-		// mask data, end
-		UINT8       *transtbl;
-		const UINT8 *mask    = fademask->mask;
-		const UINT8 *maskend = mask + fademask->size;
-
-		// rectangle draw hints
-		UINT32 draw_linestart, draw_rowstart;
-		UINT32 draw_lineend,   draw_rowend;
-		UINT32 draw_linestogo, draw_rowstogo;
+		wipejob_t job;
 
 		// rectangle coordinates, etc.
 		UINT16* scrxpos = (UINT16*)malloc((fademask->width + 1)  * sizeof(UINT16));
@@ -231,59 +295,17 @@ static void F_DoWipe(fademask_t *fademask)
 		scrypos[fademask->height] = vid.height;
 		// ---
 
-		maskx = masky = 0;
-		do
-		{
-			draw_rowstart = scrxpos[maskx];
-			draw_rowend   = scrxpos[maskx + 1];
-			draw_linestart = scrypos[masky];
-			draw_lineend   = scrypos[masky + 1];
+		job.fademask = fademask;
+		job.scrxpos = scrxpos;
+		job.scrypos = scrypos;
 
-			relativepos = (draw_linestart * vid.width) + draw_rowstart;
-			draw_linestogo = draw_lineend - draw_linestart;
-
-			if (*mask == 0)
-			{
-				// shortcut - memcpy source to work
-				while (draw_linestogo--)
-				{
-					M_Memcpy(w_base+relativepos, s_base+relativepos, draw_rowend-draw_rowstart);
-					relativepos += vid.width;
-				}
-			}
-			else if (*mask == 10)
-			{
-				// shortcut - memcpy target to work
-				while (draw_linestogo--)
-				{
-					M_Memcpy(w_base+relativepos, e_base+relativepos, draw_rowend-draw_rowstart);
-					relativepos += vid.width;
-				}
-			}
-			else
-			{
-				// pointer to transtable that this mask would use
-				transtbl = transtables + ((9 - *mask)<<FF_TRANSSHIFT);
-
-				// DRAWING LOOP
-				while (draw_linestogo--)
-				{
-					w = w_base + relativepos;
-					s = s_base + relativepos;
-					e = e_base + relativepos;
-					draw_rowstogo = draw_rowend - draw_rowstart;
-
-					while (draw_rowstogo--)
-						*w++ = transtbl[ ( *e++ << 8 ) + *s++ ];
-
-					relativepos += vid.width;
-				}
-				// END DRAWING LOOP
-			}
-
-			if (++maskx >= fademask->width)
-				++masky, maskx = 0;
-		} while (++mask < maskend);
+#ifdef HAVE_THREADS
+		if (vid.width * vid.height >= WIPETHREADPIXELS)
+			I_ParallelFor(fademask->height, cv_renderthreads.value, F_DoWipeRow, &job);
+		else
+#endif
+		for (masky = 0; masky < fademask->height; masky++)
+			F_DoWipeRow(masky, &job);
 
 		free(scrxpos);
 		free(scrypos);
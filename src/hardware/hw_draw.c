@@ -309,6 +309,150 @@ void HWR_DrawFixedPatch(GLPatch_t *gpatch, fixed_t x, fixed_t y, fixed_t pscale,
 		HWD.pfnDrawPolygon(NULL, v, 4, flags);
 }
 
+// Draws a string's glyphs queued by V_DrawString and friends. They all share
+// their flags and scale, so the scale, centering and blending are worked out
+// once and each glyph only needs its texture and its quad.
+void HWR_DrawGlyphs(const vglyph_t *glyphs, INT32 count, fixed_t pscale, INT32 option)
+{
+	FOutVector v[4];
+	FSurfaceInfo Surf;
+	FSurfaceInfo *surf = NULL;
+	FBITFIELD flags;
+	GLPatch_t *gpatch;
+	UINT8 alphalevel = ((option & V_ALPHAMASK) >> V_ALPHASHIFT);
+	float dupx, dupy, fscale, cx, cy, fwidth, fheight;
+	float centerx = 0.0f, centery = 0.0f;
+	INT32 i;
+
+	if (alphalevel >= 10 && alphalevel < 13)
+		return;
+
+	if (option & V_FLIP)
+	{
+		for (i = 0; i < count; i++)
+			HWR_DrawFixedPatch((GLPatch_t *)glyphs[i].patch, glyphs[i].x, glyphs[i].y, pscale, option, glyphs[i].colormap);
+		return;
+	}
+
+	dupx = (float)vid.dupx;
+	dupy = (float)vid.dupy;
+
+	switch (option & V_SCALEPATCHMASK)
+	{
+	case V_NOSCALEPATCH:
+		dupx = dupy = 1.0f;
+		break;
+	case V_SMALLSCALEPATCH:
+		dupx = (float)vid.smalldupx;
+		dupy = (float)vid.smalldupy;
+		break;
+	case V_MEDSCALEPATCH:
+		dupx = (float)vid.meddupx;
+		dupy = (float)vid.meddupy;
+		break;
+	}
+
+	dupx = dupy = (dupx < dupy ? dupx : dupy);
+	fscale = FIXED_TO_FLOAT(pscale);
+
+	// same centering as HWR_DrawFixedPatch
+	if (!(option & (V_NOSCALESTART|V_SCALEPATCHMASK)))
+	{
+		if (fabsf((float)vid.width - (float)BASEVIDWIDTH * dupx) > 1.0E-36f)
+		{
+			if (option & V_SNAPTORIGHT)
+				centerx = ((float)vid.width - ((float)BASEVIDWIDTH * dupx));
+			else if (!(option & V_SNAPTOLEFT))
+				centerx = ((float)vid.width - ((float)BASEVIDWIDTH * dupx))/2;
+		}
+		if (fabsf((float)vid.height - (float)BASEVIDHEIGHT * dupy) > 1.0E-36f)
+		{
+			if ((option & (V_SPLITSCREEN|V_SNAPTOBOTTOM)) == (V_SPLITSCREEN|V_SNAPTOBOTTOM))
+				centery = ((float)vid.height/2 - ((float)BASEVIDHEIGHT/2 * dupy));
+			else if (option & V_SNAPTOBOTTOM)
+				centery = ((float)vid.height - ((float)BASEVIDHEIGHT * dupy));
+			else if (!(option & V_SNAPTOTOP))
+				centery = ((float)vid.height - ((float)BASEVIDHEIGHT * dupy))/2;
+		}
+	}
+
+	flags = PF_Translucent|PF_NoDepthTest;
+
+	if (option & V_WRAPX)
+		flags |= PF_ForceWrapX;
+	if (option & V_WRAPY)
+		flags |= PF_ForceWrapY;
+
+	if (alphalevel)
+	{
+		Surf.PolyColor.s.red = Surf.PolyColor.s.green = Surf.PolyColor.s.blue = 0xff;
+		if (alphalevel == 13) Surf.PolyColor.s.alpha = softwaretranstogl_lo[cv_translucenthud.value];
+		else if (alphalevel == 14) Surf.PolyColor.s.alpha = softwaretranstogl[cv_translucenthud.value];
+		else if (alphalevel == 15) Surf.PolyColor.s.alpha = softwaretranstogl_hi[cv_translucenthud.value];
+		else Surf.PolyColor.s.alpha = softwaretranstogl[10-alphalevel];
+		flags |= PF_Modulated;
+		surf = &Surf;
+	}
+
+	v[0].z = v[1].z = v[2].z = v[3].z = 1.0f;
+	v[0].s = v[3].s = 0.0f;
+	v[0].t = v[1].t = 0.0f;
+
+	for (i = 0; i < count; i++)
+	{
+		gpatch = (GLPatch_t *)glyphs[i].patch;
+
+		// a full screen patch blacks out the borders, let HWR_DrawFixedPatch handle it
+		if (SHORT(gpatch->width) == BASEVIDWIDTH && SHORT(gpatch->height) == BASEVIDHEIGHT)
+		{
+			HWR_DrawFixedPatch(gpatch, glyphs[i].x, glyphs[i].y, pscale, option, glyphs[i].colormap);
+			continue;
+		}
+
+		if (!glyphs[i].colormap)
+			HWR_GetPatch(gpatch);
+		else
+			HWR_GetMappedPatch(gpatch, glyphs[i].colormap);
+
+		cx = (float)SHORT(gpatch->leftoffset) * fscale;
+		cy = (float)SHORT(gpatch->topoffset) * fscale;
+		if ((option & (V_NOSCALESTART|V_OFFSET)) == (V_NOSCALESTART|V_OFFSET))
+		{
+			cx *= dupx;
+			cy *= dupy;
+		}
+		cx = FIXED_TO_FLOAT(glyphs[i].x) - cx;
+		cy = FIXED_TO_FLOAT(glyphs[i].y) - cy;
+
+		if (option & V_SPLITSCREEN)
+			cy /= 2;
+
+		if (!(option & V_NOSCALESTART))
+		{
+			cx = cx * dupx + centerx;
+			cy = cy * dupy + centery;
+		}
+
+		fwidth = (float)SHORT(gpatch->width) * fscale * dupx;
+		fheight = (float)SHORT(gpatch->height) * fscale * dupy;
+
+		cx = -1 + (cx / (vid.width/2));
+		cy = 1 - (cy / (vid.height/2));
+		fwidth /= vid.width / 2;
+		fheight /= vid.height / 2;
+
+		v[0].x = v[3].x = cx;
+		v[2].x = v[1].x = cx + fwidth;
+		v[0].y = v[1].y = cy;
+		v[2].y = v[3].y = cy - fheight;
+
+		v[2].s = v[1].s = gpatch->max_s;
+		v[2].t = v[3].t = gpatch->max_t;
+
+		HWD.pfnDrawPolygon(surf, v, 4, flags);
+	}
+}
+
 void HWR_DrawCroppedPatch(GLPatch_t *gpatch, fixed_t x, fixed_t y, fixed_t pscale, INT32 option, fixed_t sx, fixed_t sy, fixed_t w, fixed_t h)
 {
 	FOutVector v[4];
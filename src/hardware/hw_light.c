@@ -1043,16 +1043,7 @@ void HWR_DL_AddLight(gr_vissprite_t *spr, GLPatch_t *patch)
 
 
 	// uncapped/interpolation
-	interpmobjstate_t interp = {0};
-
-	if (R_UsingFrameInterpolation())
-	{
-		R_InterpolateMobjState(spr->mobj, rendertimefrac, &interp);
-	}
-	else
-	{
-		R_InterpolateMobjState(spr->mobj, FRACUNIT, &interp);
-	}
+	const interpmobjstate_t interp = spr->interp;
 
 	//Hurdler: moved here because it's better;-)
 	(void)patch;
@@ -3198,29 +3198,11 @@ static void HWR_Subsector(size_t num)
 
 	if (gr_frontsector->ffloors)
 	{
-		boolean anyMoved = gr_frontsector->moved;
-
-		if (anyMoved == false)
-		{
-			for (rover = gr_frontsector->ffloors; rover; rover = rover->next)
-			{
-				sector_t *controlSec = &sectors[rover->secnum];
-				if (controlSec->moved == true)
-				{
-					anyMoved = true;
-					break;
-				}
-			}
-		}
-
-		if (anyMoved == true)
-		{
-			gr_frontsector->numlights = sub->sector->numlights = 0;
-			R_Prep3DFloors(gr_frontsector);
-			sub->sector->lightlist = gr_frontsector->lightlist;
-			sub->sector->numlights = gr_frontsector->numlights;
-			sub->sector->moved = gr_frontsector->moved = false;
-		}
+		R_Prep3DFloors(gr_frontsector);
+		sub->sector->lightlist = gr_frontsector->lightlist;
+		sub->sector->numlights = gr_frontsector->numlights;
+		sub->sector->lightlistkey = gr_frontsector->lightlistkey;
+		sub->sector->lightlistframe = gr_frontsector->lightlistframe;
 
 		light = R_GetPlaneLight(gr_frontsector, locFloorHeight, false);
 		if (gr_frontsector->floorlightsec == -1)
@@ -3754,16 +3736,7 @@ static void HWR_DrawSpriteShadow(gr_vissprite_t *spr, GLPatch_t *gpatch, float t
 
 
 
-    interpmobjstate_t interp = {0};
-
-	if (R_UsingFrameInterpolation())
-	{
-	  R_InterpolateMobjState(spr->mobj, rendertimefrac, &interp);
-	}
-	else
-	{
-	  R_InterpolateMobjState(spr->mobj, FRACUNIT, &interp);
-	}
+	interpmobjstate_t interp = spr->interp;
 
 	mobjfloor = HWR_OpaqueFloorAtPos(
 		interp.x, interp.y,
@@ -3974,18 +3947,7 @@ static void HWR_RotateSpritePolyToAim(gr_vissprite_t *spr, FOutVector *wallVerts
 	{
 
 		// uncapped/interpolation
-		interpmobjstate_t interp = {0};
-
-
-		// do interpolation
-	    if (R_UsingFrameInterpolation())
-	    {
-	      R_InterpolateMobjState(spr->mobj, rendertimefrac, &interp);
-	    }
-	    else
-	    {
-	      R_InterpolateMobjState(spr->mobj, FRACUNIT, &interp);
-	    }
+		const interpmobjstate_t interp = spr->interp;
 
         float basey = FIXED_TO_FLOAT(interp.z);
 		float lowy = wallVerts[0].y;
@@ -5301,6 +5263,7 @@ static void HWR_ProjectSprite(mobj_t *thing)
 	vis->patchlumpnum = sprframe->lumppat[rot];
 	vis->flip = flip;
 	vis->mobj = thing;
+	vis->interp = interp;
 
 	//Hurdler: 25/04/2000: now support colormap in hardware mode
 	if ((vis->mobj->flags & MF_BOSS) && (vis->mobj->flags2 & MF2_FRET) && (leveltime & 1)) // Bosses "flash"
@@ -5452,6 +5415,7 @@ static void HWR_ProjectPrecipitationSprite(precipmobj_t *thing)
 	vis->patchlumpnum = sprframe->lumppat[rot];
 	vis->flip = flip;
 	vis->mobj = (mobj_t *)thing;
+	vis->interp = interp;
 
 	vis->colormap = colormaps;
 
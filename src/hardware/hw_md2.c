@@ -912,14 +912,7 @@ void HWR_DrawMD2(gr_vissprite_t *spr)
 	if (spr->precip)
 		return;
 
-	if (R_UsingFrameInterpolation())
-	{
-	  R_InterpolateMobjState(spr->mobj, rendertimefrac, &interp);
-	}
-	else
-	{
-	  R_InterpolateMobjState(spr->mobj, FRACUNIT, &interp);
-	}
+	interp = spr->interp;
 
 
 	// MD2 colormap fix
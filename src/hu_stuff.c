@@ -68,6 +68,11 @@ patch_t *nightsnum[10]; // 0-9
 patch_t *lt_font[LT_FONTSIZE];
 patch_t *cred_font[CRED_FONTSIZE];
 
+// Glyph widths of the fonts above, so measuring and laying out a string
+// doesn't have to touch every patch header. -1 where the glyph is missing.
+INT16 hu_fontwidth[HU_FONTSIZE], tny_fontwidth[HU_FONTSIZE];
+INT16 lt_fontwidth[LT_FONTSIZE], cred_fontwidth[CRED_FONTSIZE];
+
 static player_t *plr;
 boolean chat_on; // entering a chat message?
 boolean chat_on_first_event; // blocker for first chat input event
@@ -176,13 +181,32 @@ static void Command_CSay_f(void);
 static void Got_Saycmd(UINT8 **p, INT32 playernum);
 #endif
 
+static void HU_SetFontWidths(INT16 *widths, patch_t **font, INT32 size)
+{
+	INT32 i;
+
+	for (i = 0; i < size; i++)
+		widths[i] = (INT16)(font[i] ? SHORT(font[i]->width) : -1);
+}
+
+static void HU_LoadFontWidths(void)
+{
+	HU_SetFontWidths(hu_fontwidth, hu_font, HU_FONTSIZE);
+	HU_SetFontWidths(tny_fontwidth, tny_font, HU_FONTSIZE);
+	HU_SetFontWidths(lt_fontwidth, lt_font, LT_FONTSIZE);
+	HU_SetFontWidths(cred_fontwidth, cred_font, CRED_FONTSIZE);
+}
+
 void HU_LoadGraphics(void)
 {
 	char buffer[9];
 	INT32 i, j;
 
 	if (dedicated)
+	{
+		HU_LoadFontWidths();
 		return;
+	}
 
 	j = HU_FONTSTART;
 	for (i = 0; i < HU_FONTSIZE; i++, j++)
@@ -242,6 +266,8 @@ void HU_LoadGraphics(void)
 			cred_font[i] = (patch_t *)W_CachePatchName(buffer, PU_HUDGFX);
 	}
 
+	HU_LoadFontWidths();
+
 	//cache numbers too!
 	for (i = 0; i < 10; i++)
 	{
@@ -1913,7 +1939,7 @@ static inline void HU_DrawCrosshair(void)
 		y = (INT32)gr_basewindowcentery;
 	else
 #endif
-		y = viewwindowy + (viewheight>>1);
+		y = viewwindowy + (scaledviewheight>>1);
 
 	V_DrawScaledPatch(vid.width>>1, y, V_NOSCALESTART|V_OFFSET|V_TRANSLUCENT, crosshair[i - 1]);
 }
@@ -1934,7 +1960,7 @@ static inline void HU_DrawCrosshair2(void)
 		y = (INT32)gr_basewindowcentery;
 	else
 #endif
-		y = viewwindowy + (viewheight>>1);
+		y = viewwindowy + (scaledviewheight>>1);
 
 	if (splitscreen)
 	{
@@ -1943,7 +1969,7 @@ static inline void HU_DrawCrosshair2(void)
 			y += (INT32)gr_viewheight;
 		else
 #endif
-			y += viewheight;
+			y += scaledviewheight;
 
 		V_DrawScaledPatch(vid.width>>1, y, V_NOSCALESTART|V_OFFSET|V_TRANSLUCENT, crosshair[i - 1]);
 	}
@@ -2175,13 +2201,13 @@ void HU_Erase(void)
 		topline = 0;
 		for (y = topline, yoffset = y*vid.width; y < bottomline; y++, yoffset += vid.width)
 		{
-			if (y < viewwindowy || y >= viewwindowy + viewheight)
+			if (y < viewwindowy || y >= viewwindowy + scaledviewheight)
 				R_VideoErase(yoffset, vid.width); // erase entire line
 			else
 			{
 				R_VideoErase(yoffset, viewwindowx); // erase left border
 				// erase right border
-				R_VideoErase(yoffset + viewwindowx + viewwidth, viewwindowx);
+				R_VideoErase(yoffset + viewwindowx + scaledviewwidth, viewwindowx);
 			}
 		}
 		con_hudupdate = false; // if it was set..
@@ -77,6 +77,8 @@ extern patch_t *tallnum[10];
 extern patch_t *nightsnum[10];
 extern patch_t *lt_font[LT_FONTSIZE];
 extern patch_t *cred_font[CRED_FONTSIZE];
+extern INT16 hu_fontwidth[HU_FONTSIZE], tny_fontwidth[HU_FONTSIZE];
+extern INT16 lt_fontwidth[LT_FONTSIZE], cred_fontwidth[CRED_FONTSIZE];
 extern patch_t *emeraldpics[7];
 extern patch_t *tinyemeraldpics[7];
 extern patch_t *rflagico;
@@ -99,6 +99,11 @@ extern void (*I_NetSend)(void);
 */
 extern boolean (*I_NetCanSend)(void);
 
+/**	\brief	send anything the driver has held back from I_NetSend,
+	called once NetUpdate is done sending
+*/
+extern void (*I_NetFlush)(void);
+
 /**	\brief	close a connection
 
 	\param	nodenum	node to be closed
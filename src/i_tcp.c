@@ -12,6 +12,13 @@
 ///        This is not really OS-dependent because all OSes have the same socket API.
 ///        Just use ifdef for OS-dependent parts.
 
+#if defined (__linux__) && !defined (NOMMSG)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // recvmmsg and sendmmsg
+#endif
+#define HAVE_MMSG // Batch socket calls
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -251,6 +258,29 @@ static size_t numbans = 0;
 static boolean SOCK_bannednode[MAXNETNODES+1]; /// \note do we really need the +1?
 static boolean init_tcp_driver = false;
 
+#define NODEHASHSIZE 128 // Power of two, over twice MAXNETNODES+1
+static SINT8 nodehash[NODEHASHSIZE]; // clientaddress entries by IP, -1 when empty
+
+#ifdef HAVE_MMSG
+#define MMSGBATCH 32 // Datagrams per recvmmsg/sendmmsg
+
+// Datagrams received in one call, handed out one at a time by SOCK_Get
+static UINT8 recvbuffer[MMSGBATCH][MAXPACKETLENGTH];
+static mysockaddr_t recvaddress[MMSGBATCH];
+static struct mmsghdr recvmsgs[MMSGBATCH];
+static struct iovec recviov[MMSGBATCH];
+static size_t recvsocket[MMSGBATCH]; // Index in mysockets
+static size_t recvcount = 0, recvnext = 0;
+
+// Datagrams queued by SOCK_Send, for SOCK_Flush to send in one call
+static UINT8 sendbuffer[MMSGBATCH][MAXPACKETLENGTH];
+static struct mmsghdr sendmsgs[MMSGBATCH];
+static struct iovec sendiov[MMSGBATCH];
+static SOCKET_TYPE sendsocket[MMSGBATCH];
+static INT16 sendnode[MMSGBATCH];
+static size_t sendcount = 0;
+#endif
+
 #ifdef WATTCP
 static void wattcp_outch(char s)
 {
@@ -544,6 +574,64 @@ static boolean SOCK_cmpaddr(mysockaddr_t *a, mysockaddr_t *b, UINT8 mask)
 		return false;
 }
 
+static UINT32 SOCK_HashAddr(mysockaddr_t *sk)
+{
+	UINT32 hash = 0;
+#ifdef HAVE_IPV6
+	size_t i;
+#endif
+
+	// Not the port, SOCK_cmpaddr lets a port of 0 match any
+	if (sk->any.sa_family == AF_INET)
+		hash = ntohl(sk->ip4.sin_addr.s_addr);
+#ifdef HAVE_IPV6
+	else if (sk->any.sa_family == AF_INET6)
+		for (i = 0; i < 16; i++)
+			hash = hash*31 + sk->ip6.sin6_addr.s6_addr[i];
+#endif
+
+	hash ^= hash >> 16;
+	hash *= 0x45d9f3b;
+	hash ^= hash >> 16;
+	return hash & (NODEHASHSIZE-1);
+}
+
+// Rebuilds the address lookup, whenever a clientaddress changes
+static void SOCK_RehashNodes(void)
+{
+	INT32 j;
+	UINT32 h;
+
+	memset(nodehash, -1, sizeof (nodehash));
+
+	// In order, so the lowest node comes first for a shared address, like the old scan
+	for (j = 1; j <= MAXNETNODES; j++) //include LAN
+	{
+		if (clientaddress[j].any.sa_family != AF_INET
+#ifdef HAVE_IPV6
+			&& clientaddress[j].any.sa_family != AF_INET6
+#endif
+			)
+			continue;
+
+		for (h = SOCK_HashAddr(&clientaddress[j]); nodehash[h] != -1; h = (h+1) & (NODEHASHSIZE-1))
+			;
+		nodehash[h] = (SINT8)j;
+	}
+}
+
+// Finds the node a packet came from, -1 if it's a new one
+static INT32 SOCK_FindNode(mysockaddr_t *sk)
+{
+	UINT32 h;
+
+	for (h = SOCK_HashAddr(sk); nodehash[h] != -1; h = (h+1) & (NODEHASHSIZE-1))
+		if (SOCK_cmpaddr(sk, &clientaddress[nodehash[h]], 0))
+			return nodehash[h];
+
+	return -1;
+}
+
 // This is a hack. For some reason, nodes aren't being freed properly.
 // This goes through and cleans up what nodes were supposed to be freed.
 /** \warning This function causes the file downloading to stop if someone joins.
@@ -629,11 +717,120 @@ void Command_Numnodes(void)
 #endif
 
 #ifndef NONET
+// Sorts out which node a received packet is from, taking in new ones.
+// Sets doomcom->remotenode to -1 if there's no room for a new node.
+// Returns true if it's from a new node
+static boolean SOCK_GotPacket(mysockaddr_t *fromaddress, socklen_t fromlen, SOCKET_TYPE socket, ssize_t c)
+{
+	size_t i;
+	int j;
+
+	// find remote node number
+	j = SOCK_FindNode(fromaddress);
+	if (j != -1)
+	{
+		doomcom->remotenode = (INT16)j; // good packet from a game player
+		doomcom->datalength = (INT16)c;
+		nodesocket[j] = socket;
+		return false;
+	}
+	// not found
+
+	// find a free slot
+	j = getfreenode();
+	if (j > 0)
+	{
+		M_Memcpy(&clientaddress[j], fromaddress, fromlen);
+		SOCK_RehashNodes();
+		nodesocket[j] = socket;
+		DEBFILE(va("New node detected: node:%d address:%s\n", j,
+				SOCK_GetNodeAddress(j)));
+		doomcom->remotenode = (INT16)j; // good packet from a game player
+		doomcom->datalength = (INT16)c;
+
+		// check if it's a banned dude so we can send a refusal later
+		for (i = 0; i < numbans; i++)
+		{
+			if (SOCK_cmpaddr(fromaddress, &banned[i], bannedmask[i]))
+			{
+				SOCK_bannednode[j] = true;
+				DEBFILE("This dude has been banned\n");
+				break;
+			}
+		}
+		if (i == numbans)
+			SOCK_bannednode[j] = false;
+		return true;
+	}
+
+	DEBFILE("New node detected: No more free slots\n");
+	doomcom->remotenode = -1;
+	return false;
+}
+
+#ifdef HAVE_MMSG
+static void SOCK_Flush(void);
+
+// Reads as many waiting datagrams as fit, from every socket, in one call each
+static void SOCK_Receive(void)
+{
+	size_t n, i;
+	int got;
+
+	recvcount = recvnext = 0;
+
+	for (n = 0; n < mysocketses && recvcount < MMSGBATCH; n++)
+	{
+		for (i = recvcount; i < MMSGBATCH; i++)
+		{
+			recviov[i].iov_base = recvbuffer[i];
+			recviov[i].iov_len = MAXPACKETLENGTH;
+			memset(&recvmsgs[i].msg_hdr, 0, sizeof (recvmsgs[i].msg_hdr));
+			recvmsgs[i].msg_hdr.msg_name = &recvaddress[i];
+			recvmsgs[i].msg_hdr.msg_namelen = (socklen_t)sizeof (recvaddress[i]);
+			recvmsgs[i].msg_hdr.msg_iov = &recviov[i];
+			recvmsgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		got = recvmmsg(mysockets[n], &recvmsgs[recvcount], (unsigned int)(MMSGBATCH - recvcount), MSG_DONTWAIT, NULL);
+		if (got <= 0)
+			continue;
+
+		for (i = recvcount; i < recvcount + (size_t)got; i++)
+			recvsocket[i] = n;
+		recvcount += got;
+	}
+}
+#endif
+
 // Returns true if a packet was received from a new node, false in all other cases
 static boolean SOCK_Get(void)
 {
-	size_t i, n;
-	int j;
+#ifdef HAVE_MMSG
+	size_t i;
+
+	// Anything queued goes out before we look at the replies
+	SOCK_Flush();
+
+	for (;;)
+	{
+		if (recvnext == recvcount)
+		{
+			SOCK_Receive();
+			if (!recvcount)
+				break;
+		}
+
+		i = recvnext++;
+		M_Memcpy(&doomcom->data, recvbuffer[i], recvmsgs[i].msg_len);
+		if (SOCK_GotPacket(&recvaddress[i], recvmsgs[i].msg_hdr.msg_namelen,
+			mysockets[recvsocket[i]], (ssize_t)recvmsgs[i].msg_len))
+			return true;
+		if (doomcom->remotenode != -1)
+			return false;
+	}
+#else
+	size_t n;
 	ssize_t c;
 	mysockaddr_t fromaddress;
 	socklen_t fromlen;
@@ -645,48 +842,13 @@ static boolean SOCK_Get(void)
 			(void *)&fromaddress, &fromlen);
 		if (c != ERRSOCKET)
 		{
-			// find remote node number
-			for (j = 1; j <= MAXNETNODES; j++) //include LAN
-			{
-				if (SOCK_cmpaddr(&fromaddress, &clientaddress[j], 0))
-				{
-					doomcom->remotenode = (INT16)j; // good packet from a game player
-					doomcom->datalength = (INT16)c;
-					nodesocket[j] = mysockets[n];
-					return false;
-				}
-			}
-			// not found
-
-			// find a free slot
-			j = getfreenode();
-			if (j > 0)
-			{
-				M_Memcpy(&clientaddress[j], &fromaddress, fromlen);
-				nodesocket[j] = mysockets[n];
-				DEBFILE(va("New node detected: node:%d address:%s\n", j,
-						SOCK_GetNodeAddress(j)));
-				doomcom->remotenode = (INT16)j; // good packet from a game player
-				doomcom->datalength = (INT16)c;
-
-				// check if it's a banned dude so we can send a refusal later
-				for (i = 0; i < numbans; i++)
-				{
-					if (SOCK_cmpaddr(&fromaddress, &banned[i], bannedmask[i]))
-					{
-						SOCK_bannednode[j] = true;
-						DEBFILE("This dude has been banned\n");
-						break;
-					}
-				}
-				if (i == numbans)
-					SOCK_bannednode[j] = false;
+			if (SOCK_GotPacket(&fromaddress, fromlen, mysockets[n], c))
 				return true;
-			}
-			else
-				DEBFILE("New node detected: No more free slots\n");
+			if (doomcom->remotenode != -1)
+				return false;
 		}
 	}
+#endif
 
 	doomcom->remotenode = -1; // no packet
 	return false;
@@ -694,7 +856,7 @@ static boolean SOCK_Get(void)
 #endif
 
 #ifndef NONET
-static inline ssize_t SOCK_SendToAddr(SOCKET_TYPE socket, mysockaddr_t *sockaddr)
+static inline socklen_t SOCK_AddrLen(mysockaddr_t *sockaddr)
 {
 	socklen_t d4 = (socklen_t)sizeof(struct sockaddr_in);
 #ifdef HAVE_IPV6
@@ -711,11 +873,63 @@ static inline ssize_t SOCK_SendToAddr(SOCKET_TYPE socket, mysockaddr_t *sockaddr
 		default:       d = da; break;
 	}
 
-	return sendto(socket, (char *)&doomcom->data, doomcom->datalength, 0, &sockaddr->any, d);
+	return d;
+}
+
+static inline ssize_t SOCK_SendToAddr(SOCKET_TYPE socket, mysockaddr_t *sockaddr)
+{
+	return sendto(socket, (char *)&doomcom->data, doomcom->datalength, 0, &sockaddr->any, SOCK_AddrLen(sockaddr));
 }
 
 #define ALLOWEDERROR(x) ((x) == ECONNREFUSED || (x) == EWOULDBLOCK || (x) == EHOSTUNREACH || (x) == ENETUNREACH)
 
+#ifdef HAVE_MMSG
+// Sends everything SOCK_Send queued, one call per run of the same socket
+static void SOCK_Flush(void)
+{
+	size_t i = 0, run;
+	int sent;
+
+	while (i < sendcount)
+	{
+		for (run = i + 1; run < sendcount && sendsocket[run] == sendsocket[i]; run++)
+			;
+
+		sent = sendmmsg(sendsocket[i], &sendmsgs[i], (unsigned int)(run - i), 0);
+		if (sent == ERRSOCKET)
+		{
+			int e = errno; // save error code so it can't be modified later
+			if (!ALLOWEDERROR(e))
+				I_Error("SOCK_Flush, error sending to node %d (%s) #%u: %s", sendnode[i],
+					SOCK_GetNodeAddress(sendnode[i]), e, strerror(e));
+			i++; // Drop that one and carry on
+		}
+		else
+			i += sent;
+	}
+
+	sendcount = 0;
+}
+
+static void SOCK_QueueSend(SOCKET_TYPE socket, INT16 node)
+{
+	if (sendcount == MMSGBATCH)
+		SOCK_Flush();
+
+	M_Memcpy(sendbuffer[sendcount], &doomcom->data, doomcom->datalength);
+	sendiov[sendcount].iov_base = sendbuffer[sendcount];
+	sendiov[sendcount].iov_len = doomcom->datalength;
+	memset(&sendmsgs[sendcount].msg_hdr, 0, sizeof (sendmsgs[sendcount].msg_hdr));
+	sendmsgs[sendcount].msg_hdr.msg_name = &clientaddress[node];
+	sendmsgs[sendcount].msg_hdr.msg_namelen = SOCK_AddrLen(&clientaddress[node]);
+	sendmsgs[sendcount].msg_hdr.msg_iov = &sendiov[sendcount];
+	sendmsgs[sendcount].msg_hdr.msg_iovlen = 1;
+	sendsocket[sendcount] = socket;
+	sendnode[sendcount] = node;
+	sendcount++;
+}
+#endif
+
 static void SOCK_Send(void)
 {
 	ssize_t c = ERRSOCKET;
@@ -753,7 +967,13 @@ static void SOCK_Send(void)
 	}
 	else
 	{
+#ifdef HAVE_MMSG
+		// Sent along with the rest at the end of NetUpdate
+		SOCK_QueueSend(nodesocket[doomcom->remotenode], doomcom->remotenode);
+		return;
+#else
 		c = SOCK_SendToAddr(nodesocket[doomcom->remotenode], &clientaddress[doomcom->remotenode]);
+#endif
 	}
 
 	if (c == ERRSOCKET)
@@ -779,8 +999,14 @@ static void SOCK_FreeNodenum(INT32 numnode)
 	nodeconnected[numnode] = false;
 	nodesocket[numnode] = ERRSOCKET;
 
+#ifdef HAVE_MMSG
+	// Queued packets point at its address
+	SOCK_Flush();
+#endif
+
 	// put invalid address
 	memset(&clientaddress[numnode], 0, sizeof (clientaddress[numnode]));
+	SOCK_RehashNodes();
 }
 #endif
 
@@ -1234,6 +1460,10 @@ boolean I_InitTcpDriver(void)
 static void SOCK_CloseSocket(void)
 {
 	size_t i;
+#ifdef HAVE_MMSG
+	SOCK_Flush();
+	recvcount = recvnext = 0;
+#endif
 	for (i=0; i < mysocketses; i++)
 	{
 		if (mysockets[i] != (SOCKET_TYPE)ERRSOCKET)
@@ -1315,6 +1545,7 @@ static SINT8 SOCK_NetMakeNodewPort(const char *address, const char *port)
 			if (runp->ai_addr->sa_family == myfamily[i])
 			{
 				memcpy(&clientaddress[newnode], runp->ai_addr, runp->ai_addrlen);
+				SOCK_RehashNodes();
 				break;
 			}
 		}
@@ -1335,6 +1566,7 @@ static boolean SOCK_OpenSocket(void)
 	size_t i;
 
 	memset(clientaddress, 0, sizeof (clientaddress));
+	SOCK_RehashNodes();
 
 	nodeconnected[0] = true; // always connected to self
 	for (i = 1; i < MAXNETNODES; i++)
@@ -1345,6 +1577,9 @@ static boolean SOCK_OpenSocket(void)
 	I_NetCloseSocket = SOCK_CloseSocket;
 	I_NetFreeNodenum = SOCK_FreeNodenum;
 	I_NetMakeNodewPort = SOCK_NetMakeNodewPort;
+#ifdef HAVE_MMSG
+	I_NetFlush = SOCK_Flush;
+#endif
 
 	// build the socket but close it first
 	SOCK_CloseSocket();
@@ -93,9 +93,12 @@ void I_StartThreads(void)
 {
 }
 
+static void I_StopWorkers(void);
+
 void I_StopThreads(void)
 {
 	thread_t *thread = thread_list;
+	I_StopWorkers();
 	while (thread != NULL)
 	{
 		// join with all threads here, since finished threads haven't been awaited yet.
@@ -247,9 +250,12 @@ void I_StartThreads(void)
 	InitializeCriticalSection(&thread_lock);
 }
 
+static void I_StopWorkers(void);
+
 void I_StopThreads(void)
 {
 	thread_t *thread = thread_list;
+	I_StopWorkers();
 	while (thread != NULL)
 	{
 		WaitForSingleObject(thread->thread, INFINITE);
@@ -359,4 +365,113 @@ void I_WakeAllCond(cond_t *anchor)
 {
 	(void)anchor;
 }
+
+void I_ParallelFor(int count, int threads, parallel_fn_t fn, void *userdata)
+{
+	int i;
+	(void)threads;
+	for (i = 0; i < count; i++)
+		fn(i, userdata);
+}
+#endif
+
+#if defined (__unix__) || defined(UNIXCOMMON) || defined (_WIN32)
+// Workers for I_ParallelFor. They are spawned the first time they're
+// needed, and sleep between batches until I_StopThreads.
+#define MAXPOOLTHREADS 16
+
+static mutex_t pool_mutex;
+static cond_t pool_cond; // a new batch, or time to quit
+static cond_t pool_done_cond; // the last job of a batch finished
+static INT32 pool_threads, pool_active;
+static boolean pool_quit;
+
+static parallel_fn_t pool_fn;
+static void *pool_userdata;
+static INT32 pool_next, pool_count, pool_remaining;
+
+// Runs jobs until there are none left to start.
+// Called, and returns, with pool_mutex held.
+static void PoolRunJobs(void)
+{
+	while (pool_next < pool_count)
+	{
+		const INT32 index = pool_next++;
+		const parallel_fn_t fn = pool_fn;
+		void *userdata = pool_userdata;
+
+		I_UnlockMutex(pool_mutex);
+		fn(index, userdata);
+		I_LockMutex(&pool_mutex);
+
+		if (--pool_remaining == 0)
+			I_WakeAllCond(&pool_done_cond);
+	}
+}
+
+static void PoolWorker(void *userdata)
+{
+	const INT32 id = (INT32)(size_t)userdata;
+
+	I_LockMutex(&pool_mutex);
+	while (!pool_quit)
+	{
+		// Workers past the requested thread count sit this batch out.
+		if (id < pool_active && pool_next < pool_count)
+			PoolRunJobs();
+		else
+			I_HoldCond(&pool_cond, pool_mutex);
+	}
+	I_UnlockMutex(pool_mutex);
+}
+
+static void I_StopWorkers(void)
+{
+	if (!pool_threads)
+		return;
+
+	I_LockMutex(&pool_mutex);
+	pool_quit = true;
+	I_WakeAllCond(&pool_cond);
+	I_UnlockMutex(pool_mutex);
+}
+
+void I_ParallelFor(int count, int threads, parallel_fn_t fn, void *userdata)
+{
+	int i;
+
+	if (threads > MAXPOOLTHREADS)
+		threads = MAXPOOLTHREADS;
+	if (threads > count)
+		threads = count;
+
+	if (threads <= 1 || pool_quit)
+	{
+		for (i = 0; i < count; i++)
+			fn(i, userdata);
+		return;
+	}
+
+	// The calling thread is one of them.
+	while (pool_threads < threads - 1)
+	{
+		I_SpawnThread("parallel-worker", PoolWorker, (void *)(size_t)pool_threads);
+		pool_threads++;
+	}
+
+	I_LockMutex(&pool_mutex);
+	pool_fn = fn;
+	pool_userdata = userdata;
+	pool_next = 0;
+	pool_count = pool_remaining = count;
+	pool_active = threads - 1;
+	I_WakeAllCond(&pool_cond);
+
+	PoolRunJobs();
+	while (pool_remaining > 0)
+		I_HoldCond(&pool_done_cond, pool_mutex);
+
+	pool_count = 0;
+	I_UnlockMutex(pool_mutex);
+}
 #endif
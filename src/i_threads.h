@@ -15,6 +15,7 @@
 #define I_THREADS_H
 
 typedef void (*thread_fn_t)(void *userdata);
+typedef void (*parallel_fn_t)(int index, void *userdata);
 
 typedef void *mutex_t;
 typedef void *cond_t;
@@ -35,5 +36,10 @@ void I_HoldCond(cond_t *, mutex_t);
 void I_WakeOneCond(cond_t *);
 void I_WakeAllCond(cond_t *);
 
+/* run fn for every index in [0, count) on up to threads threads,
+   counting the caller, and return once all of them are done.
+   Main thread only; fn must not touch the zone or WADs. */
+void I_ParallelFor(int count, int threads, parallel_fn_t fn, void *userdata);
+
 #endif/*I_THREADS_H*/
 #endif/*HAVE_THREADS*/
@@ -35,6 +35,12 @@ tic_t I_GetTime(void)
 	return g_time.time;
 }
 
+int I_PreciseToMicros(precise_t d)
+{
+	// As a double, since d * 1000000 could overflow
+	return (int)(UINT64)(d / (I_GetPrecisePrecision() / 1000000.0));
+}
+
 void I_InitializeTime(void)
 {
 	g_time.time = 0;
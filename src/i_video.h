@@ -123,6 +123,13 @@ void I_FinishUpdate(void);
 */
 void I_UpdateNoVsync(void);
 
+/**	\brief	Present a frame I_FinishUpdate left converting in the background, if any
+
+	With vid_pipeline on, I_FinishUpdate only queues the frame, so that
+	converting it for display overlaps with running the next tic.
+*/
+void I_PresentFrame(void);
+
 /**	\brief	Wait for vertical retrace or pause a bit.
 
 	\param	count	max wait
@@ -18,6 +18,8 @@
 #include "z_zone.h"
 #include "p_local.h"
 #include "r_fps.h"
+#include "d_net.h"
+#include "d_clisrv.h"
 
 #ifdef HWRENDER
 #include "hardware/hw_main.h"
@@ -68,6 +70,28 @@ ps_metric_t ps_lua_mobjhooks = {0};
 
 ps_metric_t ps_otherlogictime = {0};
 
+ps_metric_t ps_netsendtime = {0};
+
+// Network traffic, in bytes per tic
+enum
+{
+	PS_NET_TOTAL,
+	PS_NET_TICCMDS,
+	PS_NET_TICS,
+	PS_NET_TEXTCMDS,
+	PS_NET_FILES,
+	PS_NET_RESYNCH,
+	PS_NET_ACKS,
+	PS_NET_OTHER,
+	PS_NUMNETKINDS
+};
+
+static ps_metric_t ps_netsent[PS_NUMNETKINDS];
+static ps_metric_t ps_netgot[PS_NUMNETKINDS];
+static ps_metric_t ps_netresent = {0};
+
+static netpacketstat_t ps_lastnettotals[NUMPACKETTYPE];
+
 // Columns for perfstats pages.
 
 // Position on screen is determined separately in the drawing functions.
@@ -98,6 +122,7 @@ perfstatrow_t rendertime_rows[] = {
 
 	{" skybox ", " Skybox render: ", &ps_skyboxtime, PS_TIME|PS_LEVEL|PS_SW},
 	{" bsptime", " RenderBSPNode: ", &ps_bsptime, PS_TIME|PS_LEVEL|PS_SW},
+	{" segloop", " Wall columns:  ", &ps_sw_seglooptime, PS_TIME|PS_LEVEL|PS_SW},
 	{" sprclip", " R_ClipSprites: ", &ps_sw_spritecliptime, PS_TIME|PS_LEVEL|PS_SW},
 	{" portals", " Portals:       ", &ps_sw_portaltime, PS_TIME|PS_LEVEL|PS_SW},
 	{" planes ", " R_DrawPlanes:  ", &ps_sw_planetime, PS_TIME|PS_LEVEL|PS_SW},
@@ -119,6 +144,8 @@ perfstatrow_t commoncounter_rows[] = {
 	{"sprites", "Sprites:     ", &ps_numsprites, 0},
 	{"drwnode", "Drawnodes:   ", &ps_numdrawnodes, 0},
 	{"plyobjs", "Polyobjects: ", &ps_numpolyobjects, 0},
+	{"cmapnew", "Colormaps:   ", &ps_colormapscreated, PS_LEVEL|PS_HIDE_ZERO},
+	{"cmapreu", "Cmap reuses: ", &ps_colormapsreused, PS_LEVEL|PS_HIDE_ZERO},
 	{0}
 };
 
@@ -158,6 +185,7 @@ perfstatrow_t gamelogic_rows[] = {
 	{"  precip ", "  Precipitation:  ", &ps_thlist_times[THINK_PRECIP], PS_TIME|PS_LEVEL},*/
 	{" lthinkf", " LUAh_ThinkFrame:", &ps_lua_thinkframe_time, PS_TIME|PS_LEVEL},
 	{" other  ", " Other:          ", &ps_otherlogictime, PS_TIME|PS_LEVEL},
+	{" netsend", " SV_SendTics:    ", &ps_netsendtime, PS_TIME|PS_HIDE_ZERO},
 	{0}
 };
 
@@ -179,6 +207,37 @@ perfstatrow_t misc_calls_rows[] = {
 	{0}
 };
 
+// Network stats columns
+
+perfstatrow_t netsent_rows[] = {
+	{"sent   ", "Bytes sent:     ", &ps_netsent[PS_NET_TOTAL], 0},
+	{" ticcmds", " Ticcmds:        ", &ps_netsent[PS_NET_TICCMDS], PS_HIDE_ZERO},
+	{" srvtics", " Server tics:    ", &ps_netsent[PS_NET_TICS], PS_HIDE_ZERO},
+	{" txtcmds", " Textcmds:       ", &ps_netsent[PS_NET_TEXTCMDS], PS_HIDE_ZERO},
+	{" files  ", " Files:          ", &ps_netsent[PS_NET_FILES], PS_HIDE_ZERO},
+	{" resynch", " Resynching:     ", &ps_netsent[PS_NET_RESYNCH], PS_HIDE_ZERO},
+	{" acks   ", " Acks:           ", &ps_netsent[PS_NET_ACKS], PS_HIDE_ZERO},
+	{" other  ", " Other:          ", &ps_netsent[PS_NET_OTHER], PS_HIDE_ZERO},
+	{0}
+};
+
+perfstatrow_t netgot_rows[] = {
+	{"rcvd   ", "Bytes received: ", &ps_netgot[PS_NET_TOTAL], 0},
+	{" ticcmds", " Ticcmds:        ", &ps_netgot[PS_NET_TICCMDS], PS_HIDE_ZERO},
+	{" srvtics", " Server tics:    ", &ps_netgot[PS_NET_TICS], PS_HIDE_ZERO},
+	{" txtcmds", " Textcmds:       ", &ps_netgot[PS_NET_TEXTCMDS], PS_HIDE_ZERO},
+	{" files  ", " Files:          ", &ps_netgot[PS_NET_FILES], PS_HIDE_ZERO},
+	{" resynch", " Resynching:     ", &ps_netgot[PS_NET_RESYNCH], PS_HIDE_ZERO},
+	{" acks   ", " Acks:           ", &ps_netgot[PS_NET_ACKS], PS_HIDE_ZERO},
+	{" other  ", " Other:          ", &ps_netgot[PS_NET_OTHER], PS_HIDE_ZERO},
+	{0}
+};
+
+perfstatrow_t netresent_rows[] = {
+	{"resent ", "Resent packets: ", &ps_netresent, 0},
+	{0}
+};
+
 // Sample collection status for averaging.
 // Maximum of these two is shown to user if nonzero to tell that
 // the reported averages are not correct yet.
@@ -563,6 +622,67 @@ static void PS_CountThinkers(void)
 	}*/
 }
 
+// Which row of the network page a packet type counts in
+static INT32 PS_GetNetKind(INT32 packettype)
+{
+	switch (packettype)
+	{
+		case PT_CLIENTCMD:
+		case PT_CLIENTMIS:
+		case PT_CLIENT2CMD:
+		case PT_CLIENT2MIS:
+		case PT_NODEKEEPALIVE:
+		case PT_NODEKEEPALIVEMIS:
+		case PT_CLIENTDELTA:
+		case PT_CLIENTDELTAMIS:
+		case PT_CLIENT2DELTA:
+		case PT_CLIENT2DELTAMIS:
+			return PS_NET_TICCMDS;
+		case PT_SERVERTICS:
+			return PS_NET_TICS;
+		case PT_TEXTCMD:
+		case PT_TEXTCMD2:
+			return PS_NET_TEXTCMDS;
+		case PT_FILEFRAGMENT:
+		case PT_REQUESTFILE:
+			return PS_NET_FILES;
+		case PT_RESYNCHING:
+		case PT_RESYNCHGET:
+		case PT_RESYNCHEND:
+			return PS_NET_RESYNCH;
+		case PT_NOTHING:
+			return PS_NET_ACKS;
+		default:
+			return PS_NET_OTHER;
+	}
+}
+
+// Update the network metrics from the traffic since the last tick.
+static void PS_CountNetTraffic(void)
+{
+	const netpacketstat_t *totals = Net_GetPacketTotals();
+	INT32 i;
+
+	for (i = 0; i < PS_NUMNETKINDS; i++)
+		ps_netsent[i].value.i = ps_netgot[i].value.i = 0;
+	ps_netresent.value.i = 0;
+
+	for (i = 0; i < NUMPACKETTYPE; i++)
+	{
+		const INT32 kind = PS_GetNetKind(i);
+		const INT32 sent = totals[i].sentbytes - ps_lastnettotals[i].sentbytes;
+		const INT32 got = totals[i].gotbytes - ps_lastnettotals[i].gotbytes;
+
+		ps_netsent[kind].value.i += sent;
+		ps_netsent[PS_NET_TOTAL].value.i += sent;
+		ps_netgot[kind].value.i += got;
+		ps_netgot[PS_NET_TOTAL].value.i += got;
+		ps_netresent.value.i += totals[i].resent - ps_lastnettotals[i].resent;
+	}
+
+	M_Memcpy(ps_lastnettotals, totals, sizeof (ps_lastnettotals));
+}
+
 // Update all metrics that are calculated on every tick.
 void PS_UpdateTickStats(void)
 {
@@ -598,6 +718,17 @@ void PS_UpdateTickStats(void)
 			PS_UpdateMetricHistory(&thinkframe_hooks[i].time_taken, true, false, false);
 		}
 	}
+	if (cv_perfstats.value == 4)
+	{
+		PS_CountNetTraffic();
+
+		if (cv_ps_samplesize.value > 1)
+		{
+			PS_UpdateRowHistories(netsent_rows, false);
+			PS_UpdateRowHistories(netgot_rows, false);
+			PS_UpdateRowHistories(netresent_rows, false);
+		}
+	}
 	if (cv_perfstats.value && cv_ps_samplesize.value > 1)
 	{
 		ps_tick_index++;
@@ -711,6 +842,21 @@ static void PS_DrawGameLogicStats(void)
 	PS_DrawPerfRows(x, y, V_PURPLEMAP, misc_calls_rows);
 }
 
+static void PS_DrawNetworkStats(void)
+{
+	const boolean hires = PS_HighResolution();
+	const int half_row = hires ? 5 : 4;
+	int x, y;
+
+	PS_DrawDescriptorHeader();
+
+	y = PS_DrawPerfRows(20, 10, V_YELLOWMAP, netsent_rows);
+	PS_DrawPerfRows(20, y + half_row, V_GRAYMAP, netresent_rows);
+
+	x = hires ? 115 : 90;
+	PS_DrawPerfRows(x, 10, V_BLUEMAP, netgot_rows);
+}
+
 static void PS_DrawThinkFrameStats(void)
 {
 	char s[100];
@@ -824,6 +970,11 @@ void M_DrawPerfStats(void)
 			PS_DrawThinkFrameStats();
 		}
 	}
+	else if (cv_perfstats.value == 4) // network
+	{
+		// Also updated in PS_UpdateTickStats
+		PS_DrawNetworkStats();
+	}
 }
 
 // remove and unallocate history from all metrics
@@ -847,6 +998,10 @@ void PS_PerfStats_OnChange(void)
 {
 	if (cv_perfstats.value && cv_ps_samplesize.value > 1)
 		PS_ClearHistory();
+
+	// Don't count everything since startup as the first tick's traffic
+	if (cv_perfstats.value == 4)
+		M_Memcpy(ps_lastnettotals, Net_GetPacketTotals(), sizeof (ps_lastnettotals));
 }
 
 void PS_SampleSize_OnChange(void)
@@ -49,6 +49,8 @@ extern ps_metric_t ps_lua_mobjhooks;
 
 extern ps_metric_t ps_otherlogictime;
 
+extern ps_metric_t ps_netsendtime;
+
 void PS_SetThinkFrameHookInfo(int index, precise_t time_taken, char* short_src);
 
 void PS_UpdateTickStats(void);
@@ -54,8 +54,6 @@ result_e T_MovePlane(sector_t *sector, fixed_t speed, fixed_t dest, boolean crus
 	boolean sectorisffloor = false;
 	boolean sectorisquicksand = false;
 
-	sector->moved = true;
-
 	switch (floorOrCeiling)
 	{
 		case 0:
@@ -719,7 +717,6 @@ void T_ContinuousFalling(levelspecthink_t *faller)
 
 	faller->sector->floorspeed = faller->speed*faller->direction;
 	faller->sector->ceilspeed = 42;
-	faller->sector->moved = true;
 #undef speed
 #undef direction
 #undef floorwasheight
@@ -801,7 +798,6 @@ void T_BounceCheese(levelspecthink_t *bouncer)
 	for (i = -1; (i = P_FindSectorFromTag(bouncer->sourceline->tag, i)) >= 0 ;)
 	{
 		actionsector = &sectors[i];
-		actionsector->moved = true;
 
 		halfheight = abs(bouncer->sector->ceilingheight - bouncer->sector->floorheight) >> 1;
 
@@ -821,7 +817,6 @@ void T_BounceCheese(levelspecthink_t *bouncer)
 			bouncer->sector->floordata = NULL;
 			bouncer->sector->floorspeed = 0;
 			bouncer->sector->ceilspeed = 0;
-			bouncer->sector->moved = true;
 			P_RemoveThinker(&bouncer->thinker); // remove bouncer from actives
 			return;
 		}
@@ -837,7 +832,6 @@ void T_BounceCheese(levelspecthink_t *bouncer)
 			bouncer->sector->floordata = NULL;
 			bouncer->sector->floorspeed = 0;
 			bouncer->sector->ceilspeed = 0;
-			bouncer->sector->moved = true;
 			P_RemoveThinker(&bouncer->thinker); // remove bouncer from actives
 			return;
 		}
@@ -906,7 +900,6 @@ void T_BounceCheese(levelspecthink_t *bouncer)
 			bouncer->sector->floordata = NULL;
 			bouncer->sector->floorspeed = 0;
 			bouncer->sector->ceilspeed = 0;
-			bouncer->sector->moved = true;
 			P_RemoveThinker(&bouncer->thinker);    // remove bouncer from actives
 		}
 
@@ -1093,14 +1086,12 @@ void T_StartCrumble(elevator_t *elevator)
 		elevator->sector->ceilingdata = NULL;
 		elevator->sector->ceilspeed = 0;
 		elevator->sector->floorspeed = 0;
-		elevator->sector->moved = true;
 		P_RemoveThinker(&elevator->thinker);
 	}
 
 	for (i = -1; (i = P_FindSectorFromTag(elevator->sourceline->tag, i)) >= 0 ;)
 	{
 		sector = &sectors[i];
-		sector->moved = true;
 		P_RecalcPrecipInSector(sector);
 	}
 }
@@ -3027,8 +3018,6 @@ void EV_CrumbleChain(sector_t *sec, ffloor_t *rover)
 
 	// no longer exists (can't collide with again)
 	rover->flags &= ~FF_EXISTS;
-	rover->master->frontsector->moved = true;
-	sec->moved = true;
 }
 
 // Used for bobbing platforms on the water
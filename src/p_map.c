@@ -3396,8 +3396,6 @@ boolean P_CheckSector(sector_t *sector, boolean crunch)
 			for (n = sec->touching_thinglist; n; n = n->m_thinglist_next)
 				n->visited = false;
 
-			sec->moved = true;
-
 			P_RecalcPrecipInSector(sec);
 
 			if (!sector->attachedsolid[i])
@@ -3424,8 +3422,6 @@ boolean P_CheckSector(sector_t *sector, boolean crunch)
 	}
 
 	// Mark all things invalid
-	sector->moved = true;
-
 	for (n = sector->touching_thinglist; n; n = n->m_thinglist_next)
 		n->visited = false;
 
@@ -3502,8 +3498,6 @@ boolean P_CheckSector(sector_t *sector, boolean crunch)
 			for (n = sec->touching_thinglist; n; n = n->m_thinglist_next)
 				n->visited = false;
 
-			sec->moved = true;
-
 			P_RecalcPrecipInSector(sec);
 
 			if (!sector->attachedsolid[i])
@@ -3527,8 +3521,6 @@ boolean P_CheckSector(sector_t *sector, boolean crunch)
 	}
 
 	// Mark all things invalid
-	sector->moved = true;
-
 	for (n = sector->touching_thinglist; n; n = n->m_thinglist_next)
 		n->visited = false;
 
@@ -795,6 +795,8 @@ void P_SetThingPosition(mobj_t *thing)
 	if (thing->player && thing->z <= thing->floorz && thing->subsector)
 		oldsec = thing->subsector->sector;
 
+	P_MobjConsistancy(thing, thing->x - thing->y + thing->z - thing->flags);
+
 	ss = thing->subsector = R_PointInSubsector(thing->x, thing->y);
 
 	if (!(thing->flags & MF_NOSECTOR))
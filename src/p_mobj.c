@@ -42,6 +42,10 @@ consvar_t cv_splats = {"splats", "On", CV_SAVE, CV_OnOff, NULL, 0, NULL, NULL, 0
 
 actioncache_t actioncachehead;
 
+#ifdef MOBJCONSISTANCY
+UINT32 mobjconsistancy = 0; // Running hash of mobj changes, see P_MobjConsistancy
+#endif
+
 static mobj_t *overlaycap = NULL;
 mobj_t *mobjcache = NULL;
 
@@ -368,6 +372,7 @@ boolean P_SetMobjState(mobj_t *mobj, statenum_t state)
 		mobj->sprite = st->sprite;
 		mobj->frame = st->frame;
 		mobj->anim_duration = (UINT16)st->var2; // only used if FF_ANIMATE is set
+		P_MobjConsistancy(mobj, state);
 
 		// Modified handling.
 		// Call action functions when the state is set
@@ -420,6 +425,7 @@ boolean P_SetMobjStateNF(mobj_t *mobj, statenum_t state)
 	mobj->sprite = st->sprite;
 	mobj->frame = st->frame;
 	mobj->anim_duration = (UINT16)st->var2; // only used if FF_ANIMATE is set
+	P_MobjConsistancy(mobj, state);
 
 	return true;
 }
@@ -3747,8 +3753,6 @@ void P_RecalcPrecipInSector(sector_t *sector)
 	if (!sector)
 		return;
 
-	sector->moved = true; // Recalc lighting and things too, maybe
-
 	for (psecnode = sector->touching_preciplist; psecnode; psecnode = psecnode->m_thinglist_next)
 		CalculatePrecipFloor(psecnode->m_thing);
 }
@@ -4436,12 +4440,7 @@ static void P_Boss4DestroyCage(void)
 					if (rover->flags & FF_RENDERALL) // checking for FF_RENDERANY.
 						EV_CrumbleChain(rsec, rover); // This FOF is visible to some extent? Crumble it.
 					else // Completely invisible FOF
-					{
-						// no longer exists (can't collide with again)
-						rover->flags &= ~FF_EXISTS;
-						sector->moved = true;
-						rsec->moved = true;
-					}
+						rover->flags &= ~FF_EXISTS; // no longer exists (can't collide with again)
 				}
 		}
 	}
@@ -6102,9 +6101,10 @@ static void P_KoopaThinker(mobj_t *koopa)
 }
 
 //
-// P_MobjThinker
+// P_MobjThink
+// Does the work of P_MobjThinker.
 //
-void P_MobjThinker(mobj_t *mobj)
+static void P_MobjThink(mobj_t *mobj)
 {
 	I_Assert(mobj != NULL);
 	I_Assert(!P_MobjWasRemoved(mobj)); 
@@ -7495,6 +7495,26 @@ void P_PushableThinker(mobj_t *mobj)
 	}
 }
 
+//
+// P_MobjThinker
+//
+void P_MobjThinker(mobj_t *mobj)
+{
+	P_MobjThink(mobj);
+
+#ifdef MOBJCONSISTANCY
+	// Z movement, and the many direct writes to momentum, flags and
+	// target/tracer, never pass through the setters that fold into the
+	// hash. Fold in where the mobj ended up, once per tic.
+	if (!P_MobjWasRemoved(mobj))
+		P_MobjConsistancy(mobj, mobj->x - mobj->y + mobj->z
+			- mobj->momx + mobj->momy - mobj->momz
+			+ mobj->flags - mobj->flags2 + mobj->eflags
+			+ (mobj->target ? mobj->target->type : 0)
+			- (mobj->tracer ? mobj->tracer->type : 0));
+#endif
+}
+
 // Quick, optimized function for scenery
 void P_SceneryThinker(mobj_t *mobj)
 {
@@ -7798,6 +7818,7 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
 	if (CheckForReverseGravity && !(mobj->flags & MF_NOBLOCKMAP))
 		P_CheckGravity(mobj, false); 
     	
+	P_MobjConsistancy(mobj, mobj->state - states);
 	R_AddMobjInterpolator(mobj);
 
 
@@ -7883,6 +7904,8 @@ void P_RemoveMobj(mobj_t *mobj)
 	if (P_MobjWasRemoved(mobj))
 		return; // something already removing this mobj.
 
+	P_MobjConsistancy(mobj, 0xCCCC);
+
 	mobj->thinker.function.acp1 = (actionf_p1)P_RemoveThinkerDelayed; // shh. no recursing.
 	LUAh_MobjRemoved(mobj);
 	mobj->thinker.function.acp1 = (actionf_p1)P_MobjThinker; // needed for P_UnsetThingPosition, etc. to work.
@@ -462,6 +462,22 @@ void P_SetScale(mobj_t *mobj, fixed_t newscale);
 void P_XYMovement(mobj_t *mo);
 void P_EmeraldManager(void);
 
+#ifdef MOBJCONSISTANCY
+// Mobjs that count towards the consistancy check
+#define MF_CONSISTANCY (MF_SPECIAL|MF_SOLID|MF_PUSHABLE|MF_BOSS|MF_MISSILE|MF_SPRING|MF_MONITOR|MF_FIRE|MF_ENEMY|MF_PAIN|MF_STICKY)
+
+extern UINT32 mobjconsistancy;
+
+// Folds a change to a mobj into the running consistancy hash
+FUNCINLINE static ATTRINLINE void P_MobjConsistancy(const mobj_t *mo, UINT32 value)
+{
+	if (mo->flags & MF_CONSISTANCY)
+		mobjconsistancy = mobjconsistancy*31 + mo->type + value;
+}
+#else
+#define P_MobjConsistancy(mo, value)
+#endif
+
 #define MAXHUNTEMERALDS 64
 extern mapthing_t *huntemeralds[MAXHUNTEMERALDS];
 extern INT32 numhuntemeralds;
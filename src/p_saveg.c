@@ -3071,6 +3071,11 @@ static inline void P_NetArchiveSpecials(void)
 	}
 	else
 		WRITEUINT8(save_p, 0x00);
+
+#ifdef MOBJCONSISTANCY
+	// Mobj changes hashed so far, for the consistancy check to carry on from
+	WRITEUINT32(save_p, mobjconsistancy);
+#endif
 }
 
 //
@@ -3113,6 +3118,11 @@ static void P_NetUnArchiveSpecials(void)
 
 	if (READUINT8(save_p) == 0x01) // metal sonic
 		G_LoadMetal(&save_p);
+
+#ifdef MOBJCONSISTANCY
+	// Overrides what loading the thinkers hashed
+	mobjconsistancy = READUINT32(save_p);
+#endif
 }
 
 // =======================================================================
@@ -716,7 +716,6 @@ static void P_LoadRawSectors(UINT8 *data, size_t i)
 		ss->attachedsolid = NULL;
 		ss->numattached = 0;
 		ss->maxattached = 1;
-		ss->moved = true;
 
 		ss->extra_colormap = NULL;
 
@@ -183,6 +183,9 @@ void Command_CountMobjs_f(void)
 void P_InitThinkers(void)
 {
 	thinkercap.prev = thinkercap.next = &thinkercap;
+#ifdef MOBJCONSISTANCY
+	mobjconsistancy = 0; // New mobjs, new hash
+#endif
 }
 
 //
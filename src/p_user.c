@@ -77,6 +77,8 @@ void P_Thrust(mobj_t *mo, angle_t angle, fixed_t move)
 
 	if (!(twodlevel || (mo->flags2 & MF2_TWOD)))
 		mo->momy += FixedMul(move, FINESINE(angle));
+
+	P_MobjConsistancy(mo, mo->momx - mo->momy);
 }
 
 #if 0
@@ -134,6 +136,8 @@ void P_InstaThrust(mobj_t *mo, angle_t angle, fixed_t move)
 
 	if (!(twodlevel || (mo->flags2 & MF2_TWOD)))
 		mo->momy = FixedMul(move,FINESINE(angle));
+
+	P_MobjConsistancy(mo, mo->momx - mo->momy);
 }
 
 void P_InstaThrustEvenIn2D(mobj_t *mo, angle_t angle, fixed_t move)
@@ -142,6 +146,8 @@ void P_InstaThrustEvenIn2D(mobj_t *mo, angle_t angle, fixed_t move)
 
 	mo->momx = FixedMul(move, FINECOSINE(angle));
 	mo->momy = FixedMul(move, FINESINE(angle));
+
+	P_MobjConsistancy(mo, mo->momx - mo->momy);
 }
 
 // Returns a location (hard to explain - go see how it is used)
@@ -1296,6 +1302,8 @@ void P_SetObjectMomZ(mobj_t *mo, fixed_t value, boolean relative)
 		mo->momz += value;
 	else
 		mo->momz = value;
+
+	P_MobjConsistancy(mo, mo->momz);
 }
 
 //
@@ -52,6 +52,180 @@ void R_ClearDrawSegs(void)
 static cliprange_t *newend;
 static cliprange_t solidsegs[MAXSEGS];
 
+// Column coverage, mirrors solidsegs.
+// One bit per screen column, plus a summary level with one bit per
+// completely covered word, so occlusion queries never walk the clip list.
+#define COVERBITS 32
+#define COVERWORDS ((MAXVIDWIDTH + COVERBITS - 1) / COVERBITS)
+#define COVERSUMMARY ((COVERWORDS + COVERBITS - 1) / COVERBITS)
+#define COVERMASK(lo, hi) ((UINT32)(0xFFFFFFFFu >> (COVERBITS - 1 - ((hi) - (lo)))) << (lo))
+
+static UINT32 solidcols[COVERWORDS];
+static UINT32 solidsummary[COVERSUMMARY];
+static INT32 solidwords; // number of words spanning the view
+static INT32 solidfullwords; // number of those that are completely covered
+
+// Sets the coverage bits of [first, last] inside a single bitset.
+// Returns the number of words that became completely covered.
+static INT32 R_SetCoverBits(UINT32 *bits, INT32 first, INT32 last)
+{
+	INT32 w1 = first / COVERBITS, w2 = last / COVERBITS;
+	INT32 w, filled = 0;
+
+	for (w = w1; w <= w2; w++)
+	{
+		INT32 lo = (w == w1) ? first % COVERBITS : 0;
+		INT32 hi = (w == w2) ? last % COVERBITS : COVERBITS - 1;
+		UINT32 old = bits[w];
+
+		bits[w] |= COVERMASK(lo, hi);
+		if (old != 0xFFFFFFFFu && bits[w] == 0xFFFFFFFFu)
+		{
+			solidsummary[w / COVERBITS] |= 1u << (w % COVERBITS);
+			filled++;
+		}
+	}
+
+	return filled;
+}
+
+// Marks columns [first, last] as occluded.
+static void R_MarkSolidColumns(INT32 first, INT32 last)
+{
+	if (first < 0)
+		first = 0;
+	if (last >= viewwidth)
+		last = viewwidth - 1;
+	if (first > last)
+		return;
+
+	solidfullwords += R_SetCoverBits(solidcols, first, last);
+}
+
+// Are the bits of [first, last] that fall in its first and last word set?
+static inline boolean R_CoverEndBitsSet(const UINT32 *bits, INT32 first, INT32 last)
+{
+	INT32 w1 = first / COVERBITS, w2 = last / COVERBITS;
+	UINT32 mask;
+
+	if (w1 == w2)
+	{
+		mask = COVERMASK(first % COVERBITS, last % COVERBITS);
+		return (bits[w1] & mask) == mask;
+	}
+
+	mask = COVERMASK(first % COVERBITS, COVERBITS - 1);
+	if ((bits[w1] & mask) != mask)
+		return false;
+
+	mask = COVERMASK(0, last % COVERBITS);
+	if ((bits[w2] & mask) != mask)
+		return false;
+
+	return true;
+}
+
+// Are all bits of [first, last] set in a single bitset?
+static inline boolean R_CoverBitsSet(const UINT32 *bits, INT32 first, INT32 last)
+{
+	INT32 w;
+
+	if (!R_CoverEndBitsSet(bits, first, last))
+		return false;
+
+	for (w = first / COVERBITS + 1; w < last / COVERBITS; w++)
+		if (bits[w] != 0xFFFFFFFFu)
+			return false;
+
+	return true;
+}
+
+#ifdef PARANOIA
+// The column by column answer R_IsRangeOccluded has to agree with
+static boolean R_IsRangeOccludedSlow(INT32 first, INT32 last)
+{
+	for (; first <= last; first++)
+		if (!(solidcols[first / COVERBITS] & (1u << (first % COVERBITS))))
+			return false;
+	return true;
+}
+#endif
+
+// R_IsRangeOccluded for a range already clipped to the view
+static boolean R_IsClippedRangeOccluded(INT32 first, INT32 last)
+{
+	INT32 w1, w2;
+
+	if (!R_CoverEndBitsSet(solidcols, first, last))
+		return false;
+
+	// The end words are covered, check the whole words in between
+	// through the summary level.
+	w1 = first / COVERBITS + 1;
+	w2 = last / COVERBITS - 1;
+	if (w1 > w2)
+		return true;
+
+	return R_CoverBitsSet(solidsummary, w1, w2);
+}
+
+//
+// R_IsRangeOccluded
+// Returns true if every column in [first, last] is already covered
+// by a solid wall. Columns outside the view count as covered.
+//
+static boolean R_IsRangeOccluded(INT32 first, INT32 last)
+{
+	boolean occluded;
+
+	if (first < 0)
+		first = 0;
+	if (last >= viewwidth)
+		last = viewwidth - 1;
+	if (first > last)
+		return true;
+
+	occluded = R_IsClippedRangeOccluded(first, last);
+#ifdef PARANOIA
+	if (occluded != R_IsRangeOccludedSlow(first, last))
+		I_Error("R_IsRangeOccluded: columns %d-%d are %s, but the bitset says otherwise",
+			first, last, occluded ? "open" : "covered");
+#endif
+	return occluded;
+}
+
+// Resets the coverage so that only [start, end) is open.
+static void R_ClearCoverage(INT32 start, INT32 end)
+{
+	INT32 pad;
+
+	memset(solidcols, 0, sizeof(solidcols));
+	memset(solidsummary, 0, sizeof(solidsummary));
+
+	solidwords = (viewwidth + COVERBITS - 1) / COVERBITS;
+	solidfullwords = 0;
+
+	// Pad the last word, so the screen edge doesn't keep it from filling up.
+	pad = solidwords * COVERBITS - 1;
+	if (pad >= viewwidth)
+		solidfullwords += R_SetCoverBits(solidcols, viewwidth, pad);
+
+	if (start > 0)
+		R_MarkSolidColumns(0, start - 1);
+	if (end < viewwidth)
+		R_MarkSolidColumns(end, viewwidth - 1);
+}
+
+//
+// R_ScreenFullyOccluded
+// True once solid walls cover every column of the view,
+// past that point nothing further down the BSP can be seen.
+//
+static inline boolean R_ScreenFullyOccluded(void)
+{
+	return solidfullwords >= solidwords;
+}
+
 //
 // R_ClipSolidWallSegment
 // Does handle solid walls,
@@ -63,6 +237,12 @@ static void R_ClipSolidWallSegment(INT32 first, INT32 last)
 	cliprange_t *next;
 	cliprange_t *start;
 
+	// Already hidden behind other solid walls?
+	if (R_IsRangeOccluded(first, last))
+		return;
+
+	R_MarkSolidColumns(first, last);
+
 	// Find the first range that touches the range (adjacent pixels are touching).
 	start = solidsegs;
 	while (start->last < first - 1)
@@ -145,6 +325,9 @@ static inline void R_ClipPassWallSegment(INT32 first, INT32 last)
 {
 	cliprange_t *start;
 
+	if (R_IsRangeOccluded(first, last))
+		return;
+
 	// Find the first range that touches the range
 	//  (adjacent pixels are touching).
 	start = solidsegs;
@@ -192,6 +375,7 @@ void R_ClearClipSegs(void)
 	solidsegs[1].first = viewwidth;
 	solidsegs[1].last = 0x7fffffff;
 	newend = solidsegs + 2;
+	R_ClearCoverage(0, viewwidth);
 }
 void R_PortalClearClipSegs(INT32 start, INT32 end)
 {
@@ -200,6 +384,7 @@ void R_PortalClearClipSegs(INT32 start, INT32 end)
 	solidsegs[1].first = end;
 	solidsegs[1].last = 0x7fffffff;
 	newend = solidsegs + 2;
+	R_ClearCoverage(start, end);
 }
 
 
@@ -591,7 +776,6 @@ static boolean R_CheckBBox(const fixed_t *bspcoord)
 	angle_t angle1, angle2;
 	INT32 sx1, sx2, boxpos;
 	const INT32* check;
-	cliprange_t *start;
 
 	// Find the corners of the box that define the edges from current viewpoint.
 	if ((boxpos = (viewx <= bspcoord[BOXLEFT] ? 0 : viewx < bspcoord[BOXRIGHT] ? 1 : 2) + (viewy >= bspcoord[BOXTOP] ? 0 : viewy > bspcoord[BOXBOTTOM] ? 4 : 8)) == 5)
@@ -625,12 +809,8 @@ static boolean R_CheckBBox(const fixed_t *bspcoord)
 	// Does not cross a pixel.
 	if (sx1 >= sx2) return false;
 
-	start = solidsegs;
-	while (start->last < sx2)
-		start++;
-
-	if (sx1 >= start->first && sx2 <= start->last)
-		return false; // The clippost contains the new span.
+	if (R_IsRangeOccluded(sx1, sx2))
+		return false; // The clipposts contain the new span.
 
 	return true;
 }
@@ -850,27 +1030,11 @@ static void R_Subsector(size_t num)
 	// Check and prep all 3D floors. Set the sector floor/ceiling light levels and colormaps.
 	if (frontsector->ffloors)
 	{
-		boolean anyMoved = frontsector->moved;
-		if (anyMoved == false)
-		{
-			for (rover = frontsector->ffloors; rover; rover = rover->next)
-			{
-				sector_t *controlSec = &sectors[rover->secnum];
-				if (controlSec->moved == true)
-				{
-					anyMoved = true;
-					break;
-				}
-			}
-		}
-		if (anyMoved == true)
-		{
-			frontsector->numlights = sub->sector->numlights = 0;
-			R_Prep3DFloors(frontsector);
-			sub->sector->lightlist = frontsector->lightlist;
-			sub->sector->numlights = frontsector->numlights;
-			sub->sector->moved = frontsector->moved = false;
-		}
+		R_Prep3DFloors(frontsector);
+		sub->sector->lightlist = frontsector->lightlist;
+		sub->sector->numlights = frontsector->numlights;
+		sub->sector->lightlistkey = frontsector->lightlistkey;
+		sub->sector->lightlistframe = frontsector->lightlistframe;
 
 		light = R_GetPlaneLight(frontsector, floorcenterz, false);
 		if (frontsector->floorlightsec == -1)
@@ -1138,11 +1302,48 @@ static void R_Subsector(size_t num)
 	}
 }
 
+// Mixes everything R_Prep3DFloors builds a sector's light list from into
+// one number: the heights it sorts by, the FOF flags, slopes and colormaps.
+// Walking the FOFs once for this is much cheaper than the sort, and it
+// catches every way those can change, movers, executors and Lua alike.
+static UINT32 R_LightListKey(sector_t *sector)
+{
+	ffloor_t *rover;
+	sector_t *sec;
+	UINT32 key = 2166136261u;
+
+#define MIXKEY(v) (key = ((key ^ (UINT32)(v)) * 16777619u) ^ (key >> 15))
+	MIXKEY(sector->c_slope ? P_GetZAt(sector->c_slope, sector->soundorg.x, sector->soundorg.y) : sector->ceilingheight);
+	MIXKEY((size_t)sector->c_slope);
+	MIXKEY((size_t)sector->extra_colormap);
+
+	for (rover = sector->ffloors; rover; rover = rover->next)
+	{
+		MIXKEY(rover->flags);
+		if (!(rover->flags & FF_EXISTS))
+			continue;
+
+		MIXKEY(*rover->t_slope ? P_GetZAt(*rover->t_slope, sector->soundorg.x, sector->soundorg.y) : *rover->topheight);
+		MIXKEY(*rover->b_slope ? P_GetZAt(*rover->b_slope, sector->soundorg.x, sector->soundorg.y) : *rover->bottomheight);
+		MIXKEY((size_t)*rover->t_slope);
+		MIXKEY((size_t)*rover->b_slope);
+		MIXKEY((size_t)rover->toplightlevel);
+
+		sec = &sectors[rover->secnum];
+		MIXKEY(sec->midmap);
+		MIXKEY(sec->midmap >= 0 && (size_t)sec->midmap < num_extra_colormaps);
+	}
+#undef MIXKEY
+
+	return key;
+}
+
 //
 // R_Prep3DFloors
 //
 // This function creates the lightlists that the given sector uses to light
 // floors/ceilings/walls according to the 3D floors.
+// The list is kept from frame to frame until something it depends on changes.
 void R_Prep3DFloors(sector_t *sector)
 {
 	ffloor_t *rover;
@@ -1153,7 +1354,17 @@ void R_Prep3DFloors(sector_t *sector)
 	pslope_t *bestslope = NULL;
 	fixed_t heighttest; // I think it's better to check the Z height at the sector's center
 	                    // than assume unsloped heights are accurate indicators of order in sloped sectors. -Red
+	UINT32 key;
+
+	// nothing it depends on changes during a frame
+	if (sector->lightlist && sector->lightlistframe == framecount)
+		return;
+	sector->lightlistframe = framecount;
 
+	key = R_LightListKey(sector);
+	if (sector->lightlist && sector->lightlistkey == key)
+		return;
+	sector->lightlistkey = key;
 
 	count = 1;
 	for (rover = sector->ffloors; rover; rover = rover->next)
@@ -1307,6 +1518,10 @@ void R_RenderBSPNode(INT32 bspnum)
 
 	while (!(bspnum & NF_SUBSECTOR))  // Found a subsector?
 	{
+		// Every column is behind a solid wall, nothing left to draw.
+		if (R_ScreenFullyOccluded())
+			return;
+
 		bsp = &nodes[bspnum];
 
 		// Decide which side the view point is on.
@@ -100,6 +100,7 @@ INT32 numtextures = 0; // total number of textures found,
 texture_t **textures = NULL;
 static UINT32 **texturecolumnofs; // column offset lookup table for each texture
 static UINT8 **texturecache; // graphics data for each generated full-size texture
+static UINT8 **texturemipcache; // downsampled copies, (MIPLEVELS-1) per texture
 
 // texture width is a power of 2, so it can easily repeat along sidedefs using a simple mask
 INT32 *texturewidthmask;
@@ -352,6 +353,260 @@ UINT8 *R_GetFlat(lumpnum_t flatlumpnum)
 	return W_CacheLumpNum(flatlumpnum, PU_CACHE);
 }
 
+// ==========================================================================
+//                                MIPMAPS
+// ==========================================================================
+//
+// Software mipmaps are built lazily, the first time a surface is drawn far
+// enough away to need them. Each level halves both dimensions; texels are
+// averaged in RGB through the current palette and quantised back with
+// NearestColor. In textures built from patches, transparent pixels (0xF7)
+// only win when they make up at least half of the source block, so holes
+// don't bleed into solid areas. Flats are opaque, 0xF7 is just a colour there.
+//
+
+#define MIPTRANSPARENT 0xF7 // TRANSPARENTPIXEL
+
+consvar_t cv_mipmapping = {"mipmapping", "On", CV_SAVE, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
+
+static UINT8 R_MipTexel(UINT8 a, UINT8 b, UINT8 c, UINT8 d, boolean transparent)
+{
+	const UINT8 texels[4] = {a, b, c, d};
+	UINT32 r = 0, g = 0, bl = 0, n = 0;
+	INT32 i;
+
+	if (a == b && b == c && c == d)
+		return a;
+
+	for (i = 0; i < 4; i++)
+	{
+		if (transparent && texels[i] == MIPTRANSPARENT)
+			continue;
+		r += pLocalPalette[texels[i]].s.red;
+		g += pLocalPalette[texels[i]].s.green;
+		bl += pLocalPalette[texels[i]].s.blue;
+		n++;
+	}
+
+	if (n <= 2) // two or more transparent texels
+		return MIPTRANSPARENT;
+
+	return NearestColor((UINT8)(r/n), (UINT8)(g/n), (UINT8)(bl/n));
+}
+
+//
+// R_TextureMipLevels
+// How many levels, including the full size one, a texture can use.
+// Only composite (hole-free) textures are mipmapped, and only as far as
+// the dimensions stay divisible so tiling isn't disturbed.
+//
+INT32 R_TextureMipLevels(INT32 tex)
+{
+	texture_t *texture = textures[tex];
+	INT32 levels = 1;
+
+	if (!texturecache[tex])
+		R_GenerateTexture(tex);
+
+	if (texture->holes)
+		return 1;
+
+	while (levels < MIPLEVELS
+		&& !(texture->height & ((1 << levels) - 1))
+		&& ((texturewidthmask[tex] + 1) >> levels) > 0)
+		levels++;
+
+	return levels;
+}
+
+static UINT8 *R_GenerateTextureMipmap(INT32 tex, INT32 level)
+{
+	texture_t *texture = textures[tex];
+	const INT32 srcheight = texture->height >> (level - 1);
+	const INT32 width = texture->width >> level, height = texture->height >> level;
+	UINT8 *block, *src, *lock;
+	INT32 x, y, locktag;
+
+	// Lock the level we read from, the allocation below may purge it.
+	if (level == 1)
+	{
+		if (!texturecache[tex])
+			R_GenerateTexture(tex);
+		lock = texturecache[tex];
+		src = lock + (texture->width*4); // skip the column lookup table
+	}
+	else
+	{
+		src = texturemipcache[tex*(MIPLEVELS-1) + level-2];
+		if (!src)
+			src = R_GenerateTextureMipmap(tex, level - 1);
+		lock = src;
+	}
+	locktag = Z_GetTag(lock);
+	Z_ChangeTag(lock, PU_STATIC);
+
+	block = Z_Malloc(width * height, PU_STATIC, &texturemipcache[tex*(MIPLEVELS-1) + level-1]);
+
+	// Composite textures are stored column after column.
+	for (x = 0; x < width; x++)
+	{
+		const UINT8 *c1 = src + (2*x) * srcheight;
+		const UINT8 *c2 = c1 + srcheight;
+		UINT8 *dest = block + x * height;
+
+		for (y = 0; y < height; y++)
+			dest[y] = R_MipTexel(c1[2*y], c1[2*y+1], c2[2*y], c2[2*y+1], true);
+	}
+
+	Z_ChangeTag(lock, locktag); // The caller may have it locked too
+	Z_ChangeTag(block, PU_CACHE);
+	return block;
+}
+
+//
+// R_GetColumnMipmap
+// Same as R_GetColumn, but from the given mip level.
+// Callers must scale their vertical coordinates down by the same level.
+//
+UINT8 *R_GetColumnMipmap(fixed_t tex, INT32 col, INT32 level)
+{
+	UINT8 *data;
+
+	if (!level)
+		return R_GetColumn(tex, col);
+
+	col = (col & texturewidthmask[tex]) >> level;
+	data = texturemipcache[tex*(MIPLEVELS-1) + level-1];
+
+	if (!data)
+		data = R_GenerateTextureMipmap(tex, level);
+
+	return data + col * (textures[tex]->height >> level);
+}
+
+// Flat mipmaps are looked up by lump.
+#define FLATMIPHASHSIZE 256
+
+typedef struct flatmip_s
+{
+	lumpnum_t lumpnum;
+	UINT8 *mips[MIPLEVELS-1];
+	struct flatmip_s *next;
+} flatmip_t;
+
+static flatmip_t *flatmiphash[FLATMIPHASHSIZE];
+
+static flatmip_t *R_FindFlatMip(lumpnum_t flatlumpnum)
+{
+	const UINT32 hash = ((UINT32)flatlumpnum * 2654435761u) >> 24;
+	flatmip_t *entry;
+
+	for (entry = flatmiphash[hash]; entry; entry = entry->next)
+		if (entry->lumpnum == flatlumpnum)
+			return entry;
+
+	entry = Z_Calloc(sizeof (*entry), PU_STATIC, NULL);
+	entry->lumpnum = flatlumpnum;
+	entry->next = flatmiphash[hash];
+	flatmiphash[hash] = entry;
+	return entry;
+}
+
+//
+// R_GetFlatMipmap
+// Returns level 'level' of a square flat that is 1<<flatbits texels wide.
+// 'base' is the full size flat, which the caller keeps locked.
+//
+UINT8 *R_GetFlatMipmap(lumpnum_t flatlumpnum, UINT8 *base, INT32 flatbits, INT32 level)
+{
+	flatmip_t *entry;
+	UINT8 *src, *block;
+	INT32 size, srcsize, x, y, srctag = PU_STATIC;
+
+	if (!level)
+		return base;
+
+	entry = R_FindFlatMip(flatlumpnum);
+	if (entry->mips[level-1])
+		return entry->mips[level-1];
+
+	// Lock the level we read from, the allocation below may purge it.
+	src = R_GetFlatMipmap(flatlumpnum, base, flatbits, level - 1);
+	if (level > 1)
+	{
+		srctag = Z_GetTag(src);
+		Z_ChangeTag(src, PU_STATIC);
+	}
+
+	srcsize = 1 << (flatbits - level + 1);
+	size = srcsize >> 1;
+	block = Z_Malloc(size * size, PU_STATIC, &entry->mips[level-1]);
+
+	// Flats are stored row after row.
+	for (y = 0; y < size; y++)
+	{
+		const UINT8 *r1 = src + (2*y) * srcsize;
+		const UINT8 *r2 = r1 + srcsize;
+		UINT8 *dest = block + y * size;
+
+		for (x = 0; x < size; x++)
+			dest[x] = R_MipTexel(r1[2*x], r1[2*x+1], r2[2*x], r2[2*x+1], false);
+	}
+
+	if (level > 1)
+		Z_ChangeTag(src, srctag); // The caller may have it locked too
+	Z_ChangeTag(block, PU_CACHE);
+	return block;
+}
+
+//
+// R_MipmapMemory
+// Memory used by the mipmaps that haven't been purged yet.
+// They're purgable, so this is counted when asked for rather than kept.
+//
+static void R_MipmapMemory(size_t *flatmips, size_t *texturemips)
+{
+	INT32 i, j;
+
+	*flatmips = *texturemips = 0;
+
+	for (i = 0; i < FLATMIPHASHSIZE; i++)
+	{
+		flatmip_t *entry;
+		for (entry = flatmiphash[i]; entry; entry = entry->next)
+			for (j = 0; j < MIPLEVELS-1; j++)
+				if (entry->mips[j])
+					*flatmips += Z_BlockSize(entry->mips[j]);
+	}
+
+	if (texturemipcache)
+		for (i = 0; i < numtextures*(MIPLEVELS-1); i++)
+			if (texturemipcache[i])
+				*texturemips += Z_BlockSize(texturemipcache[i]);
+}
+
+//
+// R_FlushMipmaps
+// Throws away every mipmap, they are rebuilt on demand.
+// Needed when the palette they were quantised against changes.
+//
+void R_FlushMipmaps(void)
+{
+	INT32 i, j;
+
+	for (i = 0; i < FLATMIPHASHSIZE; i++)
+	{
+		flatmip_t *entry;
+		for (entry = flatmiphash[i]; entry; entry = entry->next)
+			for (j = 0; j < MIPLEVELS-1; j++)
+				Z_Free(entry->mips[j]);
+	}
+
+	if (texturemipcache)
+		for (i = 0; i < numtextures*(MIPLEVELS-1); i++)
+			Z_Free(texturemipcache[i]);
+}
+
 //
 // Empty the texture cache (used for load wad at runtime)
 //
@@ -359,6 +614,8 @@ void R_FlushTextureCache(void)
 {
 	INT32 i;
 
+	R_FlushMipmaps();
+
 	if (numtextures)
 		for (i = 0; i < numtextures; i++)
 			Z_Free(texturecache[i]);
@@ -386,11 +643,13 @@ void R_LoadTextures(void)
 	// Free previous memory before numtextures change.
 	if (numtextures)
 	{
+		R_FlushMipmaps();
 		for (i = 0; i < numtextures; i++)
 		{
 			Z_Free(textures[i]);
 			Z_Free(texturecache[i]);
 		}
+		Z_Free(texturemipcache);
 		Z_Free(texturetranslation);
 		Z_Free(textures);
 	}
@@ -464,6 +723,8 @@ void R_LoadTextures(void)
 	textureheight    = (void *)((UINT8 *)textures + ((numtextures * sizeof(void *)) * 4));
 	// Create translation table for global animation.
 	texturetranslation = Z_Malloc((numtextures + 1) * sizeof(*texturetranslation), PU_STATIC, NULL);
+	// Allocate mipmap referencing cache.
+	texturemipcache = Z_Calloc(numtextures * (MIPLEVELS-1) * sizeof(*texturemipcache), PU_STATIC, NULL);
 
 	for (i = 0; i < numtextures; i++)
 		texturetranslation[i] = i;
@@ -1101,6 +1362,46 @@ void R_ReInitColormaps(UINT16 num)
 
 static lumpnum_t foundcolormaps[MAXCOLORMAPS];
 
+// Extra colormaps are found by hashing what they were made from, the lump
+// for COLORMAP lumps and the mask, fade and fog settings for generated ones.
+// Chains link through colormapnext and end at -1.
+#define COLORMAPHASHSIZE 64
+
+static INT32 colormaphash[COLORMAPHASHSIZE];
+static INT32 colormapnext[MAXCOLORMAPS];
+
+// What a generated colormap's lighting table is built from. The table is
+// only built when the software renderer first needs it, see
+// R_GenerateExtraColormaps.
+typedef struct
+{
+	double cmaskr, cmaskg, cmaskb, othermask;
+	double cdestr, cdestg, cdestb;
+	UINT32 fadestart, fadedist;
+} colormapsource_t;
+
+static colormapsource_t colormapsources[MAXCOLORMAPS];
+static size_t numgeneratedcolormaps; // extra colormaps up to here have their tables
+
+ps_metric_t ps_colormapscreated = {0};
+ps_metric_t ps_colormapsreused = {0};
+
+static UINT32 R_HashColormap(UINT32 maskcolor, UINT32 fadecolor, UINT32 fadestart, UINT32 fadeend, INT32 fog)
+{
+	UINT32 hash = maskcolor * 31u + fadecolor;
+	hash = hash * 31u + fadestart;
+	hash = hash * 31u + fadeend;
+	hash = hash * 31u + (UINT32)fog;
+	return (hash ^ (hash >> 12)) & (COLORMAPHASHSIZE-1);
+}
+
+static void R_LinkColormap(size_t mapnum, UINT32 hash)
+{
+	colormapnext[mapnum] = colormaphash[hash];
+	colormaphash[hash] = (INT32)mapnum;
+	ps_colormapscreated.value.i++;
+}
+
 //
 // R_ClearColormaps
 //
@@ -1111,16 +1412,24 @@ void R_ClearColormaps(void)
 	size_t i;
 
 	num_extra_colormaps = 0;
+	numgeneratedcolormaps = 0;
 
 	for (i = 0; i < MAXCOLORMAPS; i++)
 		foundcolormaps[i] = LUMPERROR;
 
+	for (i = 0; i < COLORMAPHASHSIZE; i++)
+		colormaphash[i] = -1;
+
+	ps_colormapscreated.value.i = ps_colormapsreused.value.i = 0;
+
 	memset(extra_colormaps, 0, sizeof (extra_colormaps));
 }
 
 INT32 R_ColormapNumForName(char *name)
 {
-	lumpnum_t lump, i;
+	lumpnum_t lump;
+	UINT32 hash;
+	INT32 i;
 
 	if (num_extra_colormaps == MAXCOLORMAPS)
 		I_Error("R_ColormapNumForName: Too many colormaps! the limit is %d\n", MAXCOLORMAPS);
@@ -1129,11 +1438,16 @@ INT32 R_ColormapNumForName(char *name)
 	if (lump == LUMPERROR)
 		I_Error("R_ColormapNumForName: Cannot find colormap lump %.8s\n", name);
 
-	for (i = 0; i < num_extra_colormaps; i++)
+	hash = (lump ^ (lump >> 16)) & (COLORMAPHASHSIZE-1);
+	for (i = colormaphash[hash]; i != -1; i = colormapnext[i])
 		if (lump == foundcolormaps[i])
+		{
+			ps_colormapsreused.value.i++;
 			return i;
+		}
 
 	foundcolormaps[num_extra_colormaps] = lump;
+	R_LinkColormap(num_extra_colormaps, hash);
 
 	// aligned on 8 bit for asm code
 	extra_colormaps[num_extra_colormaps].colormap = Z_MallocAlign(W_LumpLength(lump), PU_LEVEL, NULL, 16);
@@ -1171,8 +1485,8 @@ INT32 R_CreateColormap(char *p1, char *p2, char *p3)
 	double maskamt = 0, othermask = 0;
 	int mask, fog = 0;
 	size_t mapnum = num_extra_colormaps;
-	size_t i;
-	UINT32 cr, cg, cb, maskcolor, fadecolor;
+	UINT32 cr, cg, cb, maskcolor, fadecolor, hash;
+	INT32 i;
 	UINT32 fadestart = 0, fadeend = 31, fadedist = 31;
 
 #define HEX2INT(x) (UINT32)(x >= '0' && x <= '9' ? x - '0' : x >= 'a' && x <= 'f' ? x - 'a' + 10 : x >= 'A' && x <= 'F' ? x - 'A' + 10 : 0)
@@ -1234,7 +1548,8 @@ INT32 R_CreateColormap(char *p1, char *p2, char *p3)
 		cdestr = cdestg = cdestb = fadecolor = 0;
 #undef HEX2INT
 
-	for (i = 0; i < num_extra_colormaps; i++)
+	hash = R_HashColormap(maskcolor, fadecolor, fadestart, fadeend, fog);
+	for (i = colormaphash[hash]; i != -1; i = colormapnext[i])
 	{
 		if (foundcolormaps[i] != LUMPERROR)
 			continue;
@@ -1245,7 +1560,8 @@ INT32 R_CreateColormap(char *p1, char *p2, char *p3)
 			&& fadeend == extra_colormaps[i].fadeend
 			&& fog == extra_colormaps[i].fog)
 		{
-			return (INT32)i;
+			ps_colormapsreused.value.i++;
+			return i;
 		}
 	}
 
@@ -1255,8 +1571,9 @@ INT32 R_CreateColormap(char *p1, char *p2, char *p3)
 	num_extra_colormaps++;
 
 	foundcolormaps[mapnum] = LUMPERROR;
+	R_LinkColormap(mapnum, hash);
 
-	// aligned on 8 bit for asm code
+	// The software renderer builds its lighting table before the next view, see R_GenerateExtraColormaps
 	extra_colormaps[mapnum].colormap = NULL;
 	extra_colormaps[mapnum].maskcolor = (UINT16)maskcolor;
 	extra_colormaps[mapnum].fadecolor = (UINT16)fadecolor;
@@ -1265,79 +1582,182 @@ INT32 R_CreateColormap(char *p1, char *p2, char *p3)
 	extra_colormaps[mapnum].fadeend = (UINT16)fadeend;
 	extra_colormaps[mapnum].fog = fog;
 
-	// This code creates the colormap array used by software renderer
-	if (rendermode == render_soft)
+	colormapsources[mapnum].cmaskr = cmaskr;
+	colormapsources[mapnum].cmaskg = cmaskg;
+	colormapsources[mapnum].cmaskb = cmaskb;
+	colormapsources[mapnum].othermask = othermask;
+	colormapsources[mapnum].cdestr = cdestr;
+	colormapsources[mapnum].cdestg = cdestg;
+	colormapsources[mapnum].cdestb = cdestb;
+	colormapsources[mapnum].fadestart = fadestart;
+	colormapsources[mapnum].fadedist = fadedist;
+
+	return (INT32)mapnum;
+}
+
+// Builds the software lighting table of a colormap made by R_CreateColormap.
+static void R_GenerateColormap(size_t mapnum)
+{
+	const colormapsource_t *src = &colormapsources[mapnum];
+	const double cdestr = src->cdestr, cdestg = src->cdestg, cdestb = src->cdestb;
+	double r, g, b, cbrightness;
+	int p;
+	size_t i;
+	char *colormap_p;
+
+	// Initialise the map and delta arrays
+	// map[i] stores an RGB color (as double) for index i,
+	//  which is then converted to SRB2's palette later
+	// deltas[i] stores a corresponding fade delta between the RGB color and the final fade color;
+	//  map[i]'s values are decremented by after each use
+	for (i = 0; i < 256; i++)
 	{
-		double r, g, b, cbrightness;
-		int p;
-		char *colormap_p;
+		r = pLocalPalette[i].s.red;
+		g = pLocalPalette[i].s.green;
+		b = pLocalPalette[i].s.blue;
+		cbrightness = sqrt((r*r) + (g*g) + (b*b));
+
+		map[i][0] = (cbrightness * src->cmaskr) + (r * src->othermask);
+		if (map[i][0] > 255.0l)
+			map[i][0] = 255.0l;
+		deltas[i][0] = (map[i][0] - cdestr) / (double)src->fadedist;
+
+		map[i][1] = (cbrightness * src->cmaskg) + (g * src->othermask);
+		if (map[i][1] > 255.0l)
+			map[i][1] = 255.0l;
+		deltas[i][1] = (map[i][1] - cdestg) / (double)src->fadedist;
+
+		map[i][2] = (cbrightness * src->cmaskb) + (b * src->othermask);
+		if (map[i][2] > 255.0l)
+			map[i][2] = 255.0l;
+		deltas[i][2] = (map[i][2] - cdestb) / (double)src->fadedist;
+	}
+
+	// Now allocate memory for the actual colormap array itself!
+	// aligned on 8 bit for asm code
+	colormap_p = Z_MallocAlign((256 * 34) + 10, PU_LEVEL, NULL, 8);
+	extra_colormaps[mapnum].colormap = (UINT8 *)colormap_p;
 
-		// Initialise the map and delta arrays
-		// map[i] stores an RGB color (as double) for index i,
-		//  which is then converted to SRB2's palette later
-		// deltas[i] stores a corresponding fade delta between the RGB color and the final fade color;
-		//  map[i]'s values are decremented by after each use
+	// Calculate the palette index for each palette index, for each light level
+	// (as well as the two unused colormap lines we inherited from Doom)
+	for (p = 0; p < 34; p++)
+	{
 		for (i = 0; i < 256; i++)
 		{
-			r = pLocalPalette[i].s.red;
-			g = pLocalPalette[i].s.green;
-			b = pLocalPalette[i].s.blue;
-			cbrightness = sqrt((r*r) + (g*g) + (b*b));
-
-			map[i][0] = (cbrightness * cmaskr) + (r * othermask);
-			if (map[i][0] > 255.0l)
-				map[i][0] = 255.0l;
-			deltas[i][0] = (map[i][0] - cdestr) / (double)fadedist;
-
-			map[i][1] = (cbrightness * cmaskg) + (g * othermask);
-			if (map[i][1] > 255.0l)
-				map[i][1] = 255.0l;
-			deltas[i][1] = (map[i][1] - cdestg) / (double)fadedist;
-
-			map[i][2] = (cbrightness * cmaskb) + (b * othermask);
-			if (map[i][2] > 255.0l)
-				map[i][2] = 255.0l;
-			deltas[i][2] = (map[i][2] - cdestb) / (double)fadedist;
+			*colormap_p = NearestColor((UINT8)RoundUp(map[i][0]),
+				(UINT8)RoundUp(map[i][1]),
+				(UINT8)RoundUp(map[i][2]));
+			colormap_p++;
+
+			if ((UINT32)p < src->fadestart)
+				continue;
+#define ABS2(x) ((x) < 0 ? -(x) : (x))
+			if (ABS2(map[i][0] - cdestr) > ABS2(deltas[i][0]))
+				map[i][0] -= deltas[i][0];
+			else
+				map[i][0] = cdestr;
+
+			if (ABS2(map[i][1] - cdestg) > ABS2(deltas[i][1]))
+				map[i][1] -= deltas[i][1];
+			else
+				map[i][1] = cdestg;
+
+			if (ABS2(map[i][2] - cdestb) > ABS2(deltas[i][1]))
+				map[i][2] -= deltas[i][2];
+			else
+				map[i][2] = cdestb;
+#undef ABS2
 		}
+	}
+}
 
-		// Now allocate memory for the actual colormap array itself!
-		colormap_p = Z_MallocAlign((256 * 34) + 10, PU_LEVEL, NULL, 8);
-		extra_colormaps[mapnum].colormap = (UINT8 *)colormap_p;
+//
+// R_GenerateExtraColormaps
+//
+// Builds the lighting tables of any extra colormaps made since the last
+// call. Only the software renderer draws with them, so it calls this
+// before every view; the OpenGL renderer never builds them at all.
+//
+void R_GenerateExtraColormaps(void)
+{
+	for (; numgeneratedcolormaps < num_extra_colormaps; numgeneratedcolormaps++)
+		if (!extra_colormaps[numgeneratedcolormaps].colormap)
+			R_GenerateColormap(numgeneratedcolormaps);
+}
 
-		// Calculate the palette index for each palette index, for each light level
-		// (as well as the two unused colormap lines we inherited from Doom)
-		for (p = 0; p < 34; p++)
-		{
-			for (i = 0; i < 256; i++)
-			{
-				*colormap_p = NearestColor((UINT8)RoundUp(map[i][0]),
-					(UINT8)RoundUp(map[i][1]),
-					(UINT8)RoundUp(map[i][2]));
-				colormap_p++;
+//
+// Nearest palette colour
+//
+// The RGB cube is split into 32x32x32 cells. The first time a colour in a
+// cell is looked up, the cell gets the list of palette entries that can be
+// nearest to some point inside it: those whose closest possible distance
+// to the cell is no more than the smallest farthest possible distance of
+// any entry. A lookup then only measures the entries on that list, in
+// palette order, so it returns exactly what the full 256 entry search did.
+//
 
-				if ((UINT32)p < fadestart)
-					continue;
-#define ABS2(x) ((x) < 0 ? -(x) : (x))
-				if (ABS2(map[i][0] - cdestr) > ABS2(deltas[i][0]))
-					map[i][0] -= deltas[i][0];
-				else
-					map[i][0] = cdestr;
+#define NEARESTBITS 5
+#define NEARESTSHIFT (8-NEARESTBITS)
+#define NEARESTCELLS (1<<(3*NEARESTBITS))
 
-				if (ABS2(map[i][1] - cdestg) > ABS2(deltas[i][1]))
-					map[i][1] -= deltas[i][1];
-				else
-					map[i][1] = cdestg;
+static UINT32 nearestcell[NEARESTCELLS]; // offset into nearestlist + 1, 0 if not built yet
+static UINT8 *nearestlist; // per cell: number of candidates - 1, then the candidates
+static size_t nearestlistlen, nearestlistsize;
+static const RGBA_t *nearestpalette;
 
-				if (ABS2(map[i][2] - cdestb) > ABS2(deltas[i][1]))
-					map[i][2] -= deltas[i][2];
-				else
-					map[i][2] = cdestb;
-#undef ABS2
-			}
+//
+// R_FlushNearestColors
+// Throws away the candidate lists, needed when the palette changes.
+//
+void R_FlushNearestColors(void)
+{
+	memset(nearestcell, 0, sizeof nearestcell);
+	nearestlistlen = 0;
+	nearestpalette = NULL;
+}
+
+static UINT32 R_BuildNearestCell(INT32 cell)
+{
+	const INT32 lo[3] = {
+		(cell >> (2*NEARESTBITS)) << NEARESTSHIFT,
+		((cell >> NEARESTBITS) & ((1<<NEARESTBITS)-1)) << NEARESTSHIFT,
+		(cell & ((1<<NEARESTBITS)-1)) << NEARESTSHIFT
+	};
+	INT32 mindist[256], i, c, v, limit = INT32_MAX, count = 0;
+	size_t start = nearestlistlen;
+
+	for (i = 0; i < 256; i++)
+	{
+		const INT32 rgb[3] = {pLocalPalette[i].s.red, pLocalPalette[i].s.green, pLocalPalette[i].s.blue};
+		INT32 nearest = 0, farthest = 0, hi;
+
+		for (c = 0; c < 3; c++)
+		{
+			hi = lo[c] + (1<<NEARESTSHIFT) - 1;
+			v = (rgb[c] < lo[c]) ? lo[c] - rgb[c] : ((rgb[c] > hi) ? rgb[c] - hi : 0);
+			nearest += v*v;
+			v = max(abs(rgb[c] - lo[c]), abs(rgb[c] - hi));
+			farthest += v*v;
 		}
+
+		mindist[i] = nearest;
+		if (farthest < limit)
+			limit = farthest;
 	}
 
-	return (INT32)mapnum;
+	if (nearestlistsize < nearestlistlen + 257)
+	{
+		nearestlistsize = max(nearestlistsize*2, nearestlistlen + 257);
+		nearestlist = Z_Realloc(nearestlist, nearestlistsize, PU_STATIC, &nearestlist);
+	}
+
+	for (i = 0; i < 256; i++)
+		if (mindist[i] <= limit)
+			nearestlist[start + 1 + count++] = (UINT8)i;
+
+	nearestlist[start] = (UINT8)(count - 1);
+	nearestlistlen += 1 + count;
+	return (UINT32)start + 1;
 }
 
 // Thanks to quake2 source!
@@ -1346,9 +1766,25 @@ UINT8 NearestColor(UINT8 r, UINT8 g, UINT8 b)
 {
 	int dr, dg, db;
 	int distortion, bestdistortion = 256 * 256 * 4, bestcolor = 0, i;
+	const INT32 cell = ((r >> NEARESTSHIFT) << (2*NEARESTBITS)) | ((g >> NEARESTSHIFT) << NEARESTBITS) | (b >> NEARESTSHIFT);
+	const UINT8 *list;
+	INT32 count;
 
-	for (i = 0; i < 256; i++)
+	if (nearestpalette != pLocalPalette)
 	{
+		R_FlushNearestColors();
+		nearestpalette = pLocalPalette;
+	}
+
+	if (!nearestcell[cell])
+		nearestcell[cell] = R_BuildNearestCell(cell);
+
+	list = nearestlist + nearestcell[cell] - 1;
+	count = list[0] + 1;
+
+	for (list++; count--; list++)
+	{
+		i = *list;
 		dr = r - pLocalPalette[i].s.red;
 		dg = g - pLocalPalette[i].s.green;
 		db = b - pLocalPalette[i].s.blue;
@@ -1534,6 +1970,7 @@ void R_PrecacheLevel(void)
 {
 	char *texturepresent, *spritepresent;
 	size_t i, j, k;
+	size_t flatmips, texturemips;
 	lumpnum_t lump;
 
 	thinker_t *th;
@@ -1617,10 +2054,12 @@ void R_PrecacheLevel(void)
 	}
 	free(spritepresent);
 
+	R_MipmapMemory(&flatmips, &texturemips);
+
 	// FIXME: this is no longer correct with OpenGL render mode
 	CONS_Debug(DBG_SETUP, "Precache level done:\n"
 			"flatmemory:    %s k\n"
 			"texturememory: %s k\n"
-			"spritememory:  %s k\n", sizeu1(flatmemory>>10), sizeu2(texturememory>>10), sizeu3(spritememory>>10));
+			"spritememory:  %s k\n", sizeu1((flatmemory + flatmips)>>10), sizeu2((texturememory + texturemips)>>10), sizeu3(spritememory>>10));
 }
 
@@ -73,6 +73,15 @@ UINT8 *R_GetColumn(fixed_t tex, INT32 col);
 
 UINT8 *R_GetFlat(lumpnum_t flatnum);
 
+// Mipmaps, full size plus up to MIPLEVELS-1 halved copies.
+#define MIPLEVELS 4
+extern consvar_t cv_mipmapping;
+
+INT32 R_TextureMipLevels(INT32 tex);
+UINT8 *R_GetColumnMipmap(fixed_t tex, INT32 col, INT32 level);
+UINT8 *R_GetFlatMipmap(lumpnum_t flatnum, UINT8 *base, INT32 flatbits, INT32 level);
+void R_FlushMipmaps(void);
+
 // I/O, setting up the stuff.
 void R_InitData(void);
 void R_PrecacheLevel(void);
@@ -93,9 +102,11 @@ void R_ReInitColormaps(UINT16 num);
 void R_ClearColormaps(void);
 INT32 R_ColormapNumForName(char *name);
 INT32 R_CreateColormap(char *p1, char *p2, char *p3);
+void R_GenerateExtraColormaps(void);
 const char *R_ColormapNameForNum(INT32 num);
 
 UINT8 NearestColor(UINT8 r, UINT8 g, UINT8 b);
+void R_FlushNearestColors(void);
 
 extern INT32 numtextures;
 
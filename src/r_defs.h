@@ -341,7 +341,8 @@ typedef struct sector_s
 	size_t maxattached;
 	lightlist_t *lightlist;
 	INT32 numlights;
-	boolean moved;
+	UINT32 lightlistkey; // what lightlist was built from, see R_Prep3DFloors
+	size_t lightlistframe; // framecount it was last checked on
 
 	// per-sector colormaps!
 	extracolormap_t *extra_colormap;
@@ -716,6 +717,24 @@ typedef struct
 #pragma pack()
 #endif
 
+// In software, patches cached with W_CachePatchNum are followed by their
+// posts already decoded, so drawers can go straight to the pixels instead
+// of walking each column. Get them with W_GetPatchPosts.
+typedef struct
+{
+	INT16 topdelta; // with the tall patch offsets already added up
+	INT16 length;
+	UINT32 ofs; // of the post's pixels, from the start of the patch
+} patchpost_t;
+
+typedef struct patchposts_s
+{
+	const UINT32 *columnposts; // [width+1], column c has posts [columnposts[c], columnposts[c+1])
+	const patchpost_t *posts;
+	const patch_t *patch; // the patch these belong to
+	UINT32 id; // PATCHPOSTSID
+} patchposts_t;
+
 //
 // Sprites are patches with a special naming convention so they can be
 //  recognized by R_InitSprites.
@@ -38,6 +38,11 @@
 */
 INT32 viewwidth, scaledviewwidth, viewheight, viewwindowx, viewwindowy;
 
+/**	\brief output height of the view window, differs from viewheight
+	when the view is rendered at a lower internal resolution
+*/
+INT32 scaledviewheight;
+
 /**	\brief pointer to the start of each line of the screen,
 */
 UINT8 *ylookup[MAXVIDHEIGHT*4];
@@ -96,12 +101,13 @@ INT32 dc_numlights = 0, dc_maxlights, dc_texheight;
 //                      SPAN DRAWING CODE STUFF
 // =========================================================================
 
-INT32 ds_y, ds_x1, ds_x2;
-lighttable_t *ds_colormap;
-fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
+// Flats can be drawn on several threads at once, see R_DrawPlanes
+THREADLOCAL INT32 ds_y, ds_x1, ds_x2;
+THREADLOCAL lighttable_t *ds_colormap;
+THREADLOCAL fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
 
-UINT8 *ds_source; // start of a 64*64 tile image
-UINT8 *ds_transmap; // one of the translucency tables
+THREADLOCAL UINT8 *ds_source; // start of a 64*64 tile image
+THREADLOCAL UINT8 *ds_transmap; // one of the translucency tables
 
 
 pslope_t *ds_slope; // Current slope being used
@@ -112,7 +118,7 @@ float focallengthf, zeroheight;
 /**	\brief Variable flat sizes
 */
 
-UINT32 nflatxshift, nflatyshift, nflatshiftup, nflatmask;
+THREADLOCAL UINT32 nflatxshift, nflatyshift, nflatshiftup, nflatmask;
 
 // ==========================================================================
 //                        OLD DOOM FUZZY EFFECT
@@ -263,7 +269,7 @@ void R_InitTranslationTables(void)
 	// Load here the transparency lookup tables 'TINTTAB'
 	// NOTE: the TINTTAB resource MUST BE aligned on 64k for the asm
 	// optimised code (in other words, transtables pointer low word is 0)
-	transtables = Z_MallocAlign(NUMTRANSTABLES*0x10000, PU_STATIC,
+	transtables = Z_MallocAlign(NUMTRANSTABLES*0x10000 + TRANSROWPAD, PU_STATIC,
 		NULL, 16);
 
 	W_ReadLump(W_GetNumForName("TRANS10"), transtables);
@@ -686,6 +692,60 @@ void R_InitViewBuffer(INT32 width, INT32 height)
 	}
 }
 
+/**	\brief	The R_UpscaleView function
+
+	Stretches the viewwidth x viewheight image drawn at the top left of
+	the view window to fill scaledviewwidth x scaledviewheight.
+	Works in place: every destination pixel reads from a source pixel
+	at or above and to the left of it, so walking the view backwards
+	never reads a pixel that was already overwritten.
+
+	\return	void
+*/
+void R_UpscaleView(void)
+{
+	static INT32 xmap[MAXVIDWIDTH], ymap[MAXVIDHEIGHT];
+	static INT32 mapwidth = 0, mapheight = 0, mapsrcwidth = 0, mapsrcheight = 0;
+	INT32 x, y;
+
+	if (viewwidth == scaledviewwidth && viewheight == scaledviewheight)
+		return;
+
+	if (mapwidth != scaledviewwidth || mapsrcwidth != viewwidth)
+	{
+		for (x = 0; x < scaledviewwidth; x++)
+			xmap[x] = columnofs[x * viewwidth / scaledviewwidth];
+		mapwidth = scaledviewwidth;
+		mapsrcwidth = viewwidth;
+	}
+
+	if (mapheight != scaledviewheight || mapsrcheight != viewheight)
+	{
+		for (y = 0; y < scaledviewheight; y++)
+			ymap[y] = y * viewheight / scaledviewheight;
+		mapheight = scaledviewheight;
+		mapsrcheight = viewheight;
+	}
+
+	for (y = scaledviewheight - 1; y >= 0; y--)
+	{
+		UINT8 *dest = ylookup[y];
+
+		// Same source row as the row below, just copy that one up.
+		if (y < scaledviewheight - 1 && ymap[y] == ymap[y + 1])
+		{
+			M_Memcpy(dest + columnofs[0], ylookup[y + 1] + columnofs[0], scaledviewwidth);
+			continue;
+		}
+
+		{
+			const UINT8 *src = ylookup[ymap[y]];
+			for (x = scaledviewwidth - 1; x >= 0; x--)
+				dest[columnofs[x]] = src[xmap[x]];
+		}
+	}
+}
+
 /**	\brief viewborder patches lump numbers
 */
 lumpnum_t viewborderlump[8];
@@ -723,7 +783,7 @@ void R_FillBackScreen(void)
 
 	// draw pattern around the status bar too (when hires),
 	// so return only when in full-screen without status bar.
-	if (scaledviewwidth == vid.width && viewheight == vid.height)
+	if (scaledviewwidth == vid.width && scaledviewheight == vid.height)
 		return;
 
 	src = scr_borderpatch;
@@ -757,14 +817,14 @@ void R_FillBackScreen(void)
 
 	patch = W_CacheLumpNum(viewborderlump[BRDR_B], PU_CACHE);
 	for (x = 0; x < scaledviewwidth; x += step)
-		V_DrawPatch(viewwindowx + x, viewwindowy + viewheight, 1, patch);
+		V_DrawPatch(viewwindowx + x, viewwindowy + scaledviewheight, 1, patch);
 
 	patch = W_CacheLumpNum(viewborderlump[BRDR_L], PU_CACHE);
-	for (y = 0; y < viewheight; y += step)
+	for (y = 0; y < scaledviewheight; y += step)
 		V_DrawPatch(viewwindowx - boff, viewwindowy + y, 1, patch);
 
 	patch = W_CacheLumpNum(viewborderlump[BRDR_R],PU_CACHE);
-	for (y = 0; y < viewheight; y += step)
+	for (y = 0; y < scaledviewheight; y += step)
 		V_DrawPatch(viewwindowx + scaledviewwidth, viewwindowy + y, 1,
 			patch);
 
@@ -773,9 +833,9 @@ void R_FillBackScreen(void)
 		W_CacheLumpNum(viewborderlump[BRDR_TL], PU_CACHE));
 	V_DrawPatch(viewwindowx + scaledviewwidth, viewwindowy - boff, 1,
 		W_CacheLumpNum(viewborderlump[BRDR_TR], PU_CACHE));
-	V_DrawPatch(viewwindowx - boff, viewwindowy + viewheight, 1,
+	V_DrawPatch(viewwindowx - boff, viewwindowy + scaledviewheight, 1,
 		W_CacheLumpNum(viewborderlump[BRDR_BL], PU_CACHE));
-	V_DrawPatch(viewwindowx + scaledviewwidth, viewwindowy + viewheight, 1,
+	V_DrawPatch(viewwindowx + scaledviewwidth, viewwindowy + scaledviewheight, 1,
 		W_CacheLumpNum(viewborderlump[BRDR_BR], PU_CACHE));
 }
 #endif
@@ -823,21 +883,21 @@ void R_DrawViewBorder(void)
 #endif
 
 #ifdef DEBUG
-	fprintf(stderr,"RDVB: vidwidth %d vidheight %d scaledviewwidth %d viewheight %d\n",
-		vid.width, vid.height, scaledviewwidth, viewheight);
+	fprintf(stderr,"RDVB: vidwidth %d vidheight %d scaledviewwidth %d scaledviewheight %d\n",
+		vid.width, vid.height, scaledviewwidth, scaledviewheight);
 #endif
 
 	if (scaledviewwidth == vid.width)
 		return;
 
-	top = (vid.height - viewheight)>>1;
+	top = (vid.height - scaledviewheight)>>1;
 	side = (vid.width - scaledviewwidth)>>1;
 
 	// copy top and one line of left side
 	R_VideoErase(0, top*vid.width+side);
 
 	// copy one line of right side and bottom
-	ofs = (viewheight+top)*vid.width - side;
+	ofs = (scaledviewheight+top)*vid.width - side;
 	R_VideoErase(ofs, top*vid.width + side);
 
 	// copy sides using wraparound
@@ -845,7 +905,7 @@ void R_DrawViewBorder(void)
 	side <<= 1;
 
     // simpler using our VID_Blit routine
-	VID_BlitLinearScreen(screens[1] + ofs, screens[0] + ofs, side, viewheight - 1,
+	VID_BlitLinearScreen(screens[1] + ofs, screens[0] + ofs, side, scaledviewheight - 1,
 		vid.width, vid.width);
 }
 #endif
@@ -54,11 +54,11 @@ extern INT32 dc_texheight;
 // SPAN DRAWING CODE STUFF
 // -----------------------
 
-extern INT32 ds_y, ds_x1, ds_x2;
-extern lighttable_t *ds_colormap;
-extern fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
-extern UINT8 *ds_source; // start of a 64*64 tile image
-extern UINT8 *ds_transmap;
+extern THREADLOCAL INT32 ds_y, ds_x1, ds_x2;
+extern THREADLOCAL lighttable_t *ds_colormap;
+extern THREADLOCAL fixed_t ds_xfrac, ds_yfrac, ds_xstep, ds_ystep;
+extern THREADLOCAL UINT8 *ds_source; // start of a 64*64 tile image
+extern THREADLOCAL UINT8 *ds_transmap;
 
 
 typedef struct {
@@ -71,10 +71,10 @@ extern float focallengthf, zeroheight;
 
 
 // Variable flat sizes
-extern UINT32 nflatxshift;
-extern UINT32 nflatyshift;
-extern UINT32 nflatshiftup;
-extern UINT32 nflatmask;
+extern THREADLOCAL UINT32 nflatxshift;
+extern THREADLOCAL UINT32 nflatyshift;
+extern THREADLOCAL UINT32 nflatshiftup;
+extern THREADLOCAL UINT32 nflatmask;
 
 /// \brief Top border
 #define BRDR_T 0
@@ -115,6 +115,7 @@ extern UINT8 colortranslations[MAXTRANSLATIONS][16];
 
 // Custom player skin translation
 void R_InitViewBuffer(INT32 width, INT32 height);
+void R_UpscaleView(void);
 void R_InitViewBorder(void);
 void R_VideoErase(size_t ofs, INT32 count);
 
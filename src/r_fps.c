@@ -106,10 +106,17 @@ viewvars_t *newview = &p1view_new;
 
 enum viewcontext_e viewcontext = VIEWCONTEXT_PLAYER1;
 
-static levelinterpolator_t **levelinterpolators;
+// Kept by value, so a frame's worth of interpolating reads one block of memory
+static levelinterpolator_t *levelinterpolators;
 static size_t levelinterpolators_len;
 static size_t levelinterpolators_size;
 
+// Indices of the interpolators that moved on the last tic.
+// Everything else would lerp between two equal states, so it is skipped.
+static size_t *movinginterpolators;
+static size_t movinginterpolators_len;
+static boolean movinginterpolators_dirty;
+
 
 static int oldview_invalid[MAXSPLITSCREENPLAYERS] = {0, 0};
 
@@ -418,8 +425,11 @@ void R_ResetPrecipitationMobjInterpolationState(precipmobj_t *mobj)
 	mobj->old_angle = mobj->angle;
 }
 
-static void AddInterpolator(levelinterpolator_t* interpolator)
+// The returned pointer is only good until the next interpolator is created
+static levelinterpolator_t *CreateInterpolator(levelinterpolator_type_e type, thinker_t *thinker)
 {
+	levelinterpolator_t *ret;
+
 	if (levelinterpolators_len >= levelinterpolators_size)
 	{
 		if (levelinterpolators_size == 0)
@@ -433,27 +443,25 @@ static void AddInterpolator(levelinterpolator_t* interpolator)
 
 		levelinterpolators = Z_ReallocAlign(
 			(void*) levelinterpolators,
-			sizeof(levelinterpolator_t*) * levelinterpolators_size,
+			sizeof(levelinterpolator_t) * levelinterpolators_size,
 			PU_LEVEL,
 			NULL,
-			sizeof(levelinterpolator_t*) * 8
+			64
+		);
+		movinginterpolators = Z_Realloc(
+			movinginterpolators,
+			sizeof(size_t) * levelinterpolators_size,
+			PU_LEVEL,
+			NULL
 		);
 	}
-	levelinterpolators[levelinterpolators_len] = interpolator;
+
+	ret = &levelinterpolators[levelinterpolators_len];
 	levelinterpolators_len += 1;
-}
 
-static levelinterpolator_t *CreateInterpolator(levelinterpolator_type_e type, thinker_t *thinker)
-{
-	levelinterpolator_t *ret = (levelinterpolator_t*) Z_CallocAlign(
-		sizeof(levelinterpolator_t),
-		PU_LEVEL,
-		NULL,
-		sizeof(levelinterpolator_t) * 8
-	);
+	memset(ret, 0, sizeof(*ret));
 	ret->type = type;
 	ret->thinker = thinker;
-	AddInterpolator(ret);
 	return ret;
 }
 
@@ -536,6 +544,22 @@ void R_InitializeLevelInterpolators(void)
 	levelinterpolators_len = 0;
 	levelinterpolators_size = 0;
 	levelinterpolators = NULL;
+	movinginterpolators_len = 0;
+	movinginterpolators = NULL;
+	movinginterpolators_dirty = false;
+}
+
+static void CollectMovingInterpolators(void)
+{
+	size_t i;
+
+	movinginterpolators_len = 0;
+	for (i = 0; i < levelinterpolators_len; i++)
+	{
+		if (levelinterpolators[i].moving)
+			movinginterpolators[movinginterpolators_len++] = i;
+	}
+	movinginterpolators_dirty = false;
 }
 
 static void UpdateLevelInterpolatorState(levelinterpolator_t *interp)
@@ -547,6 +571,7 @@ static void UpdateLevelInterpolatorState(levelinterpolator_t *interp)
 	case LVLINTERP_SectorPlane:
 		interp->sectorplane.oldheight = interp->sectorplane.bakheight;
 		interp->sectorplane.bakheight = interp->sectorplane.ceiling ? interp->sectorplane.sector->ceilingheight : interp->sectorplane.sector->floorheight;
+		interp->moving = (interp->sectorplane.oldheight != interp->sectorplane.bakheight);
 		break;
 
 	case LVLINTERP_SectorScroll:
@@ -554,25 +579,34 @@ static void UpdateLevelInterpolatorState(levelinterpolator_t *interp)
 		interp->sectorscroll.bakxoffs = interp->sectorscroll.ceiling ? interp->sectorscroll.sector->ceiling_xoffs : interp->sectorscroll.sector->floor_xoffs;
 		interp->sectorscroll.oldyoffs = interp->sectorscroll.bakyoffs;
 		interp->sectorscroll.bakyoffs = interp->sectorscroll.ceiling ? interp->sectorscroll.sector->ceiling_yoffs : interp->sectorscroll.sector->floor_yoffs;
+		interp->moving = (interp->sectorscroll.oldxoffs != interp->sectorscroll.bakxoffs
+			|| interp->sectorscroll.oldyoffs != interp->sectorscroll.bakyoffs);
 		break;
 	case LVLINTERP_SideScroll:
 		interp->sidescroll.oldtextureoffset = interp->sidescroll.baktextureoffset;
 		interp->sidescroll.baktextureoffset = interp->sidescroll.side->textureoffset;
 		interp->sidescroll.oldrowoffset = interp->sidescroll.bakrowoffset;
 		interp->sidescroll.bakrowoffset = interp->sidescroll.side->rowoffset;
+		interp->moving = (interp->sidescroll.oldtextureoffset != interp->sidescroll.baktextureoffset
+			|| interp->sidescroll.oldrowoffset != interp->sidescroll.bakrowoffset);
 		break;
 	case LVLINTERP_Polyobj:
+		interp->moving = false;
 		for (i = 0; i < interp->polyobj.vertices_size; i++)
 		{
 			interp->polyobj.oldvertices[i * 2    ] = interp->polyobj.bakvertices[i * 2    ];
 			interp->polyobj.oldvertices[i * 2 + 1] = interp->polyobj.bakvertices[i * 2 + 1];
 			interp->polyobj.bakvertices[i * 2    ] = interp->polyobj.polyobj->vertices[i]->x;
 			interp->polyobj.bakvertices[i * 2 + 1] = interp->polyobj.polyobj->vertices[i]->y;
+			interp->moving |= (interp->polyobj.oldvertices[i * 2    ] != interp->polyobj.bakvertices[i * 2    ]
+				|| interp->polyobj.oldvertices[i * 2 + 1] != interp->polyobj.bakvertices[i * 2 + 1]);
 		}
 		interp->polyobj.oldcx = interp->polyobj.bakcx;
 		interp->polyobj.oldcy = interp->polyobj.bakcy;
 		interp->polyobj.bakcx = interp->polyobj.polyobj->centerPt.x;
 		interp->polyobj.bakcy = interp->polyobj.polyobj->centerPt.y;
+		interp->moving |= (interp->polyobj.oldcx != interp->polyobj.bakcx
+			|| interp->polyobj.oldcy != interp->polyobj.bakcy);
 		break;
     case LVLINTERP_DynSlope:
 		FV3_Copy(&interp->dynslope.oldo, &interp->dynslope.bako);
@@ -582,6 +616,9 @@ static void UpdateLevelInterpolatorState(levelinterpolator_t *interp)
 		FV3_Copy(&interp->dynslope.bako, &interp->dynslope.slope->o);
 		FV2_Copy(&interp->dynslope.bakd, &interp->dynslope.slope->d);
 		interp->dynslope.bakzdelta = interp->dynslope.slope->zdelta;
+		interp->moving = (memcmp(&interp->dynslope.oldo, &interp->dynslope.bako, sizeof(vector3_t))
+			|| memcmp(&interp->dynslope.oldd, &interp->dynslope.bakd, sizeof(vector2_t))
+			|| interp->dynslope.oldzdelta != interp->dynslope.bakzdelta);
 		break;
 	}
 }
@@ -591,10 +628,12 @@ void R_UpdateLevelInterpolators(void)
 	size_t i;
 	for (i = 0; i < levelinterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		levelinterpolator_t *interp = &levelinterpolators[i];
 
 		UpdateLevelInterpolatorState(interp);
 	}
+
+	CollectMovingInterpolators();
 }
 
 void R_ClearLevelInterpolatorState(thinker_t *thinker)
@@ -603,13 +642,14 @@ void R_ClearLevelInterpolatorState(thinker_t *thinker)
 	size_t i;
 	for (i = 0; i < levelinterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		levelinterpolator_t *interp = &levelinterpolators[i];
 
 		if (interp->thinker == thinker)
 		{
 			// Do it twice to make the old state match the new
 			UpdateLevelInterpolatorState(interp);
 			UpdateLevelInterpolatorState(interp);
+			movinginterpolators_dirty = true;
 		}
 	}
 }
@@ -617,9 +657,13 @@ void R_ClearLevelInterpolatorState(thinker_t *thinker)
 void R_ApplyLevelInterpolators(fixed_t frac)
 {
 	size_t i, ii;
-	for (i = 0; i < levelinterpolators_len; i++)
+
+	if (movinginterpolators_dirty)
+		CollectMovingInterpolators();
+
+	for (i = 0; i < movinginterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		levelinterpolator_t *interp = &levelinterpolators[movinginterpolators[i]];
 		switch (interp->type)
 		{
 		case LVLINTERP_SectorPlane:
@@ -672,10 +716,12 @@ void R_ApplyLevelInterpolators(fixed_t frac)
 
 void R_RestoreLevelInterpolators(void)
 {
-	size_t i, ii;;
-	for (i = 0; i < levelinterpolators_len; i++)
+	size_t i, ii;
+
+	// Same set R_ApplyLevelInterpolators touched; nothing can change it in between
+	for (i = 0; i < movinginterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		levelinterpolator_t *interp = &levelinterpolators[movinginterpolators[i]];
 
 		switch (interp->type)
 		{
@@ -730,15 +776,21 @@ void R_DestroyLevelInterpolators(thinker_t *thinker)
 
 	for (i = 0; i < levelinterpolators_len; i++)
 	{
-		levelinterpolator_t *interp = levelinterpolators[i];
+		levelinterpolator_t *interp = &levelinterpolators[i];
 
 		if (interp->thinker == thinker)
 		{
+			if (interp->type == LVLINTERP_Polyobj)
+			{
+				Z_Free(interp->polyobj.oldvertices);
+				Z_Free(interp->polyobj.bakvertices);
+			}
+
 			// Swap the tail of the level interpolators to this spot
-			levelinterpolators[i] = levelinterpolators[levelinterpolators_len - 1];
+			*interp = levelinterpolators[levelinterpolators_len - 1];
 			levelinterpolators_len -= 1;
+			movinginterpolators_dirty = true;
 
-			Z_Free(interp);
 			i -= 1;
 		}
 	}
@@ -67,6 +67,7 @@ typedef enum {
 typedef struct levelinterpolator_s {
 	levelinterpolator_type_e type;
 	thinker_t *thinker;
+	boolean moving; // old and new states differ, so it needs applying
 	union {
 		struct {
 			sector_t *sector;
@@ -148,6 +148,7 @@ ps_metric_t ps_sw_spritecliptime = {0};
 ps_metric_t ps_sw_portaltime = {0};
 ps_metric_t ps_sw_planetime = {0};
 ps_metric_t ps_sw_maskedtime = {0};
+ps_metric_t ps_sw_seglooptime = {0}; // r_segs.c, portals included
 
 ps_metric_t ps_numbspcalls = {0};
 ps_metric_t ps_numsprites = {0};
@@ -165,6 +166,8 @@ static CV_PossibleValue_t maxportals_cons_t[] = {{0, "MIN"}, {12, "MAX"}, {0, NU
 static CV_PossibleValue_t homremoval_cons_t[] = {{0, "No"}, {1, "Yes"}, {2, "Flash"}, {0, NULL}};
 static CV_PossibleValue_t fov_cons_t[] = {{60*FRACUNIT, "MIN"}, {179*FRACUNIT, "MAX"}, {0, NULL}};
 static CV_PossibleValue_t shadowposition_cons_t[] = {{0, "Static"}, {1, "Camera"}, {0, NULL}};
+static CV_PossibleValue_t dynres_target_cons_t[] = {{FRACUNIT, "MIN"}, {100*FRACUNIT, "MAX"}, {0, NULL}};
+static CV_PossibleValue_t dynres_min_cons_t[] = {{25, "MIN"}, {100, "MAX"}, {0, NULL}};
 
 static void Fov_OnChange(void);
 static void ChaseCam_OnChange(void);
@@ -202,6 +205,14 @@ consvar_t cv_fov = {"fov", "90", CV_FLOAT|CV_CALL, fov_cons_t, Fov_OnChange, 0,
 
 consvar_t cv_maxportals = {"maxportals", "2", CV_SAVE, maxportals_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL}; 
 
+// Dynamic internal resolution (software only)
+consvar_t cv_dynres = {"dynres", "Off", CV_SAVE|CV_CALL, CV_OnOff, R_SetViewSize, 0, NULL, NULL, 0, 0, NULL};
+consvar_t cv_dynres_target = {"dynres_target", "12", CV_SAVE|CV_FLOAT, dynres_target_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL}; // milliseconds of 3D rendering
+consvar_t cv_dynres_min = {"dynres_min", "50", CV_SAVE|CV_CALL, dynres_min_cons_t, R_SetViewSize, 0, NULL, NULL, 0, 0, NULL}; // percent of the output resolution
+
+static CV_PossibleValue_t renderthreads_cons_t[] = {{1, "MIN"}, {8, "MAX"}, {0, NULL}};
+consvar_t cv_renderthreads = {"renderthreads", "1", CV_SAVE, renderthreads_cons_t, NULL, 0, NULL, NULL, 0, 0, NULL}; // threads drawing flats, see R_DrawPlanes
+
 
 
 
@@ -884,6 +895,72 @@ void R_ApplyViewMorph(void)
 
 
 
+//
+// Dynamic internal resolution
+//
+// The 3D view can be drawn at a fraction of the screen resolution and
+// stretched back up by R_UpscaleView before the HUD is drawn on top.
+// The fraction follows the measured render time: it steps down when
+// rendering takes longer than dynres_target and back up when there is
+// headroom again.
+//
+#define DYNRES_STEP (FRACUNIT/16)
+#define DYNRES_INTERVAL 16 // frames between adjustments
+
+static fixed_t renderscale = FRACUNIT; // scale the current view tables were built for
+static fixed_t dynres_wanted = FRACUNIT;
+static INT64 dynres_avgtime = 0; // microseconds, smoothed
+static INT32 dynres_frames = 0;
+
+// Scale the view should use right now.
+static fixed_t R_EffectiveRenderScale(void)
+{
+	// The view morph maps the full screen, and only 8bpp is stretched.
+	if (!cv_dynres.value || rendermode != render_soft || vid.bpp != 1 || viewmorph.use)
+		return FRACUNIT;
+
+	return max(dynres_wanted, cv_dynres_min.value*FRACUNIT/100);
+}
+
+// Requests a view size change if the render scale moved.
+void R_CheckDynamicResolution(void)
+{
+	if (R_EffectiveRenderScale() != renderscale)
+		setsizeneeded = true;
+}
+
+// Feeds the time the last 3D view took into the scale controller.
+void R_UpdateDynamicResolution(precise_t rendertime)
+{
+	const fixed_t minscale = cv_dynres_min.value*FRACUNIT/100;
+	INT64 target, usec;
+
+	if (!cv_dynres.value || rendermode != render_soft)
+	{
+		dynres_wanted = FRACUNIT;
+		dynres_avgtime = 0;
+		dynres_frames = 0;
+		return;
+	}
+
+	usec = I_PreciseToMicros(rendertime);
+	if (dynres_avgtime)
+		dynres_avgtime = (dynres_avgtime*7 + usec) / 8;
+	else
+		dynres_avgtime = usec;
+
+	if (++dynres_frames < DYNRES_INTERVAL)
+		return;
+	dynres_frames = 0;
+
+	target = ((INT64)cv_dynres_target.value * 1000) >> FRACBITS;
+
+	if (dynres_avgtime > target && dynres_wanted > minscale)
+		dynres_wanted = max(dynres_wanted - DYNRES_STEP, minscale);
+	else if (dynres_avgtime < target*3/4 && dynres_wanted < FRACUNIT)
+		dynres_wanted = min(dynres_wanted + DYNRES_STEP, FRACUNIT);
+}
+
 //
 // R_SetViewSize
 // Do not really change anything here,
@@ -918,12 +995,22 @@ void R_ExecuteSetViewSize(void)
 	st_overlay = cv_showhud.value;
 
 	scaledviewwidth = vid.width;
-	viewheight = vid.height;
+	scaledviewheight = vid.height;
 
 	if (splitscreen)
-		viewheight >>= 1;
+		scaledviewheight >>= 1;
 
-	viewwidth = scaledviewwidth;
+	renderscale = R_EffectiveRenderScale();
+	if (renderscale != FRACUNIT)
+	{
+		viewwidth = max(1, FixedMul(scaledviewwidth, renderscale));
+		viewheight = max(1, FixedMul(scaledviewheight, renderscale));
+	}
+	else
+	{
+		viewwidth = scaledviewwidth;
+		viewheight = scaledviewheight;
+	}
 
 	centerx = viewwidth/2;
 	centery = viewheight/2;
@@ -938,7 +1025,7 @@ void R_ExecuteSetViewSize(void)
 	projection = projectiony = FixedDiv(centerxfrac, fovtan);
 
 
-	R_InitViewBuffer(scaledviewwidth, viewheight);
+	R_InitViewBuffer(scaledviewwidth, scaledviewheight);
 
 	R_InitTextureMapping();
 
@@ -975,7 +1062,7 @@ void R_ExecuteSetViewSize(void)
 		startmapl = ((LIGHTLEVELS - 1 - i)*2)*NUMCOLORMAPS/LIGHTLEVELS;
 		for (j = 0; j < MAXLIGHTSCALE; j++)
 		{
-			level = startmapl - j*vid.width/(viewwidth)/DISTMAP;
+			level = startmapl - j*vid.width/(scaledviewwidth)/DISTMAP;
 
 			if (level < 0)
 				level = 0;
@@ -1646,6 +1733,8 @@ void R_RenderPlayerView(player_t *player)
 	portalrender = 0;
 	portal_base = portal_cap = NULL;
 
+	R_GenerateExtraColormaps();
+
 	PS_START_TIMING(ps_skyboxtime);
 	if (skybox && skyVisible)
 	{
@@ -1707,6 +1796,7 @@ void R_RenderPlayerView(player_t *player)
 	ProfZeroTimer();
 #endif
 	ps_numbspcalls.value.i = ps_numpolyobjects.value.i = ps_numdrawnodes.value.i = 0;
+	ps_sw_seglooptime.value.p = 0;
 	PS_START_TIMING(ps_bsptime);
 	R_RenderBSPNode((INT32)numnodes - 1);
 	PS_STOP_TIMING(ps_bsptime);
@@ -1769,6 +1859,9 @@ void R_RenderPlayerView(player_t *player)
 	R_DrawMasked();
 	PS_STOP_TIMING(ps_sw_maskedtime);
 
+	// Stretch a lower resolution view back up to the window size.
+	R_UpscaleView();
+
 	// Check for new console commands.
 	NetUpdate();
 
@@ -1842,6 +1935,12 @@ void R_RegisterEngineStuff(void)
 
 	CV_RegisterVar(&cv_maxportals);
 
+	CV_RegisterVar(&cv_dynres);
+	CV_RegisterVar(&cv_dynres_target);
+	CV_RegisterVar(&cv_dynres_min);
+	CV_RegisterVar(&cv_mipmapping);
+	CV_RegisterVar(&cv_renderthreads);
+
 	// Default viewheight is changeable,
 	// initialized to standard viewheight
 	CV_RegisterVar(&cv_viewheight); 
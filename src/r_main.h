@@ -22,7 +22,7 @@
 // POV related.
 //
 extern fixed_t viewcos, viewsin;
-extern INT32 viewheight;
+extern INT32 viewwidth, viewheight;
 extern INT32 centerx, centery;
 
 extern fixed_t centerxfrac, centeryfrac;
@@ -60,7 +60,7 @@ extern boolean renderisnewtic;
 #define MAXLIGHTZ 128
 #define LIGHTZSHIFT 20
 
-#define LIGHTRESOLUTIONFIX (640*fovtan/vid.width)
+#define LIGHTRESOLUTIONFIX (640*fovtan/viewwidth)
 
 extern lighttable_t *scalelight[LIGHTLEVELS][MAXLIGHTSCALE];
 extern lighttable_t *scalelightfixed[MAXLIGHTSCALE];
@@ -118,11 +118,14 @@ extern ps_metric_t ps_sw_spritecliptime;
 extern ps_metric_t ps_sw_portaltime;
 extern ps_metric_t ps_sw_planetime;
 extern ps_metric_t ps_sw_maskedtime;
+extern ps_metric_t ps_sw_seglooptime;
 
 extern ps_metric_t ps_numbspcalls;
 extern ps_metric_t ps_numsprites;
 extern ps_metric_t ps_numdrawnodes;
 extern ps_metric_t ps_numpolyobjects;
+extern ps_metric_t ps_colormapscreated; // r_data.c
+extern ps_metric_t ps_colormapsreused;
 
 
 //
@@ -149,6 +152,8 @@ extern consvar_t cv_translucency;
 extern consvar_t cv_precipdensity, cv_drawdist, cv_drawdist_nights, cv_drawdist_precip;
 extern consvar_t cv_fov;
 extern consvar_t cv_skybox;
+extern consvar_t cv_dynres, cv_dynres_target, cv_dynres_min;
+extern consvar_t cv_renderthreads;
 extern consvar_t cv_tailspickup; 
 
 // Uncapped Framerate
@@ -166,6 +171,9 @@ void R_SetViewSize(void);
 void R_CheckViewMorph(void);
 void R_ApplyViewMorph(void);
 
+void R_CheckDynamicResolution(void);
+void R_UpdateDynamicResolution(precise_t rendertime);
+
 
 // do it (sometimes explicitly called)
 void R_ExecuteSetViewSize(void);
@@ -28,6 +28,10 @@
 #include "z_zone.h"
 #include "p_tick.h"
 
+#ifdef HAVE_THREADS
+#include "i_threads.h"
+#endif
+
 #ifdef TIMING
 #include "p5prof.h"
 	INT64 mycount;
@@ -54,7 +58,7 @@ static visplane_t **freehead = &freetail;
 
 visplane_t *floorplane;
 visplane_t *ceilingplane;
-static visplane_t *currentplane;
+static THREADLOCAL visplane_t *currentplane;
 
 visffloor_t ffloor[MAXFFLOORS];
 INT32 numffloors;
@@ -79,13 +83,13 @@ fixed_t frontscale[MAXVIDWIDTH];
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-static INT32 spanstart[MAXVIDHEIGHT];
+static THREADLOCAL INT32 spanstart[MAXVIDHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t **planezlight;
-static fixed_t planeheight;
+THREADLOCAL lighttable_t **planezlight;
+static THREADLOCAL fixed_t planeheight;
 
 //added : 10-02-98: yslopetab is what yslope used to be,
 //                yslope points somewhere into yslopetab,
@@ -97,14 +101,26 @@ static fixed_t planeheight;
 fixed_t yslopetab[MAXVIDHEIGHT*16];
 fixed_t *yslope;
 
-fixed_t basexscale, baseyscale;
+THREADLOCAL fixed_t basexscale, baseyscale;
+
+THREADLOCAL fixed_t cachedheight[MAXVIDHEIGHT];
+THREADLOCAL fixed_t cacheddistance[MAXVIDHEIGHT];
+THREADLOCAL fixed_t cachedxstep[MAXVIDHEIGHT];
+THREADLOCAL fixed_t cachedystep[MAXVIDHEIGHT];
 
-fixed_t cachedheight[MAXVIDHEIGHT];
-fixed_t cacheddistance[MAXVIDHEIGHT];
-fixed_t cachedxstep[MAXVIDHEIGHT];
-fixed_t cachedystep[MAXVIDHEIGHT];
+static THREADLOCAL fixed_t xoffs, yoffs;
 
-static fixed_t xoffs, yoffs;
+// A plane's flat and its mipmaps, see R_CachePlaneFlat
+typedef struct
+{
+	lumpnum_t lump;
+	UINT8 *mips[MIPLEVELS]; // [0] is the full size flat, all are locked while in use
+	INT32 bits, levels, level;
+	UINT32 mask, xshift, yshift, shiftup; // full size values
+} planeflat_t;
+
+// the flat spans are being drawn from
+static THREADLOCAL planeflat_t planeflat;
 
 //
 // R_InitPlanes
@@ -176,7 +192,7 @@ void R_PortalRestoreClipValues(INT32 start, INT32 end, INT16 *ceil, INT16 *floor
 static INT32 bgofs;
 static INT32 wtofs=0;
 static INT32 waterofs;
-static boolean itswater;
+static THREADLOCAL boolean itswater;
 #endif
 
 #ifndef NOWATER
@@ -258,6 +274,36 @@ static void R_DrawTranslucentWaterSpan_8(void)
 }
 #endif
 
+//
+// R_SetPlaneMipLevel
+// Picks the mip level for a span from how many texels it steps per pixel.
+// Only the source and the shifts change; fracs and steps stay in full size
+// texels, so nflatshiftup is left alone.
+//
+static void R_SetPlaneMipLevel(fixed_t step)
+{
+	INT32 level = 0;
+
+	while (level + 1 < planeflat.levels && step >= (FRACUNIT << (level + 1)))
+		level++;
+
+	if (level == planeflat.level)
+		return;
+
+	if (!planeflat.mips[level])
+	{
+		// Keep it around until the plane is done, other levels may be generated meanwhile.
+		planeflat.mips[level] = R_GetFlatMipmap(planeflat.lump, planeflat.mips[0], planeflat.bits, level);
+		Z_ChangeTag(planeflat.mips[level], PU_STATIC);
+	}
+
+	ds_source = planeflat.mips[level];
+	nflatxshift = planeflat.xshift + level;
+	nflatyshift = planeflat.yshift + 2*level;
+	nflatmask = ((1 << (planeflat.bits - level)) - 1) << (planeflat.bits - level);
+	planeflat.level = level;
+}
+
 void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 {
 	angle_t angle, planecos, planesin;
@@ -322,6 +368,9 @@ void R_MapPlane(INT32 y, INT32 x1, INT32 x2)
 	if (pindex >= MAXLIGHTZ)
 		pindex = MAXLIGHTZ - 1;
 
+	if (planeflat.levels > 1)
+		R_SetPlaneMipLevel(max(abs(ds_xstep), abs(ds_ystep)));
+
 
 	if (currentplane->slope)
 		ds_colormap = colormaps;
@@ -613,6 +662,123 @@ void R_ExpandPlane(visplane_t *pl, INT32 start, INT32 stop)
 	pl->minx = unionl, pl->maxx = unionh;
 }
 
+//
+// R_CachePlaneFlat
+// Loads a plane's flat, locked, and works out the span drawer parameters
+// for its size. With allmips, every mip level the plane can use is made
+// up front, so drawing it never has to allocate.
+//
+static void R_CachePlaneFlat(visplane_t *pl, planeflat_t *flat, boolean allmips)
+{
+	size_t size;
+	INT32 i;
+
+	flat->lump = levelflats[pl->picnum].lumpnum;
+	flat->mips[0] = W_CacheLumpNum(flat->lump, PU_STATIC); // Stay here until R_ReleasePlaneFlat
+	for (i = 1; i < MIPLEVELS; i++)
+		flat->mips[i] = NULL;
+	flat->level = 0;
+
+	size = W_LumpLength(flat->lump);
+
+	switch (size)
+	{
+		case 4194304: // 2048x2048 lump
+			flat->mask = 0x3FF800;
+			flat->xshift = 21;
+			flat->yshift = 10;
+			flat->shiftup = 5;
+			flat->bits = 11;
+			break;
+		case 1048576: // 1024x1024 lump
+			flat->mask = 0xFFC00;
+			flat->xshift = 22;
+			flat->yshift = 12;
+			flat->shiftup = 6;
+			flat->bits = 10;
+			break;
+		case 262144:// 512x512 lump'
+			flat->mask = 0x3FE00;
+			flat->xshift = 23;
+			flat->yshift = 14;
+			flat->shiftup = 7;
+			flat->bits = 9;
+			break;
+		case 65536: // 256x256 lump
+			flat->mask = 0xFF00;
+			flat->xshift = 24;
+			flat->yshift = 16;
+			flat->shiftup = 8;
+			flat->bits = 8;
+			break;
+		case 16384: // 128x128 lump
+			flat->mask = 0x3F80;
+			flat->xshift = 25;
+			flat->yshift = 18;
+			flat->shiftup = 9;
+			flat->bits = 7;
+			break;
+		case 1024: // 32x32 lump
+			flat->mask = 0x3E0;
+			flat->xshift = 27;
+			flat->yshift = 22;
+			flat->shiftup = 11;
+			flat->bits = 5;
+			break;
+		default: // 64x64 lump
+			flat->mask = 0xFC0;
+			flat->xshift = 26;
+			flat->yshift = 20;
+			flat->shiftup = 10;
+			flat->bits = (size == 4096) ? 6 : 0; // odd sizes are drawn as-is
+			break;
+	}
+
+	// Sloped planes go through their own drawers, and don't get mipmaps.
+	// Stop at 8x8, anything smaller is just a smear.
+	flat->levels = 1;
+	if (cv_mipmapping.value && !pl->slope && flat->bits > 3)
+		flat->levels = min(MIPLEVELS, flat->bits - 2);
+
+	if (allmips)
+	{
+		for (i = 1; i < flat->levels; i++)
+		{
+			flat->mips[i] = R_GetFlatMipmap(flat->lump, flat->mips[0], flat->bits, i);
+			Z_ChangeTag(flat->mips[i], PU_STATIC);
+		}
+	}
+}
+
+// Draws the following spans from the full size version of a cached flat.
+static void R_SetPlaneFlat(const planeflat_t *flat)
+{
+	planeflat = *flat;
+	ds_source = planeflat.mips[0];
+	nflatmask = planeflat.mask;
+	nflatxshift = planeflat.xshift;
+	nflatyshift = planeflat.yshift;
+	nflatshiftup = planeflat.shiftup;
+}
+
+static void R_ReleasePlaneFlat(const planeflat_t *flat)
+{
+	INT32 i;
+	for (i = 0; i < MIPLEVELS; i++)
+		if (flat->mips[i])
+			Z_ChangeTag(flat->mips[i], PU_CACHE);
+}
+
+// Starts the span cache over for planes seen from angle.
+static void R_SetPlaneAngle(angle_t angle)
+{
+	const INT32 fineangle = (angle-ANGLE_90)>>ANGLETOFINESHIFT;
+
+	memset(cachedheight, 0, sizeof (cachedheight));
+	basexscale = FixedDiv(FINECOSINE(fineangle),centerxfrac);
+	baseyscale = -FixedDiv(FINESINE(fineangle),centerxfrac);
+}
+
 //
 // R_MakeSpans
 //
@@ -642,12 +808,144 @@ void R_MakeSpans(INT32 x, INT32 t1, INT32 b1, INT32 t2, INT32 b2)
 		spanstart[b2--] = x;
 }
 
+#ifdef HAVE_THREADS
+// The opaque flats of a view never overlap one another, so they can be
+// drawn in any order, by any thread. R_DrawPlanes does all the setup that
+// touches the zone or level data on the main thread, and leaves only the
+// span drawing to the workers.
+typedef struct
+{
+	visplane_t *pl;
+	planeflat_t flat;
+	INT32 light;
+} planejob_t;
+
+static planejob_t *planejobs;
+static size_t numplanejobs, maxplanejobs;
+
+// Which batch of jobs each thread's span cache was made for
+static UINT32 planebatch;
+static THREADLOCAL UINT32 planecachebatch;
+static THREADLOCAL angle_t planecacheangle;
+
+static void R_QueuePlaneJob(visplane_t *pl)
+{
+	planejob_t *job;
+	INT32 light = (pl->lightlevel >> LIGHTSEGSHIFT);
+
+	if (numplanejobs >= maxplanejobs)
+	{
+		maxplanejobs = maxplanejobs ? maxplanejobs*2 : 128;
+		planejobs = Z_Realloc(planejobs, maxplanejobs * sizeof (*planejobs), PU_STATIC, NULL);
+	}
+
+	if (light >= LIGHTLEVELS)
+		light = LIGHTLEVELS-1;
+
+	if (light < 0)
+		light = 0;
+
+	job = &planejobs[numplanejobs++];
+	job->pl = pl;
+	job->light = light;
+	R_CachePlaneFlat(pl, &job->flat, true);
+}
+
+static void R_DrawPlaneJob(int index, void *userdata)
+{
+	const planejob_t *job = (planejob_t *)userdata + index;
+	visplane_t *pl = job->pl;
+	const angle_t angle = pl->viewangle + pl->plangle;
+	INT32 x, stop;
+
+	if (planecachebatch != planebatch || planecacheangle != angle)
+	{
+		R_SetPlaneAngle(angle);
+		planecachebatch = planebatch;
+		planecacheangle = angle;
+	}
+
+	currentplane = pl;
+	R_SetPlaneFlat(&job->flat);
+#ifndef NOWATER
+	itswater = false;
+#endif
+
+	xoffs = pl->xoffs;
+	yoffs = pl->yoffs;
+	planeheight = abs(pl->height - pl->viewz);
+	planezlight = zlight[job->light];
+
+	// set the maximum value for unsigned
+	pl->top[pl->maxx+1] = 0xffff;
+	pl->top[pl->minx-1] = 0xffff;
+	pl->bottom[pl->maxx+1] = 0x0000;
+	pl->bottom[pl->minx-1] = 0x0000;
+
+	stop = pl->maxx + 1;
+
+	for (x = pl->minx; x <= stop; x++)
+	{
+		R_MakeSpans(x, pl->top[x-1], pl->bottom[x-1],
+			pl->top[x], pl->bottom[x]);
+	}
+}
+
+//
+// R_DrawPlaneJobs
+// Draws the queued planes on cv_renderthreads threads, then leaves the view
+// the way drawing them one by one with R_DrawSinglePlane would have.
+// lastjob is the job of the last plane in drawing order, or -1 if that
+// plane was drawn on the main thread.
+//
+static void R_DrawPlaneJobs(INT32 lastjob)
+{
+	const visplane_t *pl = planejobs[numplanejobs-1].pl;
+	const planeflat_t mainflat = planeflat;
+	void (*mainspanfunc)(void) = spanfunc;
+	size_t i;
+
+	// The main thread draws too, so its span cache is used up as well.
+	planebatch++;
+	spanfunc = basespanfunc;
+	I_ParallelFor((int)numplanejobs, cv_renderthreads.value, R_DrawPlaneJob, planejobs);
+
+	for (i = 0; i < numplanejobs; i++)
+		R_ReleasePlaneFlat(&planejobs[i].flat);
+
+	// Every flat sets the view angle, the last one wins.
+	viewangle = pl->viewangle + pl->plangle;
+	R_SetPlaneAngle(viewangle);
+	planecachebatch = 0;
+
+	if (lastjob != -1)
+	{
+		pl = planejobs[lastjob].pl;
+		viewx = pl->viewx;
+		viewy = pl->viewy;
+		viewz = pl->viewz;
+		R_SetPlaneFlat(&planejobs[lastjob].flat);
+	}
+	else
+	{
+		spanfunc = mainspanfunc;
+		R_SetPlaneFlat(&mainflat);
+	}
+
+	numplanejobs = 0;
+}
+#endif
+
 void R_DrawPlanes(void)
 {
 	visplane_t *pl;
 	INT32 x;
 	INT32 angle;
 	INT32 i;
+#ifdef HAVE_THREADS
+	const boolean threaded = (cv_renderthreads.value > 1);
+	INT32 lastjob = -1;
+#endif
 
 	spanfunc = basespanfunc;
 	wallcolfunc = walldrawerfunc;
@@ -697,9 +995,28 @@ void R_DrawPlanes(void)
 			if (pl->ffloor != NULL || pl->polyobj != NULL)
 				continue;
 
+			if (!(pl->minx <= pl->maxx))
+				continue;
+
+#ifdef HAVE_THREADS
+			// Sloped planes still need the main thread.
+			if (threaded && !pl->slope)
+			{
+				R_QueuePlaneJob(pl);
+				lastjob = (INT32)numplanejobs - 1;
+				continue;
+			}
+			lastjob = -1;
+#endif
+
 			R_DrawSinglePlane(pl);
 		}
 	}
+
+#ifdef HAVE_THREADS
+	if (numplanejobs)
+		R_DrawPlaneJobs(lastjob);
+#endif
 #ifndef NOWATER
 	waterofs = (leveltime & 1)*16384;
 	wtofs = leveltime * 140;
@@ -710,8 +1027,8 @@ void R_DrawSinglePlane(visplane_t *pl)
 {
 	INT32 light = 0;
 	INT32 x;
-	INT32 stop, angle;
-	size_t size;
+	INT32 stop;
+	planeflat_t flat;
 	ffloor_t *rover;
 
 	if (!(pl->minx <= pl->maxx))
@@ -839,66 +1156,14 @@ void R_DrawSinglePlane(visplane_t *pl)
 	if (!pl->slope) // Don't mess with angle on slopes! We'll handle this ourselves later
 	if (viewangle != pl->viewangle+pl->plangle)
 	{
-		memset(cachedheight, 0, sizeof (cachedheight));
-		angle = (pl->viewangle+pl->plangle-ANGLE_90)>>ANGLETOFINESHIFT;
-		basexscale = FixedDiv(FINECOSINE(angle),centerxfrac);
-		baseyscale = -FixedDiv(FINESINE(angle),centerxfrac);
 		viewangle = pl->viewangle+pl->plangle;
+		R_SetPlaneAngle(viewangle);
 	}
 
 	currentplane = pl;
 
-	ds_source = (UINT8 *)
-		W_CacheLumpNum(levelflats[pl->picnum].lumpnum,
-			PU_STATIC); // Stay here until Z_ChangeTag
-
-	size = W_LumpLength(levelflats[pl->picnum].lumpnum);
-
-	switch (size)
-	{
-		case 4194304: // 2048x2048 lump
-			nflatmask = 0x3FF800;
-			nflatxshift = 21;
-			nflatyshift = 10;
-			nflatshiftup = 5;
-			break;
-		case 1048576: // 1024x1024 lump
-			nflatmask = 0xFFC00;
-			nflatxshift = 22;
-			nflatyshift = 12;
-			nflatshiftup = 6;
-			break;
-		case 262144:// 512x512 lump'
-			nflatmask = 0x3FE00;
-			nflatxshift = 23;
-			nflatyshift = 14;
-			nflatshiftup = 7;
-			break;
-		case 65536: // 256x256 lump
-			nflatmask = 0xFF00;
-			nflatxshift = 24;
-			nflatyshift = 16;
-			nflatshiftup = 8;
-			break;
-		case 16384: // 128x128 lump
-			nflatmask = 0x3F80;
-			nflatxshift = 25;
-			nflatyshift = 18;
-			nflatshiftup = 9;
-			break;
-		case 1024: // 32x32 lump
-			nflatmask = 0x3E0;
-			nflatxshift = 27;
-			nflatyshift = 22;
-			nflatshiftup = 11;
-			break;
-		default: // 64x64 lump
-			nflatmask = 0xFC0;
-			nflatxshift = 26;
-			nflatyshift = 20;
-			nflatshiftup = 10;
-			break;
-	}
+	R_CachePlaneFlat(pl, &flat, false);
+	R_SetPlaneFlat(&flat);
 
 	xoffs = pl->xoffs;
 	yoffs = pl->yoffs;
@@ -1105,7 +1370,10 @@ using the palette colors.
 	}
 #endif
 
-	Z_ChangeTag(ds_source, PU_CACHE);
+	R_ReleasePlaneFlat(&planeflat);
+
+	// Leave the full size flat behind for whoever draws spans next.
+	R_SetPlaneFlat(&flat);
 }
 
 void R_PlaneBounds(visplane_t *plane)
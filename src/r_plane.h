@@ -58,14 +58,16 @@ extern size_t maxopenings;
 
 extern INT16 floorclip[MAXVIDWIDTH], ceilingclip[MAXVIDWIDTH];
 extern fixed_t frontscale[MAXVIDWIDTH], yslopetab[MAXVIDHEIGHT*16];
-extern fixed_t cachedheight[MAXVIDHEIGHT];
-extern fixed_t cacheddistance[MAXVIDHEIGHT];
-extern fixed_t cachedxstep[MAXVIDHEIGHT];
-extern fixed_t cachedystep[MAXVIDHEIGHT];
-extern fixed_t basexscale, baseyscale;
+
+// Span drawing state, each thread drawing flats has its own
+extern THREADLOCAL fixed_t cachedheight[MAXVIDHEIGHT];
+extern THREADLOCAL fixed_t cacheddistance[MAXVIDHEIGHT];
+extern THREADLOCAL fixed_t cachedxstep[MAXVIDHEIGHT];
+extern THREADLOCAL fixed_t cachedystep[MAXVIDHEIGHT];
+extern THREADLOCAL fixed_t basexscale, baseyscale;
+extern THREADLOCAL lighttable_t **planezlight;
 
 extern fixed_t *yslope;
-extern lighttable_t **planezlight;
 
 void R_InitPlanes(void);
 void R_PortalStoreClipValues(INT32 start, INT32 end, INT16 *ceil, INT16 *floor, fixed_t *scale);
@@ -54,6 +54,7 @@ static INT32 worldtop, worldbottom, worldhigh, worldlow;
 static INT32 worldtopslope, worldbottomslope, worldhighslope, worldlowslope; // worldtop/bottom at end of slope
 static fixed_t rw_toptextureslide, rw_midtextureslide, rw_bottomtextureslide; // Defines how to adjust Y offsets along the wall for slopes
 static fixed_t rw_midtextureback, rw_midtexturebackslide; // Values for masked midtexture height calculation
+static fixed_t rw_iscale; // full size texture step of the current column, before mipmapping
 static fixed_t pixhigh, pixlow, pixhighstep, pixlowstep;
 static fixed_t topfrac, topstep;
 static fixed_t bottomfrac, bottomstep;
@@ -1176,35 +1177,149 @@ UINT32 nombre = 100000;
 //profile stuff ---------------------------------------------------------
 
 
-static void R_RenderSegLoop (void)
+//
+// R_SetupWallColumn
+// Points the column drawer at one wall tier, using a smaller mip level
+// of the texture once the wall is far enough away to skip texels.
+//
+static void R_SetupWallColumn(INT32 tex, fixed_t texturemid, INT32 texturecolumn)
 {
+	INT32 level = 0;
+
+	if (cv_mipmapping.value && rw_iscale >= FRACUNIT<<1)
+	{
+		const INT32 levels = R_TextureMipLevels(tex);
+		while (level + 1 < levels && rw_iscale >= (FRACUNIT << (level + 1)))
+			level++;
+	}
+
+	dc_iscale = rw_iscale >> level;
+	dc_texturemid = texturemid >> level;
+	dc_source = R_GetColumnMipmap(tex, texturecolumn, level);
+	dc_texheight = (textureheight[tex]>>FRACBITS) >> level;
+}
+
+// Per-column values for the seg being drawn, filled by R_SetupSegColumns
+static fixed_t segscale[MAXVIDWIDTH];
+static fixed_t segiscale[MAXVIDWIDTH];
+static fixed_t segtexcol[MAXVIDWIDTH]; // texture column, still in FRACBITS
+static INT32 segyl[MAXVIDWIDTH], segyh[MAXVIDWIDTH]; // wall extents, clipped
+static UINT8 seglight[MAXVIDWIDTH]; // index into the scalelight tables
+
+//
+// R_SetupSegColumns
+// Steps the scale, wall edges, texture column and light index across the
+// whole seg up front. None of these depend on anything drawn, and with the
+// branches of the drawing loop out of the way the compiler can vectorise
+// most of it.
+//
+static void R_SetupSegColumns(void)
+{
+	const fixed_t lightfix = LIGHTRESOLUTIONFIX;
+	fixed_t scale = rw_scale, top = topfrac, bottom = bottomfrac;
 	angle_t angle;
-	size_t  pindex;
+	INT32 x, yl, yh;
+	UINT32 pindex;
+
+	for (x = rw_x; x < rw_stopx; x++)
+	{
+		segscale[x] = scale;
+
+		yl = (top+HEIGHTUNIT-1)>>HEIGHTBITS;
+		if (yl < ceilingclip[x]+1)
+			yl = ceilingclip[x]+1;
+		segyl[x] = yl;
+
+		yh = bottom>>HEIGHTBITS;
+		if (yh > floorclip[x]-1)
+			yh = floorclip[x]-1;
+		segyh[x] = yh;
+
+		scale += rw_scalestep;
+		top += topstep;
+		bottom += bottomstep;
+	}
+
+	//SoM: Calculate offsets for Thick fake floors.
+	// calculate texture offset
+	for (x = rw_x; x < rw_stopx; x++)
+	{
+		angle = (rw_centerangle + xtoviewangle[x])>>ANGLETOFINESHIFT;
+		segtexcol[x] = rw_offset-FixedMul(FINETANGENT(angle),rw_distance);
+	}
+
+	// texturecolumn and lighting are independent of wall tiers
+	if (segtextured || dc_numlights)
+	{
+		for (x = rw_x; x < rw_stopx; x++)
+		{
+			pindex = FixedMul(segscale[x], lightfix)>>LIGHTSCALESHIFT;
+			seglight[x] = (UINT8)(pindex < MAXLIGHTSCALE ? pindex : MAXLIGHTSCALE-1);
+		}
+	}
+
+	if (segtextured)
+	{
+		for (x = rw_x; x < rw_stopx; x++)
+			segiscale[x] = 0xffffffffu / (unsigned)segscale[x];
+	}
+
+	rw_scale = scale;
+	topfrac = top;
+	bottomfrac = bottom;
+}
+
+static void R_RenderSegLoop (void)
+{
 	INT32     yl;
 	INT32     yh;
 
 	INT32     mid;
-	fixed_t texturecolumn = 0;
-	fixed_t oldtexturecolumn = -1;
+	INT32     texturecolumn;
+	fixed_t   slide;
 
 	INT32     top;
 	INT32     bottom;
 	INT32     i;
+	const INT32 x1 = rw_x;
 
-	for (; rw_x < rw_stopx; rw_x++)
+	R_SetupSegColumns();
+
+	// the light a shadow casts on the wall is the same all the way along it
+	if (dc_numlights)
 	{
-		// mark floor / ceiling areas
-		yl = (topfrac+HEIGHTUNIT-1)>>HEIGHTBITS;
+		for (i = 0; i < dc_numlights; i++)
+		{
+			INT32 lightnum;
+			lightnum = (dc_lightlist[i].lightlevel >> LIGHTSEGSHIFT);
+
+			if (dc_lightlist[i].extra_colormap)
+				;
+			else if (curline->v1->y == curline->v2->y)
+				lightnum--;
+			else if (curline->v1->x == curline->v2->x)
+				lightnum++;
 
-		// no space above wall?
-		top = ceilingclip[rw_x]+1;
+			if (lightnum < 0)
+				lightnum = 0;
+			else if (lightnum >= LIGHTLEVELS)
+				lightnum = LIGHTLEVELS-1;
 
-		// no space above wall?
-		if (yl < top)
-			yl = top;
+			dc_lightlist[i].lightnum = lightnum;
+		}
+
+		colfunc = R_DrawColumnShadowed_8;
+	}
+
+	for (; rw_x < rw_stopx; rw_x++)
+	{
+		// mark floor / ceiling areas
+		yl = segyl[rw_x];
+		yh = segyh[rw_x];
 
 		if (markceiling)
 		{
+			top = ceilingclip[rw_x]+1;
 			bottom = yl-1;
 
 			if (bottom >= floorclip[rw_x])
@@ -1217,14 +1332,8 @@ static void R_RenderSegLoop (void)
 			}
 		}
 
-
-		yh = bottomfrac>>HEIGHTBITS;
-
 		bottom = floorclip[rw_x]-1;
 
-		if (yh > bottom)
-			yh = bottom;
-
 		if (markfloor)
 		{
 			top = yh < ceilingclip[rw_x] ? ceilingclip[rw_x] : yh;
@@ -1302,76 +1411,38 @@ static void R_RenderSegLoop (void)
 			}
 		}
 
-		//SoM: Calculate offsets for Thick fake floors.
-		// calculate texture offset
-		angle = (rw_centerangle + xtoviewangle[rw_x])>>ANGLETOFINESHIFT;
-		texturecolumn = rw_offset-FixedMul(FINETANGENT(angle),rw_distance);
-
-
-		if (oldtexturecolumn != -1) {
-			rw_bottomtexturemid += FixedMul(rw_bottomtextureslide,  oldtexturecolumn-texturecolumn);
-			rw_midtexturemid    += FixedMul(rw_midtextureslide,     oldtexturecolumn-texturecolumn);
-			rw_toptexturemid    += FixedMul(rw_toptextureslide,     oldtexturecolumn-texturecolumn);
-			rw_midtextureback   += FixedMul(rw_midtexturebackslide, oldtexturecolumn-texturecolumn);
+		if (rw_x > x1)
+		{
+			slide = segtexcol[rw_x-1] - segtexcol[rw_x];
+			rw_bottomtexturemid += FixedMul(rw_bottomtextureslide,  slide);
+			rw_midtexturemid    += FixedMul(rw_midtextureslide,     slide);
+			rw_toptexturemid    += FixedMul(rw_toptextureslide,     slide);
+			rw_midtextureback   += FixedMul(rw_midtexturebackslide, slide);
 		}
-		oldtexturecolumn = texturecolumn;
 
-		texturecolumn >>= FRACBITS;
+		texturecolumn = segtexcol[rw_x]>>FRACBITS;
 
-		// texturecolumn and lighting are independent of wall tiers
 		if (segtextured)
 		{
-			// calculate lighting
-			pindex = FixedMul(rw_scale, LIGHTRESOLUTIONFIX)>>LIGHTSCALESHIFT;
-
-			if (pindex >=  MAXLIGHTSCALE)
-				pindex = MAXLIGHTSCALE-1;
-
-			dc_colormap = walllights[pindex];
+			dc_colormap = walllights[seglight[rw_x]];
 			dc_x = rw_x;
-			dc_iscale = 0xffffffffu / (unsigned)rw_scale;
+			dc_iscale = rw_iscale = segiscale[rw_x];
 
 			if (frontsector->extra_colormap)
 				dc_colormap = frontsector->extra_colormap->colormap + (dc_colormap - colormaps);
 		}
 
-		if (dc_numlights)
+		for (i = 0; i < dc_numlights; i++)
 		{
-			lighttable_t **xwalllights;
-			for (i = 0; i < dc_numlights; i++)
-			{
-				INT32 lightnum;
-				lightnum = (dc_lightlist[i].lightlevel >> LIGHTSEGSHIFT);
-
-				if (dc_lightlist[i].extra_colormap)
-					;
-				else if (curline->v1->y == curline->v2->y)
-					lightnum--;
-				else if (curline->v1->x == curline->v2->x)
-					lightnum++;
-
-				if (lightnum < 0)
-					xwalllights = scalelight[0];
-				else if (lightnum >= LIGHTLEVELS)
-					xwalllights = scalelight[LIGHTLEVELS-1];
-				else
-					xwalllights = scalelight[lightnum];
-
-				pindex = FixedMul(rw_scale, LIGHTRESOLUTIONFIX)>>LIGHTSCALESHIFT;
-
-				if (pindex >=  MAXLIGHTSCALE)
-					pindex = MAXLIGHTSCALE-1;
+			lighttable_t *xwalllight = scalelight[dc_lightlist[i].lightnum][seglight[rw_x]];
 
-				if (dc_lightlist[i].extra_colormap)
-					dc_lightlist[i].rcolormap = dc_lightlist[i].extra_colormap->colormap + (xwalllights[pindex] - colormaps);
-				else
-					dc_lightlist[i].rcolormap = xwalllights[pindex];
-
-				colfunc = R_DrawColumnShadowed_8;
-			}
+			if (dc_lightlist[i].extra_colormap)
+				dc_lightlist[i].rcolormap = dc_lightlist[i].extra_colormap->colormap + (xwalllight - colormaps);
+			else
+				dc_lightlist[i].rcolormap = xwalllight;
 		}
 
-		frontscale[rw_x] = rw_scale;
+		frontscale[rw_x] = segscale[rw_x];
 
 		// draw the wall tiers
 		if (midtexture)
@@ -1381,9 +1452,7 @@ static void R_RenderSegLoop (void)
 			{
 				dc_yl = yl;
 				dc_yh = yh;
-				dc_texturemid = rw_midtexturemid;
-				dc_source = R_GetColumn(midtexture,texturecolumn);
-				dc_texheight = textureheight[midtexture]>>FRACBITS;
+				R_SetupWallColumn(midtexture, rw_midtexturemid, texturecolumn);
 
 				//profile stuff ---------------------------------------------------------
 #ifdef TIMING
@@ -1434,9 +1503,7 @@ static void R_RenderSegLoop (void)
 					{
 						dc_yl = yl;
 						dc_yh = mid;
-						dc_texturemid = rw_toptexturemid;
-						dc_source = R_GetColumn(toptexture,texturecolumn);
-						dc_texheight = textureheight[toptexture]>>FRACBITS;
+						R_SetupWallColumn(toptexture, rw_toptexturemid, texturecolumn);
 						colfunc();
 						ceilingclip[rw_x] = (INT16)mid;
 					}
@@ -1467,10 +1534,7 @@ static void R_RenderSegLoop (void)
 					{
 						dc_yl = mid;
 						dc_yh = yh;
-						dc_texturemid = rw_bottomtexturemid;
-						dc_source = R_GetColumn(bottomtexture,
-							texturecolumn);
-						dc_texheight = textureheight[bottomtexture]>>FRACBITS;
+						R_SetupWallColumn(bottomtexture, rw_bottomtexturemid, texturecolumn);
 						colfunc();
 						floorclip[rw_x] = (INT16)mid;
 					}
@@ -1518,9 +1582,6 @@ static void R_RenderSegLoop (void)
 			ffloor[i].b_frac += ffloor[i].b_step;
 		}
 
-		rw_scale += rw_scalestep;
-		topfrac += topstep;
-		bottomfrac += bottomstep;
 	}
 }
 
@@ -1559,6 +1620,7 @@ void R_StoreWallRange(INT32 start, INT32 stop)
 	INT32 range;
 	vertex_t segleft, segright;
 	fixed_t ceilingfrontslide, floorfrontslide, ceilingbackslide, floorbackslide;
+	precise_t segtime;
 
 	static size_t maxdrawsegs = 0;
 
@@ -2758,6 +2820,7 @@ void R_StoreWallRange(INT32 start, INT32 stop)
 		}
 	}
 
+	segtime = I_GetPreciseTime();
 #ifdef WALLSPLATS
 	if (linedef->splats && cv_splats.value)
 	{
@@ -2773,6 +2836,7 @@ void R_StoreWallRange(INT32 start, INT32 stop)
 #endif
 		R_RenderSegLoop();
 	colfunc = wallcolfunc;
+	ps_sw_seglooptime.value.p += I_GetPreciseTime() - segtime;
 
 	if (portalline) // if curline is a portal, set portalrender for drawseg
 		ds_p->portalpass = portalrender+1;
@@ -80,5 +80,11 @@ void R_SetupSkyDraw(void)
 void R_SetSkyScale(void)
 {
 	fixed_t difference = vid.fdupx-(vid.dupx<<FRACBITS);
-	skyscale = FixedDiv(fovtan, vid.fdupx+difference);
+	fixed_t dup = vid.fdupx+difference;
+
+	// The view may be drawn at a lower internal resolution.
+	if (viewwidth != scaledviewwidth)
+		dup = FixedMul(dup, FixedDiv(viewwidth<<FRACBITS, scaledviewwidth<<FRACBITS));
+
+	skyscale = FixedDiv(fovtan, dup);
 }
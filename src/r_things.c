@@ -622,10 +622,62 @@ INT16 *mceilingclip;
 fixed_t spryscale = 0, sprtopscreen = 0, sprbotscreen = 0;
 fixed_t windowtop = 0, windowbottom = 0;
 
-void R_DrawMaskedColumn(column_t *column)
+// Draws one post of a masked column, topdelta pixels down the patch.
+static void R_DrawMaskedPost(UINT8 *source, INT32 topdelta, INT32 length, fixed_t basetexturemid)
 {
 	INT32 topscreen;
 	INT32 bottomscreen;
+
+	// calculate unclipped screen coordinates
+	// for post
+	topscreen = sprtopscreen + spryscale*topdelta;
+	bottomscreen = topscreen + spryscale*length;
+
+	dc_yl = (topscreen+FRACUNIT-1)>>FRACBITS;
+	dc_yh = (bottomscreen-1)>>FRACBITS;
+
+	if (windowtop != INT32_MAX && windowbottom != INT32_MAX)
+	{
+		if (windowtop > topscreen)
+			dc_yl = (windowtop + FRACUNIT - 1)>>FRACBITS;
+		if (windowbottom < bottomscreen)
+			dc_yh = (windowbottom - 1)>>FRACBITS;
+	}
+
+	if (dc_yh >= mfloorclip[dc_x])
+		dc_yh = mfloorclip[dc_x]-1;
+	if (dc_yl <= mceilingclip[dc_x])
+		dc_yl = mceilingclip[dc_x]+1;
+	if (dc_yl < 0)
+		dc_yl = 0;
+	if (dc_yh >= vid.height)
+		dc_yh = vid.height - 1;
+
+	if (dc_yl <= dc_yh && dc_yl < vid.height && dc_yh > 0)
+	{
+		dc_source = source;
+		dc_texturemid = basetexturemid - (topdelta<<FRACBITS);
+
+		// Drawn by R_DrawColumn.
+		// This stuff is a likely cause of the splitscreen water crash bug.
+		// FIXTHIS: Figure out what "something more proper" is and do it.
+		// quick fix... something more proper should be done!!!
+		if (ylookup[dc_yl])
+			colfunc();
+		else if (colfunc == R_DrawColumn_8)
+		{
+			static INT32 first = 1;
+			if (first)
+			{
+				CONS_Debug(DBG_RENDER, "WARNING: avoiding a crash in %s %d\n", __FILE__, __LINE__);
+				first = 0;
+			}
+		}
+	}
+}
+
+void R_DrawMaskedColumn(column_t *column)
+{
 	fixed_t basetexturemid;
 	INT32 topdelta, prevdelta = 0;
 
@@ -633,58 +685,26 @@ void R_DrawMaskedColumn(column_t *column)
 
 	for (; column->topdelta != 0xff ;)
 	{
-		// calculate unclipped screen coordinates
-		// for post
 		topdelta = column->topdelta;
 		if (topdelta <= prevdelta)
 			topdelta += prevdelta;
 		prevdelta = topdelta;
-		topscreen = sprtopscreen + spryscale*topdelta;
-		bottomscreen = topscreen + spryscale*column->length;
-
-		dc_yl = (topscreen+FRACUNIT-1)>>FRACBITS;
-		dc_yh = (bottomscreen-1)>>FRACBITS;
-
-		if (windowtop != INT32_MAX && windowbottom != INT32_MAX)
-		{
-			if (windowtop > topscreen)
-				dc_yl = (windowtop + FRACUNIT - 1)>>FRACBITS;
-			if (windowbottom < bottomscreen)
-				dc_yh = (windowbottom - 1)>>FRACBITS;
-		}
+		R_DrawMaskedPost((UINT8 *)column + 3, topdelta, column->length, basetexturemid);
+		column = (column_t *)((UINT8 *)column + column->length + 4);
+	}
 
-		if (dc_yh >= mfloorclip[dc_x])
-			dc_yh = mfloorclip[dc_x]-1;
-		if (dc_yl <= mceilingclip[dc_x])
-			dc_yl = mceilingclip[dc_x]+1;
-		if (dc_yl < 0)
-			dc_yl = 0;
-		if (dc_yh >= vid.height)
-			dc_yh = vid.height - 1;
+	dc_texturemid = basetexturemid;
+}
 
-		if (dc_yl <= dc_yh && dc_yl < vid.height && dc_yh > 0)
-		{
-			dc_source = (UINT8 *)column + 3;
-			dc_texturemid = basetexturemid - (topdelta<<FRACBITS);
+// R_DrawMaskedColumn for patches cached with their posts decoded.
+static void R_DrawPatchPosts(patch_t *patch, const patchposts_t *posts, INT32 col)
+{
+	const fixed_t basetexturemid = dc_texturemid;
+	const patchpost_t *post = posts->posts + posts->columnposts[col];
+	const patchpost_t *end = posts->posts + posts->columnposts[col+1];
 
-			// Drawn by R_DrawColumn.
-			// This stuff is a likely cause of the splitscreen water crash bug.
-			// FIXTHIS: Figure out what "something more proper" is and do it.
-			// quick fix... something more proper should be done!!!
-			if (ylookup[dc_yl])
-				colfunc();
-			else if (colfunc == R_DrawColumn_8)
-			{
-				static INT32 first = 1;
-				if (first)
-				{
-					CONS_Debug(DBG_RENDER, "WARNING: avoiding a crash in %s %d\n", __FILE__, __LINE__);
-					first = 0;
-				}
-			}
-		}
-		column = (column_t *)((UINT8 *)column + column->length + 4);
-	}
+	for (; post < end; post++)
+		R_DrawMaskedPost((UINT8 *)patch + post->ofs, post->topdelta, post->length, basetexturemid);
 
 	dc_texturemid = basetexturemid;
 }
@@ -768,7 +788,8 @@ static void R_DrawVisSprite(vissprite_t *vis)
 	INT32 texturecolumn;
 #endif
 	fixed_t frac;
-	patch_t *patch = W_CacheLumpNum(vis->patch, PU_CACHE);
+	patch_t *patch = W_CachePatchNum(vis->patch, PU_CACHE);
+	const patchposts_t *posts = W_GetPatchPosts(patch);
 	fixed_t this_scale = vis->thingscale;
 	INT32 x1, x2;
 	INT64 overflow_test;
@@ -892,10 +913,13 @@ static void R_DrawVisSprite(vissprite_t *vis)
 
 		if (texturecolumn < 0 || texturecolumn >= SHORT(patch->width))
 			I_Error("R_DrawSpriteRange: bad texturecolumn");
-		column = (column_t *)((UINT8 *)patch + LONG(patch->columnofs[texturecolumn]));
-#else
-		column = (column_t *)((UINT8 *)patch + LONG(patch->columnofs[frac>>FRACBITS]));
 #endif
+		if (posts && !vis->vflip)
+		{
+			R_DrawPatchPosts(patch, posts, frac>>FRACBITS);
+			continue;
+		}
+		column = (column_t *)((UINT8 *)patch + LONG(patch->columnofs[frac>>FRACBITS]));
 		if (vis->vflip)
 			R_DrawFlippedMaskedColumn(column, patch->height);
 		else
@@ -918,12 +942,14 @@ static void R_DrawPrecipitationVisSprite(vissprite_t *vis)
 #endif
 	fixed_t frac;
 	patch_t *patch;
+	const patchposts_t *posts;
 	INT64 overflow_test;
 
 	//Fab : R_InitSprites now sets a wad lump number
-	patch = W_CacheLumpNum(vis->patch, PU_CACHE);
+	patch = W_CachePatchNum(vis->patch, PU_CACHE);
 	if (!patch)
 		return;
+	posts = W_GetPatchPosts(patch);
 
 	// Check for overflow
 	overflow_test = (INT64)centeryfrac - (((INT64)vis->texturemid*vis->scale)>>FRACBITS);
@@ -960,11 +986,13 @@ static void R_DrawPrecipitationVisSprite(vissprite_t *vis)
 
 		if (texturecolumn < 0 || texturecolumn >= SHORT(patch->width))
 			I_Error("R_DrawPrecipitationSpriteRange: bad texturecolumn");
-
-		column = (column_t *)((UINT8 *)patch + LONG(patch->columnofs[texturecolumn]));
-#else
-		column = (column_t *)((UINT8 *)patch + LONG(patch->columnofs[frac>>FRACBITS]));
 #endif
+		if (posts)
+		{
+			R_DrawPatchPosts(patch, posts, frac>>FRACBITS);
+			continue;
+		}
+		column = (column_t *)((UINT8 *)patch + LONG(patch->columnofs[frac>>FRACBITS]));
 		R_DrawMaskedColumn(column);
 	}
 
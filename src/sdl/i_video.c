@@ -74,6 +74,13 @@
 #include "../i_video.h"
 #include "../console.h"
 #include "../command.h"
+#include "../r_main.h" // cv_renderthreads
+#ifdef HAVE_THREADS
+#include "../i_threads.h"
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 #include "sdlmain.h"
 #ifdef HWRENDER
 #include "../hardware/hw_main.h"
@@ -102,6 +109,9 @@ boolean highcolor = false;
 consvar_t cv_vidwait = {"vid_wait", "On", CV_SAVE, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
 static consvar_t cv_stretch = {"stretch", "Off", CV_SAVE|CV_NOSHOWHELP, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
 static consvar_t cv_alwaysgrabmouse = {"alwaysgrabmouse", "Off", CV_SAVE, CV_OnOff, NULL, 0, NULL, NULL, 0, 0, NULL};
+// convert software frames for display while the next tic runs
+static void CV_vidpipeline_OnChange(void);
+static consvar_t cv_vidpipeline = {"vid_pipeline", "Off", CV_SAVE|CV_CALL, CV_OnOff, CV_vidpipeline_OnChange, 0, NULL, NULL, 0, 0, NULL};
 
 UINT8 graphics_started = 0; // Is used in console.c and screen.c
 
@@ -147,6 +157,22 @@ SDL_Window   *window;
 SDL_Renderer *renderer;
 static SDL_Texture  *texture;
 static SDL_bool      havefocus = SDL_TRUE;
+
+// Frame pipeline, see I_FinishUpdate
+static UINT8        *pipeframe = NULL; // private copy of the frame being converted
+static INT32         pipeframewidth, pipeframeheight;
+static SDL_bool      pipepending = SDL_FALSE; // the texture is locked with a frame not presented yet
+static SDL_bool      pipebusy = SDL_FALSE; // the worker is still converting it
+#ifdef HAVE_THREADS
+static SDL_bool      pipeworker = SDL_FALSE; // the worker thread has been started
+static SDL_bool      pipequit = SDL_FALSE; // the worker thread has to return
+static mutex_t       pipe_mutex;
+static cond_t        pipe_cond; // a frame to convert, a frame converted, or time to quit
+#endif
+
+// Software frame conversion, see Impl_ExpandFrame
+static Uint32        texpalette[256]; // localPalette in the texture's pixel format
+static SDL_bool      texpalettedirty = SDL_TRUE;
 static const char *fallback_resolution_name = "Fallback";
 
 // windowed video modes from which to choose from.
@@ -177,6 +203,7 @@ static void Impl_VideoSetupBuffer(void);
 static SDL_bool Impl_CreateWindow(SDL_bool fullscreen);
 //static void Impl_SetWindowName(const char *title);
 static void Impl_SetWindowIcon(void);
+static void Impl_PipelineFlush(void);
 
 static void SDLSetMode(INT32 width, INT32 height, SDL_bool fullscreen, SDL_bool centerscreen)
 {
@@ -188,6 +215,8 @@ static void SDLSetMode(INT32 width, INT32 height, SDL_bool fullscreen, SDL_bool
 	int bpp = 16;
 	int sw_texture_format = SDL_PIXELFORMAT_ABGR8888;
 
+	Impl_PipelineFlush(); // vidSurface and the texture may be recreated
+
 	realwidth = vid.width;
 	realheight = vid.height;
 
@@ -258,6 +287,7 @@ static void SDLSetMode(INT32 width, INT32 height, SDL_bool fullscreen, SDL_bool
 		}
 
 		texture = SDL_CreateTexture(renderer, sw_texture_format, SDL_TEXTUREACCESS_STREAMING, width, height);
+		texpalettedirty = SDL_TRUE;
 
 		// Set up SW surface
 		if (vidSurface != NULL)
@@ -1208,11 +1238,296 @@ static inline boolean I_SkipFrame(void)
 #endif
 }
 
+static SDL_Rect src_rect = { 0, 0, 0, 0 };
+
+static void Impl_PresentTexture(void)
+{
+	SDL_RenderClear(renderer);
+	SDL_RenderCopy(renderer, texture, &src_rect, NULL);
+	SDL_RenderPresent(renderer);
+}
+
+static void Impl_PresentSoftware(void)
+{
+	SDL_LockSurface(vidSurface);
+	SDL_UpdateTexture(texture, &src_rect, vidSurface->pixels, vidSurface->pitch);
+	SDL_UnlockSurface(vidSurface);
+	Impl_PresentTexture();
+}
+
+// texpalette has to be redone when the palette or the texture changes
+static void Impl_UpdateTexPalette(void)
+{
+	INT32 i;
+
+	if (!texpalettedirty)
+		return;
+
+	for (i = 0; i < 256; i++)
+		texpalette[i] = SDL_MapRGB(vidSurface->format, localPalette[i].r, localPalette[i].g, localPalette[i].b);
+	texpalettedirty = SDL_FALSE;
+}
+
 //
-// I_FinishUpdate
+// Software frame conversion
+//
+// The 8-bit frame is expanded through texpalette, which is already in the
+// texture's pixel format, straight into the locked streaming texture. Big
+// frames are split into strips of rows over the render threads.
 //
 
-static SDL_Rect src_rect = { 0, 0, 0, 0 };
+#define EXPANDSTRIP 64 // rows per job
+#define EXPANDTHREADPIXELS (640*400) // smaller frames aren't worth the threads
+
+typedef struct
+{
+	const UINT8 *src;
+	UINT8 *dst;
+	int srcpitch, dstpitch;
+	int width, height, bytespp;
+} expandjob_t;
+
+static void Impl_ExpandRows(const UINT8 *src, int srcpitch, UINT8 *dst, int dstpitch,
+	int width, int height, int bytespp)
+{
+	const Uint32 *pal = texpalette;
+	int x;
+
+	for (; height > 0; height--, src += srcpitch, dst += dstpitch)
+	{
+		if (bytespp == 4)
+		{
+			Uint32 *out = (Uint32 *)dst;
+			x = 0;
+#ifdef __AVX2__
+			for (; x + 8 <= width; x += 8)
+			{
+				const __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + x)));
+				_mm256_storeu_si256((__m256i *)(out + x), _mm256_i32gather_epi32((const int *)pal, idx, 4));
+			}
+#endif
+			for (; x + 4 <= width; x += 4)
+			{
+				out[x] = pal[src[x]];
+				out[x+1] = pal[src[x+1]];
+				out[x+2] = pal[src[x+2]];
+				out[x+3] = pal[src[x+3]];
+			}
+			for (; x < width; x++)
+				out[x] = pal[src[x]];
+		}
+		else
+		{
+			Uint16 *out = (Uint16 *)dst;
+			for (x = 0; x < width; x++)
+				out[x] = (Uint16)pal[src[x]];
+		}
+	}
+}
+
+static void Impl_ExpandStrip(int index, void *userdata)
+{
+	const expandjob_t *job = userdata;
+	const int y = index * EXPANDSTRIP;
+
+	Impl_ExpandRows(job->src + y*job->srcpitch, job->srcpitch,
+		job->dst + y*job->dstpitch, job->dstpitch,
+		job->width, min(EXPANDSTRIP, job->height - y), job->bytespp);
+}
+
+static void Impl_ExpandFrame(void)
+{
+	expandjob_t job;
+	SDL_Rect rect;
+	void *pixels;
+	INT32 i;
+	int pitch, strips;
+
+	Impl_UpdateTexPalette();
+
+	rect.x = 0;
+	rect.y = 0;
+	rect.w = vid.width;
+	rect.h = vid.height;
+
+	if (SDL_LockTexture(texture, &rect, &pixels, &pitch) < 0)
+		return;
+
+	job.src = screens[0];
+	job.srcpitch = vid.rowbytes;
+	job.dst = pixels;
+	job.dstpitch = pitch;
+	job.width = rect.w;
+	job.height = rect.h;
+	job.bytespp = vidSurface->format->BytesPerPixel;
+
+	strips = (rect.h + EXPANDSTRIP - 1) / EXPANDSTRIP;
+#ifdef HAVE_THREADS
+	if (rect.w * rect.h >= EXPANDTHREADPIXELS)
+		I_ParallelFor(strips, cv_renderthreads.value, Impl_ExpandStrip, &job);
+	else
+#endif
+	for (i = 0; i < strips; i++)
+		Impl_ExpandStrip(i, &job);
+
+	SDL_UnlockTexture(texture);
+}
+
+//
+// Frame pipeline
+//
+// With vid_pipeline on, I_FinishUpdate copies the 8-bit frame aside, locks
+// the streaming texture and leaves expanding the copy into it to a worker
+// thread, so that runs alongside the next tic. I_PresentFrame then only
+// unlocks the texture and flips. This trades a frame of latency and an
+// 8-bit copy for taking the whole expansion off the main thread.
+// Nothing the worker touches is used by the game, so no game state needs
+// to be shared with it. The worker is started with the first frame and
+// sleeps between frames until the game quits.
+//
+
+static expandjob_t pipejob; // the frame the worker expands
+
+static void Impl_PipelineConvert(void)
+{
+	Impl_ExpandRows(pipejob.src, pipejob.srcpitch, pipejob.dst, pipejob.dstpitch,
+		pipejob.width, pipejob.height, pipejob.bytespp);
+}
+
+#ifdef HAVE_THREADS
+static void Impl_PipelineWorker(void *userdata)
+{
+	(void)userdata;
+
+	I_LockMutex(&pipe_mutex);
+	while (!pipequit)
+	{
+		if (!pipebusy)
+		{
+			I_HoldCond(&pipe_cond, pipe_mutex);
+			continue;
+		}
+
+		I_UnlockMutex(pipe_mutex);
+		Impl_PipelineConvert();
+		I_LockMutex(&pipe_mutex);
+
+		pipebusy = SDL_FALSE;
+		I_WakeAllCond(&pipe_cond);
+	}
+	I_UnlockMutex(pipe_mutex);
+}
+
+// Lets the worker return, so I_StopThreads can join it
+static void Impl_PipelineStop(void)
+{
+	I_LockMutex(&pipe_mutex);
+	pipequit = SDL_TRUE;
+	I_WakeAllCond(&pipe_cond);
+	I_UnlockMutex(pipe_mutex);
+}
+#endif
+
+static void Impl_PipelineWait(void)
+{
+#ifdef HAVE_THREADS
+	I_LockMutex(&pipe_mutex);
+	while (pipebusy && !pipequit)
+		I_HoldCond(&pipe_cond, pipe_mutex);
+	I_UnlockMutex(pipe_mutex);
+#endif
+}
+
+// Finishes the frame in flight and unlocks the texture, without presenting it.
+static void Impl_PipelineFlush(void)
+{
+	if (!pipepending)
+		return;
+
+	Impl_PipelineWait();
+	SDL_UnlockTexture(texture);
+	pipepending = SDL_FALSE;
+}
+
+static void Impl_PipelineQueue(void)
+{
+	void *pixels;
+	int pitch;
+
+	// Whoever draws without going through D_SRB2Loop (wipes, loading)
+	// still gets their frames out, one behind.
+	I_PresentFrame();
+
+	if (!pipeframe || pipeframewidth != vid.width || pipeframeheight != vid.height)
+	{
+		free(pipeframe);
+		pipeframe = malloc(vid.width * vid.height);
+		if (!pipeframe)
+			I_Error("%s", M_GetText("No system memory for SDL buffer surface\n"));
+		pipeframewidth = vid.width;
+		pipeframeheight = vid.height;
+	}
+
+	VID_BlitLinearScreen(screens[0], pipeframe, vid.width, vid.height, vid.rowbytes, vid.width);
+
+	Impl_UpdateTexPalette();
+	if (SDL_LockTexture(texture, &src_rect, &pixels, &pitch) < 0)
+		return;
+
+	pipejob.src = pipeframe;
+	pipejob.srcpitch = vid.width;
+	pipejob.dst = pixels;
+	pipejob.dstpitch = pitch;
+	pipejob.width = vid.width;
+	pipejob.height = vid.height;
+	pipejob.bytespp = vidSurface->format->BytesPerPixel;
+
+	pipepending = SDL_TRUE;
+#ifdef HAVE_THREADS
+	if (!pipeworker)
+	{
+		I_SpawnThread("vid-pipeline", Impl_PipelineWorker, NULL);
+		I_AddExitFunc(Impl_PipelineStop); // runs before I_StopThreads
+		pipeworker = SDL_TRUE;
+	}
+
+	I_LockMutex(&pipe_mutex);
+	if (pipequit)
+		Impl_PipelineConvert();
+	else
+	{
+		pipebusy = SDL_TRUE;
+		I_WakeAllCond(&pipe_cond);
+	}
+	I_UnlockMutex(pipe_mutex);
+#else
+	Impl_PipelineConvert();
+#endif
+}
+
+static void CV_vidpipeline_OnChange(void)
+{
+	if (!cv_vidpipeline.value)
+		I_PresentFrame();
+}
+
+//
+// I_PresentFrame
+//
+void I_PresentFrame(void)
+{
+	if (!pipepending)
+		return;
+
+	Impl_PipelineFlush();
+
+	if (rendermode == render_soft)
+		Impl_PresentTexture();
+}
+
+//
+// I_FinishUpdate
+//
 
 void I_FinishUpdate(void)
 {
@@ -1234,6 +1549,23 @@ void I_FinishUpdate(void)
 	{
 
 
+		if (cv_vidpipeline.value && vid.bpp == 1)
+		{
+			Impl_PipelineQueue();
+			exposevideo = SDL_FALSE;
+			return;
+		}
+
+		Impl_PipelineFlush();
+
+		if (vid.bpp == 1)
+		{
+			Impl_ExpandFrame();
+			Impl_PresentTexture();
+			exposevideo = SDL_FALSE;
+			return;
+		}
+
 		if (!bufSurface) //Double-Check
 		{
 			Impl_VideoSetupSDLBuffer();
@@ -1242,14 +1574,9 @@ void I_FinishUpdate(void)
 		{
 
 			SDL_BlitSurface(bufSurface, &src_rect, vidSurface, &src_rect);
-			// Fury -- there's no way around UpdateTexture, the GL backend uses it anyway
-			SDL_LockSurface(vidSurface);
-			SDL_UpdateTexture(texture, &src_rect, vidSurface->pixels, vidSurface->pitch);
-			SDL_UnlockSurface(vidSurface);
 		}
-		SDL_RenderClear(renderer);
-		SDL_RenderCopy(renderer, texture, &src_rect, NULL);
-		SDL_RenderPresent(renderer);
+		// Fury -- there's no way around UpdateTexture, the GL backend uses it anyway
+		Impl_PresentSoftware();
 	}
 
 #ifdef HWRENDER
@@ -1300,6 +1627,7 @@ void I_SetPalette(RGBA_t *palette)
 	//if (vidSurface) SDL_SetPaletteColors(vidSurface->format->palette, localPalette, 0, 256);
 	// Fury -- SDL2 vidSurface is a 32-bit surface buffer copied to the texture. It's not palletized, like bufSurface.
 	if (bufSurface) SDL_SetPaletteColors(bufSurface->format->palette, localPalette, 0, 256);
+	texpalettedirty = SDL_TRUE; // picked up by the next frame
 }
 
 // return number of fullscreen + X11 modes
@@ -1725,6 +2053,7 @@ void I_StartupGraphics(void)
 	CV_RegisterVar (&cv_vidwait);
 	CV_RegisterVar (&cv_stretch);
 	CV_RegisterVar (&cv_alwaysgrabmouse);
+	CV_RegisterVar (&cv_vidpipeline);
 	disable_mouse = M_CheckParm("-nomouse");
 	disable_fullscreen = M_CheckParm("-win") ? 1 : 0;
 
@@ -1916,11 +2245,15 @@ void I_ShutdownGraphics(void)
 {
 	const rendermode_t oldrendermode = rendermode;
 
+	Impl_PipelineFlush();
+
 	rendermode = render_none;
 	if (icoSurface) SDL_FreeSurface(icoSurface);
 	icoSurface = NULL;
 	if (oldrendermode == render_soft)
 	{
+		free(pipeframe);
+		pipeframe = NULL;
 		if (vidSurface) SDL_FreeSurface(vidSurface);
 		vidSurface = NULL;
 		if (vid.buffer) free(vid.buffer);
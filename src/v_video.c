@@ -30,6 +30,14 @@
 #include "hardware/hw_glob.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include "i_threads.h"
+#endif
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 // Each screen is [vid.width*vid.height];
 UINT8 *screens[5];
 // screens[0] = main display window
@@ -152,6 +160,8 @@ static void LoadPalette(const char *lumpname)
 	UINT8 *pal;
 
 	Z_Free(pLocalPalette);
+	R_FlushMipmaps(); // quantised against the old palette
+	R_FlushNearestColors();
 
 	pLocalPalette = Z_Malloc(sizeof (*pLocalPalette)*palsize, PU_STATIC, NULL);
 
@@ -280,6 +290,117 @@ static inline UINT8 transmappedpdraw(const UINT8 *dest, const UINT8 *source, fix
 	return *(v_translevel + (((*(v_colormap + source[ofs>>FRACBITS]))<<8)&0xff00) + (*dest&0xff));
 }
 
+// Draws a post of an opaque patch as dup x dup blocks, n pixels wide.
+// Rows this narrow are cheaper to store a pixel at a time than to memset.
+#define DUPPOSTSTORE 8
+static void V_DrawDupPost(UINT8 *dest, const UINT8 *screentop, const UINT8 *deststop,
+	const UINT8 *source, INT32 length, INT32 dup, INT32 n, const UINT8 *colormap)
+{
+	INT32 i, r, c;
+	UINT8 pixel;
+
+	for (i = 0; i < length && dest < deststop; i++)
+	{
+		pixel = colormap ? colormap[source[i]] : source[i];
+		for (r = 0; r < dup && dest < deststop; r++, dest += vid.width)
+		{
+			if (dest < screentop) // don't draw off the top of the screen (CRASH PREVENTION)
+				continue;
+			if (n == 1)
+				*dest = pixel;
+			else if (n <= DUPPOSTSTORE)
+				for (c = 0; c < n; c++)
+					dest[c] = pixel;
+			else
+				memset(dest, pixel, n);
+		}
+	}
+}
+#undef DUPPOSTSTORE
+
+// Draws an opaque patch at a whole number scale, the usual case for the
+// HUD, menus and fonts. Every patch pixel is a dup x dup block, so there
+// is no fixed point stepping and no per pixel drawer call; each block row
+// is one fill. x is the screen column desttop points at.
+static void V_DrawDupPatch(INT32 x, UINT8 *desttop, const UINT8 *screentop, const UINT8 *deststop,
+	patch_t *patch, INT32 dup, const UINT8 *colormap)
+{
+	const INT32 width = SHORT(patch->width);
+	const patchposts_t *posts = W_GetPatchPosts(patch);
+	const column_t *column;
+	UINT8 *dest;
+	INT32 col, x1, x2, n, topdelta, prevdelta;
+	UINT32 p;
+
+	for (col = 0; col < width; col++)
+	{
+		// clip the block against the sides of the screen (WRAP PREVENTION)
+		x1 = x + col*dup;
+		x2 = x1 + dup;
+		if (x2 <= 0)
+			continue;
+		if (x1 >= vid.width)
+			break;
+		if (x1 < 0)
+			x1 = 0;
+		if (x2 > vid.width)
+			x2 = vid.width;
+		n = x2 - x1;
+		dest = desttop + (x1 - x);
+
+		if (posts)
+		{
+			for (p = posts->columnposts[col]; p < posts->columnposts[col+1]; p++)
+			{
+				const patchpost_t *post = &posts->posts[p];
+				V_DrawDupPost(dest + post->topdelta*dup*vid.width, screentop, deststop,
+					(const UINT8 *)patch + post->ofs, post->length, dup, n, colormap);
+			}
+			continue;
+		}
+
+		column = (const column_t *)((const UINT8 *)(patch) + LONG(patch->columnofs[col]));
+		prevdelta = -1;
+
+		while (column->topdelta != 0xff)
+		{
+			topdelta = column->topdelta;
+			if (topdelta <= prevdelta)
+				topdelta += prevdelta;
+			prevdelta = topdelta;
+			V_DrawDupPost(dest + topdelta*dup*vid.width, screentop, deststop,
+				(const UINT8 *)(column) + 3, column->length, dup, n, colormap);
+			column = (const column_t *)((const UINT8 *)column + column->length + 4);
+		}
+	}
+}
+
+// The screen scale a patch drawn with these flags gets.
+static INT32 V_PatchDup(INT32 scrn)
+{
+	INT32 dupx = vid.dupx, dupy = vid.dupy;
+
+	if (scrn & V_SCALEPATCHMASK) switch ((scrn & V_SCALEPATCHMASK) >> V_SCALEPATCHSHIFT)
+	{
+		case 1: // V_NOSCALEPATCH
+			dupx = dupy = 1;
+			break;
+		case 2: // V_SMALLSCALEPATCH
+			dupx = vid.smalldupx;
+			dupy = vid.smalldupy;
+			break;
+		case 3: // V_MEDSCALEPATCH
+			dupx = vid.meddupx;
+			dupy = vid.meddupy;
+			break;
+		default:
+			break;
+	}
+
+	// only use one dup, to avoid stretching (har har)
+	return (dupx < dupy ? dupx : dupy);
+}
+
 // Draws a patch scaled to arbitrary size.
 void V_DrawFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, INT32 scrn, patch_t *patch, const UINT8 *colormap)
 {
@@ -334,27 +455,7 @@ void V_DrawFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, INT32 scrn, patch_t
 		patchdrawfunc = (v_translevel) ? transmappedpdraw : mappedpdraw;
 	}
 
-	dupx = vid.dupx;
-	dupy = vid.dupy;
-	if (scrn & V_SCALEPATCHMASK) switch ((scrn & V_SCALEPATCHMASK) >> V_SCALEPATCHSHIFT)
-	{
-		case 1: // V_NOSCALEPATCH
-			dupx = dupy = 1;
-			break;
-		case 2: // V_SMALLSCALEPATCH
-			dupx = vid.smalldupx;
-			dupy = vid.smalldupy;
-			break;
-		case 3: // V_MEDSCALEPATCH
-			dupx = vid.meddupx;
-			dupy = vid.meddupy;
-			break;
-		default:
-			break;
-	}
-
-	// only use one dup, to avoid stretching (har har)
-	dupx = dupy = (dupx < dupy ? dupx : dupy);
+	dupx = dupy = V_PatchDup(scrn);
 	fdup = FixedMul(dupx<<FRACBITS, pscale);
 	colfrac = FixedDiv(FRACUNIT, fdup);
 	rowfrac = FixedDiv(FRACUNIT, fdup);
@@ -454,6 +555,12 @@ void V_DrawFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, INT32 scrn, patch_t
 	else
 		pwidth = SHORT(patch->width) * dupx;
 
+	if (!v_translevel && !(scrn & V_FLIP) && fdup >= FRACUNIT && !(fdup & (FRACUNIT-1)))
+	{
+		V_DrawDupPatch(x, desttop, screens[scrn&V_PARAMMASK], deststop, patch, fdup>>FRACBITS, v_colormap);
+		return;
+	}
+
 	deststart = desttop;
 	destend = desttop + pwidth;
 
@@ -1230,13 +1337,13 @@ char *V_WordWrap(INT32 x, INT32 w, INT32 option, const char *string)
 			c = toupper(c);
 		c -= HU_FONTSTART;
 
-		if (c < 0 || c >= HU_FONTSIZE || !hu_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || hu_fontwidth[c] < 0)
 		{
 			chw = spacewidth;
 			lastusablespace = i;
 		}
 		else
-			chw = (charwidth ? charwidth : hu_font[c]->width);
+			chw = (charwidth ? charwidth : hu_fontwidth[c]);
 
 		x += chw;
 
@@ -1251,6 +1358,144 @@ char *V_WordWrap(INT32 x, INT32 w, INT32 option, const char *string)
 	return newstring;
 }
 
+// Glyph batches
+//
+// The string drawers queue their characters here and draw the whole string
+// at once. Every glyph of a string shares its flags and scale, so the alpha,
+// scale and centering setup that V_DrawFixedPatch does per patch is done once
+// per string, and on the software renderer the glyphs go straight to the
+// whole number scale drawer.
+
+#define MAXSTRINGGLYPHS 128
+
+static vglyph_t stringglyphs[MAXSTRINGGLYPHS];
+static INT32 numstringglyphs;
+static fixed_t stringscale;
+static INT32 stringoption;
+
+static void V_DrawGlyphs(const vglyph_t *glyphs, INT32 count, fixed_t pscale, INT32 scrn)
+{
+	UINT8 *screen;
+	const UINT8 *deststop;
+	fixed_t fdup, x, y, offsetx, offsety;
+	INT32 i, dup, centerx = 0, centery = 0;
+	patch_t *patch;
+
+	if (rendermode == render_none || !count)
+		return;
+
+#ifdef HWRENDER
+	if (rendermode != render_soft)
+	{
+		HWR_DrawGlyphs(glyphs, count, pscale, scrn);
+		return;
+	}
+#endif
+
+	dup = V_PatchDup(scrn);
+	fdup = FixedMul(dup<<FRACBITS, pscale);
+
+	// anything the whole number scale drawer can't do goes the long way
+	if ((scrn & (V_ALPHAMASK|V_FLIP)) || fdup < FRACUNIT || (fdup & (FRACUNIT-1))
+		|| ((scrn & V_SCALEPATCHMASK) && !(scrn & V_NOSCALESTART)))
+	{
+		for (i = 0; i < count; i++)
+			V_DrawFixedPatch(glyphs[i].x, glyphs[i].y, pscale, scrn, glyphs[i].patch, glyphs[i].colormap);
+		return;
+	}
+
+	screen = screens[scrn&V_PARAMMASK];
+	if (!screen)
+		return;
+	deststop = screen + vid.rowbytes * vid.height;
+
+	if (!(scrn & V_NOSCALESTART))
+	{
+		// same centering as V_DrawFixedPatch
+		if (vid.width != BASEVIDWIDTH * dup)
+		{
+			if (scrn & V_SNAPTORIGHT)
+				centerx = (vid.width - (BASEVIDWIDTH * dup));
+			else if (!(scrn & V_SNAPTOLEFT))
+				centerx = (vid.width - (BASEVIDWIDTH * dup)) / 2;
+		}
+		if (vid.height != BASEVIDHEIGHT * dup)
+		{
+			if ((scrn & (V_SPLITSCREEN|V_SNAPTOBOTTOM)) == (V_SPLITSCREEN|V_SNAPTOBOTTOM))
+				centery = (vid.height/2 - (BASEVIDHEIGHT/2 * dup));
+			else if (scrn & V_SNAPTOBOTTOM)
+				centery = (vid.height - (BASEVIDHEIGHT * dup));
+			else if (!(scrn & V_SNAPTOTOP))
+				centery = (vid.height - (BASEVIDHEIGHT * dup)) / 2;
+		}
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		patch = glyphs[i].patch;
+
+		// a full screen patch blacks out the borders, let V_DrawFixedPatch handle it
+		if (SHORT(patch->width) == BASEVIDWIDTH && SHORT(patch->height) == BASEVIDHEIGHT)
+		{
+			V_DrawFixedPatch(glyphs[i].x, glyphs[i].y, pscale, scrn, patch, glyphs[i].colormap);
+			continue;
+		}
+
+		offsetx = FixedMul(SHORT(patch->leftoffset)<<FRACBITS, pscale);
+		offsety = FixedMul(SHORT(patch->topoffset)<<FRACBITS, pscale);
+		if ((scrn & (V_NOSCALESTART|V_OFFSET)) == (V_NOSCALESTART|V_OFFSET))
+		{
+			offsetx *= dup;
+			offsety *= dup;
+		}
+		x = glyphs[i].x - offsetx;
+		y = glyphs[i].y - offsety;
+
+		if (scrn & V_SPLITSCREEN)
+			y >>= 1;
+
+		if (scrn & V_NOSCALESTART)
+		{
+			x >>= FRACBITS;
+			y >>= FRACBITS;
+		}
+		else
+		{
+			x = (FixedMul(x, dup<<FRACBITS)>>FRACBITS) + centerx;
+			y = (FixedMul(y, dup<<FRACBITS)>>FRACBITS) + centery;
+		}
+
+		V_DrawDupPatch(x, screen + (y*vid.width) + x, screen, deststop, patch, fdup>>FRACBITS, glyphs[i].colormap);
+	}
+}
+
+static void V_StartGlyphs(fixed_t pscale, INT32 option)
+{
+	numstringglyphs = 0;
+	stringscale = pscale;
+	stringoption = option;
+}
+
+static void V_FlushGlyphs(void)
+{
+	V_DrawGlyphs(stringglyphs, numstringglyphs, stringscale, stringoption);
+	numstringglyphs = 0;
+}
+
+static void V_QueueGlyph(fixed_t x, fixed_t y, patch_t *patch, const UINT8 *colormap)
+{
+	vglyph_t *glyph;
+
+	if (numstringglyphs == MAXSTRINGGLYPHS)
+		V_FlushGlyphs();
+
+	glyph = &stringglyphs[numstringglyphs++];
+	glyph->patch = patch;
+	glyph->x = x;
+	glyph->y = y;
+	glyph->colormap = colormap;
+}
+
 //
 // Write a string using the hu_font
 // NOTE: the text is centered for screens larger than the base width
@@ -1281,6 +1526,7 @@ void V_DrawString(INT32 x, INT32 y, INT32 option, const char *string)
 	}
 
 	charflags = (option & V_CHARCOLORMASK);
+	colormap = V_GetStringColormap(charflags);
 
 	switch (option & V_SPACINGMASK)
 	{
@@ -1296,6 +1542,8 @@ void V_DrawString(INT32 x, INT32 y, INT32 option, const char *string)
 			break;
 	}
 
+	V_StartGlyphs(FRACUNIT, option);
+
 	for (;;ch++)
 	{
 		if (!*ch)
@@ -1304,7 +1552,10 @@ void V_DrawString(INT32 x, INT32 y, INT32 option, const char *string)
 		{
 			// manually set flags override color codes
 			if (!(option & V_CHARCOLORMASK))
+			{
 				charflags = ((*ch & 0x7f) << V_CHARCOLORSHIFT) & V_CHARCOLORMASK;
+				colormap = V_GetStringColormap(charflags);
+			}
 			continue;
 		}
 		if (*ch == '\n')
@@ -1325,7 +1576,7 @@ void V_DrawString(INT32 x, INT32 y, INT32 option, const char *string)
 		c -= HU_FONTSTART;
 
 		// character does not exist or is a space
-		if (c < 0 || c >= HU_FONTSIZE || !hu_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || hu_fontwidth[c] < 0)
 		{
 			cx += spacewidth * dupx;
 			continue;
@@ -1334,10 +1585,10 @@ void V_DrawString(INT32 x, INT32 y, INT32 option, const char *string)
 		if (charwidth)
 		{
 			w = charwidth * dupx;
-			center = w/2 - SHORT(hu_font[c]->width)*dupx/2;
+			center = w/2 - hu_fontwidth[c]*dupx/2;
 		}
 		else
-			w = SHORT(hu_font[c]->width) * dupx;
+			w = hu_fontwidth[c] * dupx;
 
 		if (cx > scrwidth)
 			break;
@@ -1347,11 +1598,12 @@ void V_DrawString(INT32 x, INT32 y, INT32 option, const char *string)
 			continue;
 		}
 
-		colormap = V_GetStringColormap(charflags);
-		V_DrawFixedPatch((cx + center)<<FRACBITS, cy<<FRACBITS, FRACUNIT, option, hu_font[c], colormap);
+		V_QueueGlyph((cx + center)<<FRACBITS, cy<<FRACBITS, hu_font[c], colormap);
 
 		cx += w;
 	}
+
+	V_FlushGlyphs();
 }
 
 void V_DrawCenteredString(INT32 x, INT32 y, INT32 option, const char *string)
@@ -1396,6 +1648,7 @@ void V_DrawSmallString(INT32 x, INT32 y, INT32 option, const char *string)
 	}
 
 	charflags = (option & V_CHARCOLORMASK);
+	colormap = V_GetStringColormap(charflags);
 
 	switch (option & V_SPACINGMASK)
 	{
@@ -1411,6 +1664,8 @@ void V_DrawSmallString(INT32 x, INT32 y, INT32 option, const char *string)
 			break;
 	}
 
+	V_StartGlyphs(FRACUNIT/2, option);
+
 	for (;;ch++)
 	{
 		if (!*ch)
@@ -1419,7 +1674,10 @@ void V_DrawSmallString(INT32 x, INT32 y, INT32 option, const char *string)
 		{
 			// manually set flags override color codes
 			if (!(option & V_CHARCOLORMASK))
+			{
 				charflags = ((*ch & 0x7f) << V_CHARCOLORSHIFT) & V_CHARCOLORMASK;
+				colormap = V_GetStringColormap(charflags);
+			}
 			continue;
 		}
 		if (*ch == '\n')
@@ -1439,7 +1697,7 @@ void V_DrawSmallString(INT32 x, INT32 y, INT32 option, const char *string)
 			c = toupper(c);
 		c -= HU_FONTSTART;
 
-		if (c < 0 || c >= HU_FONTSIZE || !hu_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || hu_fontwidth[c] < 0)
 		{
 			cx += spacewidth * dupx;
 			continue;
@@ -1448,10 +1706,10 @@ void V_DrawSmallString(INT32 x, INT32 y, INT32 option, const char *string)
 		if (charwidth)
 		{
 			w = charwidth * dupx;
-			center = w/2 - SHORT(hu_font[c]->width)*dupx/4;
+			center = w/2 - hu_fontwidth[c]*dupx/4;
 		}
 		else
-			w = SHORT(hu_font[c]->width) * dupx / 2;
+			w = hu_fontwidth[c] * dupx / 2;
 		if (cx > scrwidth)
 			break;
 		if (cx+left + w < 0) //left boundary check
@@ -1460,11 +1718,12 @@ void V_DrawSmallString(INT32 x, INT32 y, INT32 option, const char *string)
 			continue;
 		}
 
-		colormap = V_GetStringColormap(charflags);
-		V_DrawFixedPatch((cx + center)<<FRACBITS, cy<<FRACBITS, FRACUNIT/2, option, hu_font[c], colormap);
+		V_QueueGlyph((cx + center)<<FRACBITS, cy<<FRACBITS, hu_font[c], colormap);
 
 		cx += w;
 	}
+
+	V_FlushGlyphs();
 }
 
 void V_DrawRightAlignedSmallString(INT32 x, INT32 y, INT32 option, const char *string)
@@ -1503,6 +1762,7 @@ void V_DrawThinString(INT32 x, INT32 y, INT32 option, const char *string)
 	}
 
 	charflags = (option & V_CHARCOLORMASK);
+	colormap = V_GetStringColormap(charflags);
 
 	switch (option & V_SPACINGMASK)
 	{
@@ -1518,6 +1778,8 @@ void V_DrawThinString(INT32 x, INT32 y, INT32 option, const char *string)
 			break;
 	}
 
+	V_StartGlyphs(FRACUNIT, option);
+
 	for (;;ch++)
 	{
 		if (!*ch)
@@ -1526,7 +1788,10 @@ void V_DrawThinString(INT32 x, INT32 y, INT32 option, const char *string)
 		{
 			// manually set flags override color codes
 			if (!(option & V_CHARCOLORMASK))
+			{
 				charflags = ((*ch & 0x7f) << V_CHARCOLORSHIFT) & V_CHARCOLORMASK;
+				colormap = V_GetStringColormap(charflags);
+			}
 			continue;
 		}
 		if (*ch == '\n')
@@ -1546,7 +1811,7 @@ void V_DrawThinString(INT32 x, INT32 y, INT32 option, const char *string)
 			c = toupper(c);
 		c -= HU_FONTSTART;
 
-		if (c < 0 || c >= HU_FONTSIZE || !tny_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || tny_fontwidth[c] < 0)
 		{
 			cx += spacewidth * dupx;
 			continue;
@@ -1555,7 +1820,7 @@ void V_DrawThinString(INT32 x, INT32 y, INT32 option, const char *string)
 		if (charwidth)
 			w = charwidth * dupx;
 		else
-			w = (SHORT(tny_font[c]->width) * dupx);
+			w = (tny_fontwidth[c] * dupx);
 
 		if (cx > scrwidth)
 			break;
@@ -1565,11 +1830,12 @@ void V_DrawThinString(INT32 x, INT32 y, INT32 option, const char *string)
 			continue;
 		}
 
-		colormap = V_GetStringColormap(charflags);
-		V_DrawFixedPatch(cx<<FRACBITS, cy<<FRACBITS, FRACUNIT, option, tny_font[c], colormap);
+		V_QueueGlyph(cx<<FRACBITS, cy<<FRACBITS, tny_font[c], colormap);
 
 		cx += w;
 	}
+
+	V_FlushGlyphs();
 }
 
 void V_DrawRightAlignedThinString(INT32 x, INT32 y, INT32 option, const char *string)
@@ -1617,6 +1883,7 @@ void V_DrawStringAtFixed(fixed_t x, fixed_t y, INT32 option, const char *string)
 			break;
 	}
 
+	V_StartGlyphs(FRACUNIT, option);
 	for (;;ch++)
 	{
 		if (!*ch)
@@ -1641,7 +1908,7 @@ void V_DrawStringAtFixed(fixed_t x, fixed_t y, INT32 option, const char *string)
 		c -= HU_FONTSTART;
 
 		// character does not exist or is a space
-		if (c < 0 || c >= HU_FONTSIZE || !hu_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || hu_fontwidth[c] < 0)
 		{
 			cx += (spacewidth * dupx)<<FRACBITS;
 			continue;
@@ -1650,10 +1917,10 @@ void V_DrawStringAtFixed(fixed_t x, fixed_t y, INT32 option, const char *string)
 		if (charwidth)
 		{
 			w = charwidth * dupx;
-			center = w/2 - SHORT(hu_font[c]->width)*(dupx/2);
+			center = w/2 - hu_fontwidth[c]*(dupx/2);
 		}
 		else
-			w = SHORT(hu_font[c]->width) * dupx;
+			w = hu_fontwidth[c] * dupx;
 
 		if ((cx>>FRACBITS) > scrwidth)
 			break;
@@ -1663,10 +1930,12 @@ void V_DrawStringAtFixed(fixed_t x, fixed_t y, INT32 option, const char *string)
 			continue;
 		}
 
-		V_DrawSciencePatch(cx + (center<<FRACBITS), cy, option, hu_font[c], FRACUNIT);
+		V_QueueGlyph(cx + (center<<FRACBITS), cy, hu_font[c], NULL);
 
 		cx += w<<FRACBITS;
 	}
+
+	V_FlushGlyphs();
 }
 
 // Draws a tallnum.  Replaces two functions in y_inter and st_stuff
@@ -1737,6 +2006,7 @@ void V_DrawCreditString(fixed_t x, fixed_t y, INT32 option, const char *string)
 	else
 		dupx = dupy = 1;
 
+	V_StartGlyphs(FRACUNIT, option);
 	for (;;)
 	{
 		c = *ch++;
@@ -1750,19 +2020,21 @@ void V_DrawCreditString(fixed_t x, fixed_t y, INT32 option, const char *string)
 		}
 
 		c = toupper(c) - CRED_FONTSTART;
-		if (c < 0 || c >= CRED_FONTSIZE)
+		if (c < 0 || c >= CRED_FONTSIZE || cred_fontwidth[c] < 0)
 		{
 			cx += (16*dupx)<<FRACBITS;
 			continue;
 		}
 
-		w = SHORT(cred_font[c]->width) * dupx;
+		w = cred_fontwidth[c] * dupx;
 		if ((cx>>FRACBITS) > scrwidth)
 			break;
 
-		V_DrawSciencePatch(cx, cy, option, cred_font[c], FRACUNIT);
+		V_QueueGlyph(cx, cy, cred_font[c], NULL);
 		cx += w<<FRACBITS;
 	}
+
+	V_FlushGlyphs();
 }
 
 // Find string width from cred_font chars
@@ -1770,19 +2042,18 @@ void V_DrawCreditString(fixed_t x, fixed_t y, INT32 option, const char *string)
 INT32 V_CreditStringWidth(const char *string)
 {
 	INT32 c, w = 0;
-	size_t i;
 
 	// It's possible for string to be a null pointer
 	if (!string)
 		return 0;
 
-	for (i = 0; i < strlen(string); i++)
+	for (; *string; string++)
 	{
-		c = toupper(string[i]) - CRED_FONTSTART;
-		if (c < 0 || c >= CRED_FONTSIZE)
+		c = toupper(*string) - CRED_FONTSTART;
+		if (c < 0 || c >= CRED_FONTSIZE || cred_fontwidth[c] < 0)
 			w += 16;
 		else
-			w += SHORT(cred_font[c]->width);
+			w += cred_fontwidth[c];
 	}
 
 	return w;
@@ -1810,6 +2081,7 @@ void V_DrawLevelTitle(INT32 x, INT32 y, INT32 option, const char *string)
 		scrwidth -= left;
 	}
 
+	V_StartGlyphs(FRACUNIT, option);
 	for (;;)
 	{
 		c = *ch++;
@@ -1823,13 +2095,13 @@ void V_DrawLevelTitle(INT32 x, INT32 y, INT32 option, const char *string)
 		}
 
 		c = toupper(c) - LT_FONTSTART;
-		if (c < 0 || c >= LT_FONTSIZE || !lt_font[c])
+		if (c < 0 || c >= LT_FONTSIZE || lt_fontwidth[c] < 0)
 		{
 			cx += 16*dupx;
 			continue;
 		}
 
-		w = SHORT(lt_font[c]->width) * dupx;
+		w = lt_fontwidth[c] * dupx;
 		if (cx > scrwidth)
 			break;
 		if (cx+left + w < 0) //left boundary check
@@ -1839,9 +2111,11 @@ void V_DrawLevelTitle(INT32 x, INT32 y, INT32 option, const char *string)
 			continue;
 		}
 
-		V_DrawScaledPatch(cx, cy, option, lt_font[c]);
+		V_QueueGlyph(cx<<FRACBITS, cy<<FRACBITS, lt_font[c], NULL);
 		cx += w;
 	}
+
+	V_FlushGlyphs();
 }
 
 // Find string width from lt_font chars
@@ -1849,15 +2123,14 @@ void V_DrawLevelTitle(INT32 x, INT32 y, INT32 option, const char *string)
 INT32 V_LevelNameWidth(const char *string)
 {
 	INT32 c, w = 0;
-	size_t i;
 
-	for (i = 0; i < strlen(string); i++)
+	for (; *string; string++)
 	{
-		c = toupper(string[i]) - LT_FONTSTART;
-		if (c < 0 || c >= LT_FONTSIZE || !lt_font[c])
+		c = toupper(*string) - LT_FONTSTART;
+		if (c < 0 || c >= LT_FONTSIZE || lt_fontwidth[c] < 0)
 			w += 16;
 		else
-			w += SHORT(lt_font[c]->width);
+			w += lt_fontwidth[c];
 	}
 
 	return w;
@@ -1868,11 +2141,10 @@ INT32 V_LevelNameWidth(const char *string)
 INT32 V_LevelNameHeight(const char *string)
 {
 	INT32 c, w = 0;
-	size_t i;
 
-	for (i = 0; i < strlen(string); i++)
+	for (; *string; string++)
 	{
-		c = toupper(string[i]) - LT_FONTSTART;
+		c = toupper(*string) - LT_FONTSTART;
 		if (c < 0 || c >= LT_FONTSIZE || !lt_font[c])
 			continue;
 
@@ -1890,7 +2162,6 @@ INT32 V_StringWidth(const char *string, INT32 option)
 {
 	INT32 c, w = 0;
 	INT32 spacewidth = 4, charwidth = 0;
-	size_t i;
 
 	switch (option & V_SPACINGMASK)
 	{
@@ -1906,17 +2177,17 @@ INT32 V_StringWidth(const char *string, INT32 option)
 			break;
 	}
 
-	for (i = 0; i < strlen(string); i++)
+	for (; *string; string++)
 	{
-		c = string[i];
+		c = *string;
 		if ((UINT8)c >= 0x80 && (UINT8)c <= 0x89) //color parsing! -Inuyasha 2.16.09
 			continue;
 
 		c = toupper(c) - HU_FONTSTART;
-		if (c < 0 || c >= HU_FONTSIZE || !hu_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || hu_fontwidth[c] < 0)
 			w += spacewidth;
 		else
-			w += (charwidth ? charwidth : SHORT(hu_font[c]->width));
+			w += (charwidth ? charwidth : hu_fontwidth[c]);
 	}
 
 	return w;
@@ -1929,7 +2200,6 @@ INT32 V_SmallStringWidth(const char *string, INT32 option)
 {
 	INT32 c, w = 0;
 	INT32 spacewidth = 2, charwidth = 0;
-	size_t i;
 
 	switch (option & V_SPACINGMASK)
 	{
@@ -1945,17 +2215,17 @@ INT32 V_SmallStringWidth(const char *string, INT32 option)
 			break;
 	}
 
-	for (i = 0; i < strlen(string); i++)
+	for (; *string; string++)
 	{
-		c = string[i];
+		c = *string;
 		if ((UINT8)c >= 0x80 && (UINT8)c <= 0x89) //color parsing! -Inuyasha 2.16.09
 			continue;
 
 		c = toupper(c) - HU_FONTSTART;
-		if (c < 0 || c >= HU_FONTSIZE || !hu_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || hu_fontwidth[c] < 0)
 			w += spacewidth;
 		else
-			w += (charwidth ? charwidth : SHORT(hu_font[c]->width)/2);
+			w += (charwidth ? charwidth : hu_fontwidth[c]/2);
 	}
 
 	return w;
@@ -1968,7 +2238,6 @@ INT32 V_ThinStringWidth(const char *string, INT32 option)
 {
 	INT32 c, w = 0;
 	INT32 spacewidth = 2, charwidth = 0;
-	size_t i;
 
 	switch (option & V_SPACINGMASK)
 	{
@@ -1984,26 +2253,225 @@ INT32 V_ThinStringWidth(const char *string, INT32 option)
 			break;
 	}
 
-	for (i = 0; i < strlen(string); i++)
+	for (; *string; string++)
 	{
-		c = string[i];
+		c = *string;
 		if ((UINT8)c >= 0x80 && (UINT8)c <= 0x89) //color parsing! -Inuyasha 2.16.09
 			continue;
 
 		c = toupper(c) - HU_FONTSTART;
-		if (c < 0 || c >= HU_FONTSIZE || !tny_font[c])
+		if (c < 0 || c >= HU_FONTSIZE || tny_fontwidth[c] < 0)
 			w += spacewidth;
 		else
-			w += (charwidth ? charwidth : SHORT(tny_font[c]->width));
+			w += (charwidth ? charwidth : tny_fontwidth[c]);
 	}
 
 	return w;
 }
 
+// Looks every pixel up in a 256x256 translucency table, hi picking the
+// row and lo the column: dest[x] = table[(hi[x]<<8) + lo[x]], then through
+// colormap if there is one. dest may be either source. Used by the motion
+// blur and the screen wipes, which run it over the whole screen.
+void V_TransRow(UINT8 *dest, const UINT8 *hi, const UINT8 *lo, const UINT8 *table, const UINT8 *colormap, INT32 count)
+{
+	INT32 x = 0;
+
+#ifdef __AVX2__
+	// Gather a dword starting at each table byte and keep its low byte,
+	// which is why the tables need TRANSROWPAD bytes after them.
+	const __m256i lowbyte = _mm256_set1_epi32(0xFF);
+
+	for (; x + 8 <= count; x += 8)
+	{
+		__m256i idx = _mm256_or_si256(
+			_mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(hi + x))), 8),
+			_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(lo + x))));
+		__m128i pix;
+
+		idx = _mm256_and_si256(_mm256_i32gather_epi32((const int *)table, idx, 1), lowbyte);
+		if (colormap)
+			idx = _mm256_and_si256(_mm256_i32gather_epi32((const int *)colormap, idx, 1), lowbyte);
+
+		pix = _mm_packus_epi32(_mm256_castsi256_si128(idx), _mm256_extracti128_si256(idx, 1));
+		_mm_storel_epi64((__m128i *)(dest + x), _mm_packus_epi16(pix, pix));
+	}
+#endif
+
+	if (colormap)
+	{
+		for (; x < count; x++)
+			dest[x] = colormap[table[(hi[x]<<8) + lo[x]]];
+		return;
+	}
+
+	for (; x + 4 <= count; x += 4)
+	{
+		dest[x] = table[(hi[x]<<8) + lo[x]];
+		dest[x+1] = table[(hi[x+1]<<8) + lo[x+1]];
+		dest[x+2] = table[(hi[x+2]<<8) + lo[x+2]];
+		dest[x+3] = table[(hi[x+3]<<8) + lo[x+3]];
+	}
+	for (; x < count; x++)
+		dest[x] = table[(hi[x]<<8) + lo[x]];
+}
+
+#ifdef PARANOIA
+#define TRANSROWCHECK 67 // a few vectors and a tail
+
+// Checks V_TransRow against the plain lookup, so a broken
+// vector path shows up at startup instead of in the wipes.
+static void V_CheckTransRow(void)
+{
+	static UINT8 table[0x10000 + TRANSROWPAD], colormap[256 + TRANSROWPAD];
+	UINT8 hi[TRANSROWCHECK], lo[TRANSROWCHECK], dest[TRANSROWCHECK], expect[TRANSROWCHECK];
+	INT32 i, c;
+
+	for (i = 0; i < 0x10000; i++)
+		table[i] = (UINT8)(i ^ (i >> 8) ^ (i >> 3));
+	for (i = 0; i < 256; i++)
+		colormap[i] = (UINT8)(i * 7 + 1);
+
+	// The first pixel looks up the very last table entry
+	for (i = 0; i < TRANSROWCHECK; i++)
+	{
+		hi[i] = (UINT8)(255 - i * 37);
+		lo[i] = (UINT8)(255 - i * 11);
+	}
+
+	for (c = 0; c < 2; c++)
+	{
+		const UINT8 *cmap = c ? colormap : NULL;
+
+		for (i = 0; i < TRANSROWCHECK; i++)
+		{
+			expect[i] = table[(hi[i]<<8) + lo[i]];
+			if (cmap)
+				expect[i] = cmap[expect[i]];
+		}
+
+		V_TransRow(dest, hi, lo, table, cmap, TRANSROWCHECK);
+		if (memcmp(dest, expect, TRANSROWCHECK))
+			I_Error("V_TransRow doesn't match the plain lookup%s", cmap ? " through a colormap" : "");
+	}
+}
+#undef TRANSROWCHECK
+#endif
+
 boolean *heatshifter = NULL;
 INT32 lastheight = 0;
 INT32 heatindex[2] = { 0, 0 };
 
+#if NUMSCREENS >= 5
+// The post processor works on rows in place, a band of POSTPROCBAND rows
+// at a time. Bands don't share anything, so on big screens they go out to
+// the render threads.
+#define POSTPROCBAND 32
+#define POSTPROCTHREADPIXELS (640*400)
+
+typedef struct
+{
+	postimg_t type;
+	UINT8 *screen; // first row of the view in screens[0]
+	UINT8 *blur; // first row of the view in screens[4], motion blur only
+	INT32 height;
+	angle_t disstart; // water
+	INT32 heatstart; // heat
+	const UINT8 *transme; // motion blur
+} postjob_t;
+
+// Slides a row sideways by shift pixels, right if positive, and smears
+// the edge pixel over the gap it leaves.
+static void V_ShiftRow(UINT8 *row, INT32 shift)
+{
+	UINT8 edge;
+
+	if (shift > 0)
+	{
+		if (shift > vid.width)
+			shift = vid.width;
+		edge = row[0];
+		memmove(row + shift, row, vid.width - shift);
+		memset(row, edge, shift);
+	}
+	else if (shift < 0)
+	{
+		shift = -shift;
+		if (shift > vid.width)
+			shift = vid.width;
+		edge = row[vid.width - 1];
+		memmove(row, row + shift, vid.width - shift);
+		memset(row + vid.width - shift, edge, shift);
+	}
+}
+
+static void V_PostProcessBand(int index, void *userdata)
+{
+	const postjob_t *job = userdata;
+	const INT32 top = index * POSTPROCBAND;
+	INT32 bottom = min(top + POSTPROCBAND, job->height), y;
+	UINT8 *row = job->screen + top*vid.width;
+
+	switch (job->type)
+	{
+		case postimg_water:
+		{
+			angle_t disStart = (job->disstart + 22*top) & FINEMASK;
+
+			for (y = top; y < bottom; y++, row += vid.width)
+			{
+				V_ShiftRow(row, -((FINESINE(disStart)*5)>>FRACBITS));
+				disStart += 22; //the offset into the displacement map, increment each game loop
+				disStart &= FINEMASK; //clip it to FINEMASK
+			}
+			break;
+		}
+		case postimg_motion:
+		{
+			UINT8 *blur = job->blur + top*vid.width;
+
+			for (y = top; y < bottom; y++, row += vid.width, blur += vid.width)
+			{
+				V_TransRow(blur, row, blur, job->transme, colormaps, vid.width);
+				M_Memcpy(row, blur, vid.width);
+			}
+			break;
+		}
+		case postimg_flip:
+		{
+			// swap each row in the top half with its mirror in the bottom half
+			UINT8 swap[256];
+			UINT8 *mirror;
+			INT32 x, n;
+
+			bottom = min(bottom, job->height/2);
+			for (y = top; y < bottom; y++, row += vid.width)
+			{
+				mirror = job->screen + (job->height - 1 - y)*vid.width;
+				for (x = 0; x < vid.width; x += n)
+				{
+					n = min((INT32)sizeof swap, vid.width - x);
+					M_Memcpy(swap, row + x, n);
+					M_Memcpy(row + x, mirror + x, n);
+					M_Memcpy(mirror + x, swap, n);
+				}
+			}
+			break;
+		}
+		case postimg_heat:
+			for (y = top; y < bottom; y++, row += vid.width)
+			{
+				// Shift this row of pixels to the right by 2
+				if (heatshifter[(job->heatstart + y) % job->height])
+					V_ShiftRow(row, vid.dupx);
+			}
+			break;
+		default:
+			break;
+	}
+}
+#endif
+
 //
 // V_DoPostProcessor
 //
@@ -2018,7 +2486,8 @@ void V_DoPostProcessor(INT32 view, postimg_t type, INT32 param)
 	(void)type;
 	(void)param;
 #else
-	INT32 height, yoffset;
+	postjob_t job;
+	INT32 height, yoffset, bands, i;
 
 #ifdef HWRENDER
 	// draw a hardware converted patch
@@ -2029,6 +2498,9 @@ void V_DoPostProcessor(INT32 view, postimg_t type, INT32 param)
 	if (view < 0 || view >= 2 || (view == 1 && !splitscreen))
 		return;
 
+	if (type != postimg_water && type != postimg_motion && type != postimg_flip && type != postimg_heat)
+		return;
+
 	if (splitscreen)
 		height = vid.height/2;
 	else
@@ -2039,102 +2511,19 @@ void V_DoPostProcessor(INT32 view, postimg_t type, INT32 param)
 	else
 		yoffset = 0;
 
-	if (type == postimg_water)
-	{
-		UINT8 *tmpscr = screens[4];
-		UINT8 *srcscr = screens[0];
-		INT32 y;
-		angle_t disStart = (leveltime * 128) & FINEMASK; // in 0 to FINEANGLE
-		INT32 newpix;
-		INT32 sine;
-		//UINT8 *transme = transtables + ((tr_trans50-1)<<FF_TRANSSHIFT);
-
-		for (y = yoffset; y < yoffset+height; y++)
-		{
-			sine = (FINESINE(disStart)*5)>>FRACBITS;
-			newpix = abs(sine);
-
-			if (sine < 0)
-			{
-				M_Memcpy(&tmpscr[y*vid.width+newpix], &srcscr[y*vid.width], vid.width-newpix);
-
-				// Cleanup edge
-				while (newpix)
-				{
-					tmpscr[y*vid.width+newpix] = srcscr[y*vid.width];
-					newpix--;
-				}
-			}
-			else
-			{
-				M_Memcpy(&tmpscr[y*vid.width+0], &srcscr[y*vid.width+sine], vid.width-newpix);
-
-				// Cleanup edge
-				while (newpix)
-				{
-					tmpscr[y*vid.width+vid.width-newpix] = srcscr[y*vid.width+(vid.width-1)];
-					newpix--;
-				}
-			}
-
-/*
-Unoptimized version
-			for (x = 0; x < vid.width*vid.bpp; x++)
-			{
-				newpix = (x + sine);
-
-				if (newpix < 0)
-					newpix = 0;
-				else if (newpix >= vid.width)
-					newpix = vid.width-1;
-
-				tmpscr[y*vid.width + x] = srcscr[y*vid.width+newpix]; // *(transme + (srcscr[y*vid.width+x]<<8) + srcscr[y*vid.width+newpix]);
-			}*/
-			disStart += 22;//the offset into the displacement map, increment each game loop
-			disStart &= FINEMASK; //clip it to FINEMASK
-		}
-
-		VID_BlitLinearScreen(tmpscr+vid.width*vid.bpp*yoffset, screens[0]+vid.width*vid.bpp*yoffset,
-				vid.width*vid.bpp, height, vid.width*vid.bpp, vid.width);
-	}
-	else if (type == postimg_motion) // Motion Blur!
-	{
-		UINT8 *tmpscr = screens[4];
-		UINT8 *srcscr = screens[0];
-		INT32 x, y;
-
-		// TODO: Add a postimg_param so that we can pick the translucency level...
-		UINT8 *transme = transtables + ((param-1)<<FF_TRANSSHIFT);
-
-		for (y = yoffset; y < yoffset+height; y++)
-		{
-			for (x = 0; x < vid.width; x++)
-			{
-				tmpscr[y*vid.width + x]
-					=     colormaps[*(transme     + (srcscr   [y*vid.width+x ] <<8) + (tmpscr[y*vid.width+x]))];
-			}
-		}
-		VID_BlitLinearScreen(tmpscr+vid.width*vid.bpp*yoffset, screens[0]+vid.width*vid.bpp*yoffset,
-				vid.width*vid.bpp, height, vid.width*vid.bpp, vid.width);
-	}
-	else if (type == postimg_flip) // Flip the screen upside-down
-	{
-		UINT8 *tmpscr = screens[4];
-		UINT8 *srcscr = screens[0];
-		INT32 y, y2;
-
-		for (y = yoffset, y2 = yoffset+height - 1; y < yoffset+height; y++, y2--)
-			M_Memcpy(&tmpscr[y2*vid.width], &srcscr[y*vid.width], vid.width);
+	job.type = type;
+	job.screen = screens[0] + vid.width*yoffset;
+	job.blur = screens[4] + vid.width*yoffset;
+	job.height = height;
+	job.disstart = (leveltime * 128) & FINEMASK; // in 0 to FINEANGLE
+	job.heatstart = 0;
+	job.transme = NULL;
+	// TODO: Add a postimg_param so that we can pick the translucency level...
+	if (type == postimg_motion)
+		job.transme = transtables + ((param-1)<<FF_TRANSSHIFT);
 
-		VID_BlitLinearScreen(tmpscr+vid.width*vid.bpp*yoffset, screens[0]+vid.width*vid.bpp*yoffset,
-				vid.width*vid.bpp, height, vid.width*vid.bpp, vid.width);
-	}
-	else if (type == postimg_heat) // Heat wave
+	if (type == postimg_heat)
 	{
-		UINT8 *tmpscr = screens[4];
-		UINT8 *srcscr = screens[0];
-		INT32 y;
-
 		// Make sure table is built
 		if (heatshifter == NULL || lastheight != height)
 		{
@@ -2143,39 +2532,32 @@ Unoptimized version
 
 			heatshifter = Z_Calloc(height * sizeof(boolean), PU_STATIC, NULL);
 
-			for (y = 0; y < height; y++)
+			for (i = 0; i < height; i++)
 			{
 				if (M_RandomChance(FRACUNIT/8)) // 12.5%
-					heatshifter[y] = true;
+					heatshifter[i] = true;
 			}
 
 			heatindex[0] = heatindex[1] = 0;
 			lastheight = height;
 		}
 
-		for (y = yoffset; y < yoffset+height; y++)
-		{
-			if (heatshifter[heatindex[view]++])
-			{
-				// Shift this row of pixels to the right by 2
-				tmpscr[y*vid.width] = srcscr[y*vid.width];
-				M_Memcpy(&tmpscr[y*vid.width+vid.dupx], &srcscr[y*vid.width], vid.width-vid.dupx);
-			}
-			else
-				M_Memcpy(&tmpscr[y*vid.width], &srcscr[y*vid.width], vid.width);
-
-			heatindex[view] %= height;
-		}
-
+		job.heatstart = heatindex[view] % height;
+	}
 
-		if (renderisnewtic) // This isn't interpolated... but how do you interpolate a one-pixel shift?
-		{
-			heatindex[view]++;
-			heatindex[view] %= vid.height;
-		}
+	bands = (height + POSTPROCBAND - 1) / POSTPROCBAND;
+#ifdef HAVE_THREADS
+	if (vid.width * height >= POSTPROCTHREADPIXELS)
+		I_ParallelFor(bands, cv_renderthreads.value, V_PostProcessBand, &job);
+	else
+#endif
+	for (i = 0; i < bands; i++)
+		V_PostProcessBand(i, &job);
 
-		VID_BlitLinearScreen(tmpscr+vid.width*vid.bpp*yoffset, screens[0]+vid.width*vid.bpp*yoffset,
-				vid.width*vid.bpp, height, vid.width*vid.bpp, vid.width);
+	if (type == postimg_heat && renderisnewtic) // This isn't interpolated... but how do you interpolate a one-pixel shift?
+	{
+		heatindex[view]++;
+		heatindex[view] %= vid.height;
 	}
 #endif
 }
@@ -2217,6 +2599,10 @@ void V_Init(void)
 	for (i = 0; i < NUMSCREENS; i++)
 		screens[i] = NULL;
 
+#ifdef PARANOIA
+	V_CheckTransRow();
+#endif
+
 	// start address of NUMSCREENS * width*height vidbuffers
 	if (base)
 	{
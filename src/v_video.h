@@ -147,6 +147,15 @@ extern RGBA_t *pLocalPalette;
 #define V_DrawTinyTranslucentPatch(x,y,s,p) V_DrawFixedPatch((x)<<FRACBITS, (y)<<FRACBITS, FRACUNIT/4, s, p, NULL)
 #define V_DrawSciencePatch(x,y,s,p,sc) V_DrawFixedPatch(x,y,sc,s,p,NULL)
 void V_DrawFixedPatch(fixed_t x, fixed_t y, fixed_t pscale, INT32 scrn, patch_t *patch, const UINT8 *colormap);
+
+// A character queued by the string drawers, drawn together with the rest
+// of its string so the setup shared by every glyph is only done once.
+typedef struct
+{
+	patch_t *patch;
+	fixed_t x, y;
+	const UINT8 *colormap;
+} vglyph_t;
 void V_DrawCroppedPatch(fixed_t x, fixed_t y, fixed_t pscale, INT32 scrn, patch_t *patch, fixed_t sx, fixed_t sy, fixed_t w, fixed_t h);
 
 void V_DrawContinueIcon(INT32 x, INT32 y, INT32 flags, INT32 skinnum, UINT8 skincolor);
@@ -214,6 +223,10 @@ INT32 V_SmallStringWidth(const char *string, INT32 option);
 // Find string width from tny_font chars
 INT32 V_ThinStringWidth(const char *string, INT32 option);
 
+// dest[x] = table[(hi[x]<<8) + lo[x]], through colormap if not NULL
+// It may read up to TRANSROWPAD bytes past the end of either table.
+#define TRANSROWPAD 3
+void V_TransRow(UINT8 *dest, const UINT8 *hi, const UINT8 *lo, const UINT8 *table, const UINT8 *colormap, INT32 count);
 void V_DoPostProcessor(INT32 view, postimg_t type, INT32 param);
 
 void V_DrawPatchFill(patch_t *pat);
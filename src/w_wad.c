@@ -811,6 +811,7 @@ UINT16 W_InitFile(const char *filename)
 	// set up caching
 	//
 	Z_Calloc(numlumps * sizeof (*wadfile->lumpcache), PU_STATIC, &wadfile->lumpcache);
+	Z_Calloc(numlumps * sizeof (*wadfile->patchcache), PU_STATIC, &wadfile->patchcache);
 
 #ifdef HWRENDER
 	// allocates GLPatch info structures and store them in a tree
@@ -876,6 +877,9 @@ void W_UnloadWadFile(UINT16 num)
 			Z_ChangeTag(lumpcache[i], PU_PURGELEVEL);
 	}
 	Z_Free(lumpcache);
+	for (i = 0; i < delwad->numlumps; i++)
+		Z_ChangeTag(delwad->patchcache[i], PU_PURGELEVEL);
+	Z_Free(delwad->patchcache);
 	fclose(delwad->handle);
 	Z_Free(delwad->filename);
 	Z_Free(delwad);
@@ -1660,23 +1664,165 @@ void *W_CacheLumpName(const char *name, INT32 tag)
 
 // Graphic 'patches' are loaded, and if necessary, converted into the format
 // the most useful for the current rendermode. For software renderer, the
-// graphic patches are kept as is. For the hardware renderer, graphic patches
+// graphic patches are kept as is, followed by their decoded posts (see
+// patchposts_t). For the hardware renderer, graphic patches
 // are 'unpacked', and are kept into the cache in that unpacked format, and
 // the heap memory cache then acts as a 'level 2' cache just after the
 // graphics card memory.
 
+#define PATCHPOSTSID 0x54534f50 // "POST"
+#define POSTPAD(x) (((x) + 7) & ~(size_t)7)
+
+// Counts the posts of a patch lump, or returns -1 if it isn't a sane one.
+static INT32 W_CountPatchPosts(const patch_t *patch, size_t len)
+{
+	const UINT8 *base = (const UINT8 *)patch;
+	INT32 width, col, count = 0;
+	size_t ofs;
+
+	if (len < 8)
+		return -1;
+
+	width = SHORT(patch->width);
+	if (width <= 0 || 8 + (size_t)width*4 > len)
+		return -1;
+
+	for (col = 0; col < width; col++)
+	{
+		ofs = LONG(patch->columnofs[col]);
+		for (;;)
+		{
+			if (ofs >= len)
+				return -1;
+			if (base[ofs] == 0xff)
+				break;
+			if (ofs + 1 >= len)
+				return -1;
+			ofs += base[ofs+1] + 4;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static size_t W_PatchPostsSize(const patch_t *patch, size_t len, INT32 numposts)
+{
+	return POSTPAD(len) + POSTPAD((SHORT(patch->width) + 1) * sizeof (UINT32))
+		+ numposts * sizeof (patchpost_t) + sizeof (patchposts_t);
+}
+
+// Decodes the posts of a patch into the space W_PatchPostsSize left after it.
+static void W_MakePatchPosts(patch_t *patch, size_t len, INT32 numposts)
+{
+	const INT32 width = SHORT(patch->width);
+	UINT8 *base = (UINT8 *)patch;
+	UINT32 *columnposts = (UINT32 *)(base + POSTPAD(len));
+	patchpost_t *post = (patchpost_t *)((UINT8 *)columnposts + POSTPAD((width + 1) * sizeof (UINT32)));
+	patchposts_t *posts = (patchposts_t *)(post + numposts);
+	const column_t *column;
+	INT32 col, topdelta, prevdelta;
+	UINT32 n = 0;
+
+	for (col = 0; col < width; col++)
+	{
+		columnposts[col] = n;
+		column = (const column_t *)(base + LONG(patch->columnofs[col]));
+		prevdelta = -1;
+		while (column->topdelta != 0xff)
+		{
+			topdelta = column->topdelta;
+			if (topdelta <= prevdelta)
+				topdelta += prevdelta;
+			prevdelta = topdelta;
+
+			post[n].topdelta = (INT16)topdelta;
+			post[n].length = column->length;
+			post[n].ofs = (UINT32)((const UINT8 *)column + 3 - base);
+			n++;
+
+			column = (const column_t *)((const UINT8 *)column + column->length + 4);
+		}
+	}
+	columnposts[width] = n;
+
+	posts->columnposts = columnposts;
+	posts->posts = post;
+	posts->patch = patch;
+	posts->id = PATCHPOSTSID;
+}
+
+static void *W_CacheSoftPatchPwad(UINT16 wad, UINT16 lump, INT32 tag)
+{
+	lumpcache_t *patchcache;
+
+	if (!TestValidLump(wad,lump))
+		return NULL;
+
+	patchcache = wadfiles[wad]->patchcache;
+	if (!patchcache[lump])
+	{
+		lumpcache_t *lumpcache = wadfiles[wad]->lumpcache;
+		const size_t len = W_LumpLengthPwad(wad, lump);
+		patch_t *ptr = Z_Malloc(len, tag, &patchcache[lump]);
+		INT32 numposts;
+
+		// Take the lump from W_CacheLumpNum's copy if there is one. That copy
+		// is left alone, whoever has it may still be using it until a purge.
+		if (lumpcache[lump])
+			M_Memcpy(ptr, lumpcache[lump], len);
+		else
+			W_ReadLumpHeaderPwad(wad, lump, ptr, 0, 0);  // read the lump in full
+
+		// Not a patch after all? Leave it be, the drawers will cope as they always have.
+		numposts = W_CountPatchPosts(ptr, len);
+		if (numposts >= 0)
+		{
+			ptr = Z_Realloc(ptr, W_PatchPostsSize(ptr, len, numposts), tag, &patchcache[lump]);
+			W_MakePatchPosts(ptr, len, numposts);
+		}
+	}
+	else
+		Z_ChangeTag(patchcache[lump], tag);
+
+	return patchcache[lump];
+}
+
+//
+// W_GetPatchPosts
+// Returns the decoded posts of a software patch, or NULL if it doesn't
+// have any (it wasn't cached with W_CachePatchNum).
+//
+const patchposts_t *W_GetPatchPosts(const void *patch)
+{
+	const patchposts_t *posts;
+	size_t size;
+
+	if (!patch)
+		return NULL;
+
+	size = Z_BlockSize((void *)patch);
+	if (size < 8 + sizeof (patchposts_t))
+		return NULL;
+
+	posts = (const patchposts_t *)((const UINT8 *)patch + size - sizeof (patchposts_t));
+	if (posts->id != PATCHPOSTSID || posts->patch != patch)
+		return NULL;
+
+	return posts;
+}
+
 //
 // Cache a patch into heap memory, convert the patch format as necessary
 //
 
-// Software-only compile cache the data without conversion
 #ifdef HWRENDER
 static inline void *W_CachePatchNumPwad(UINT16 wad, UINT16 lump, INT32 tag)
 {
 	GLPatch_t *grPatch;
 
 	if (rendermode == render_soft || rendermode == render_none)
-		return W_CacheLumpNumPwad(wad, lump, tag);
+		return W_CacheSoftPatchPwad(wad, lump, tag);
 
 	if (!TestValidLump(wad, lump))
 		return NULL;
@@ -1705,14 +1851,16 @@ static inline void *W_CachePatchNumPwad(UINT16 wad, UINT16 lump, INT32 tag)
 	// return GLPatch_t, which can be casted to (patch_t) with valid patch header info
 	return (void *)grPatch;
 }
+#else
+// Software-only compile has nothing else to choose from
+#define W_CachePatchNumPwad(wad, lump, tag) W_CacheSoftPatchPwad(wad, lump, tag)
+#endif // HWRENDER
 
 void *W_CachePatchNum(lumpnum_t lumpnum, INT32 tag)
 {
 	return W_CachePatchNumPwad(WADFILENUM(lumpnum),LUMPNUM(lumpnum),tag);
 }
 
-#endif // HWRENDER
-
 void W_UnlockCachedPatch(void *patch)
 {
 	if (!patch)
@@ -426,6 +426,13 @@ void I_UpdateNoVsync(void)
 	cv_vidwait.value = real_vidwait;
 }
 
+// ---------------
+// I_PresentFrame
+// ---------------
+void I_PresentFrame(void)
+{
+}
+
 //
 // This is meant to be called only by CONS_Printf() while game startup
 //
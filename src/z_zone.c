@@ -648,6 +648,46 @@ void Z_SetUser(void *ptr, void **newuser)
 	ASAN_POISON_MEMORY_REGION(block, sizeof(memblock_t));
 }
 
+/** Gets the size of a memory block.
+  *
+  * \param ptr A pointer to allocated memory,
+  *             assumed to have been allocated with Z_Malloc/Z_Calloc.
+  * \return The size the block was last allocated with, header not included.
+  */
+size_t Z_BlockSize(void *ptr)
+{
+	memblock_t *block = MEMBLOCK(ptr);
+	size_t size;
+
+	ASAN_UNPOISON_MEMORY_REGION(block, sizeof(memblock_t));
+	if (block->id != ZONEID)
+		I_Error("Z_BlockSize: wrong id");
+	size = block->realsize;
+	ASAN_POISON_MEMORY_REGION(block, sizeof(memblock_t));
+
+	return size;
+}
+
+/** Gets the tag of a memory block.
+  *
+  * \param ptr A pointer to allocated memory,
+  *             assumed to have been allocated with Z_Malloc/Z_Calloc.
+  * \return The tag the block was last given.
+  */
+INT32 Z_GetTag(void *ptr)
+{
+	memblock_t *block = MEMBLOCK(ptr);
+	INT32 tag;
+
+	ASAN_UNPOISON_MEMORY_REGION(block, sizeof(memblock_t));
+	if (block->id != ZONEID)
+		I_Error("Z_GetTag: wrong id");
+	tag = block->tag;
+	ASAN_POISON_MEMORY_REGION(block, sizeof(memblock_t));
+
+	return tag;
+}
+
 // -----------------
 // Zone memory usage
 // -----------------
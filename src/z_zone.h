@@ -140,6 +140,8 @@ void Z_SetUser(void *ptr, void **newuser);
 #define Z_TagUsage(tagnum) Z_TagsUsage(tagnum, tagnum)
 size_t Z_TagsUsage(INT32 lowtag, INT32 hightag);
 #define Z_TotalUsage() Z_TagsUsage(0, INT32_MAX)
+size_t Z_BlockSize(void *ptr);
+INT32 Z_GetTag(void *ptr);
 
 //
 // Miscellaneous functions